@@ -135,6 +135,8 @@ set(include_files_list
     langinfo.h
     libio.h
     linux/falloc.h
+    linux/io_uring.h
+    linux/mempolicy.h
     limits.h
     locale.h
     math.h
@@ -0,0 +1,222 @@
+/*
+ *	PROGRAM:	Object oriented API samples.
+ *	MODULE:		14.concurrent_inserts.cpp
+ *	DESCRIPTION:	Insert rows into the same table from a number of threads,
+ *					each with its own attachment, and print rows per second.
+ *					Runs with 1, 2, 4, ... up to the given number of threads.
+ *
+ *					Usage: 14.concurrent_inserts [threads [rows per thread]]
+ *
+ *					Creates database inserts_14.fdb and drops it when done.
+ *					Use server with shared page cache (SuperServer) to see how
+ *					concurrent inserters scale.
+ *
+ *					Example for the following macro:
+ *
+ *					FB_MESSAGE - defines static messages
+ *					C++ specific sample!
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "ifaceExamples.h"
+#include <firebird/Message.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static IMaster* master = fb_get_master_interface();
+
+static const char* dbName = "inserts_14.fdb";
+
+// Rows inserted by a transaction
+static const unsigned ROWS_PER_COMMIT = 1000;
+
+static std::atomic<bool> failed(false);
+
+static void errPrint(IStatus* status)
+{
+	char buf[256];
+	master->getUtilInterface()->formatStatus(buf, sizeof(buf), status);
+	fprintf(stderr, "%s\n", buf);
+}
+
+static void drop(IAttachment** att)
+{
+	CheckStatusWrapper status(master->getStatus());
+
+	// drop database (will close interface)
+	(*att)->dropDatabase(&status);
+	if (status.getState() & IStatus::STATE_ERRORS)
+	{
+		errPrint(&status);
+		fprintf(stderr, "*** Drop database failed - do it manually before next run ***\n");
+	}
+	else
+		*att = NULL;
+
+	status.dispose();
+}
+
+static void inserter(int threadNum, unsigned rows)
+{
+	ThrowStatusWrapper status(master->getStatus());
+	IProvider* prov = master->getDispatcher();
+
+	IAttachment* att = NULL;
+	ITransaction* tra = NULL;
+	IStatement* stmt = NULL;
+
+	try
+	{
+		att = prov->attachDatabase(&status, dbName, 0, NULL);
+
+		FB_MESSAGE(Input, ThrowStatusWrapper,
+			(FB_INTEGER, thread)
+			(FB_INTEGER, num)
+			(FB_VARCHAR(100), payload)
+		) input(&status, master);
+
+		input.clear();
+		input->thread = threadNum;
+		input->payload.set("Some data to make the row look like a real one, about a hundred bytes long.");
+
+		tra = att->startTransaction(&status, 0, NULL);
+		stmt = att->prepare(&status, tra, 0,
+			"insert into inserts (thread, num, payload) values (?, ?, ?)",
+			SAMPLES_DIALECT, 0);
+
+		for (unsigned n = 0; n < rows && !failed; n++)
+		{
+			input->num = n;
+			stmt->execute(&status, tra, input.getMetadata(), input.getData(), NULL, NULL);
+
+			if ((n + 1) % ROWS_PER_COMMIT == 0)
+				tra->commitRetaining(&status);
+		}
+
+		stmt->free(&status);
+		stmt = NULL;
+
+		tra->commit(&status);
+		tra = NULL;
+
+		att->detach(&status);
+		att = NULL;
+	}
+	catch (const FbException& error)
+	{
+		failed = true;
+		errPrint(error.getStatus());
+	}
+
+	if (stmt)
+		stmt->release();
+	if (tra)
+		tra->release();
+	if (att)
+		att->release();
+
+	prov->release();
+	status.dispose();
+}
+
+int main(int argc, char** argv)
+{
+	int rc = 0;
+
+	const int maxThreads = (argc > 1) ? atoi(argv[1]) : 32;
+	const unsigned rows = (argc > 2) ? atoi(argv[2]) : 100000;
+
+	if (maxThreads <= 0 || rows == 0)
+	{
+		fprintf(stderr, "Usage: %s [threads [rows per thread]]\n", argv[0]);
+		return 1;
+	}
+
+	// set default password if none specified in environment
+	setenv("ISC_USER", "sysdba", 0);
+	setenv("ISC_PASSWORD", "masterkey", 0);
+
+	ThrowStatusWrapper status(master->getStatus());
+	IProvider* prov = master->getDispatcher();
+
+	IAttachment* att = NULL;
+	ITransaction* tra = NULL;
+
+	try
+	{
+		att = prov->createDatabase(&status, dbName, 0, NULL);
+
+		printf("threads        rows   rows/sec\n");
+
+		for (int threads = 1; ; threads = (threads * 2 < maxThreads) ? threads * 2 : maxThreads)
+		{
+			// Every run starts with an empty table
+			tra = att->startTransaction(&status, 0, NULL);
+			att->execute(&status, tra, 0,
+				"recreate table inserts (thread integer, num integer, payload varchar(100))",
+				SAMPLES_DIALECT, NULL, NULL, NULL, NULL);
+			tra->commit(&status);
+			tra = NULL;
+
+			const auto start = std::chrono::steady_clock::now();
+
+			std::vector<std::thread> inserters;
+			for (int n = 0; n < threads; n++)
+				inserters.emplace_back(inserter, n, rows);
+
+			for (auto& thread : inserters)
+				thread.join();
+
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			if (failed)
+				throw "Insert failed - can't continue";
+
+			const double total = (double) threads * rows;
+			printf("%7d %11.0f %10.0f\n", threads, total, total / elapsed.count());
+
+			if (threads == maxThreads)
+				break;
+		}
+	}
+	catch (const FbException& error)
+	{
+		// handle error
+		rc = 1;
+		errPrint(error.getStatus());
+	}
+	catch (const char* text)
+	{
+		rc = 1;
+		fprintf(stderr, "%s\n", text);
+	}
+
+	// cleanup, database is dropped after error too
+	if (tra)
+		tra->release();
+	if (att)
+		drop(&att);
+	if (att)
+		att->release();
+
+	prov->release();
+	status.dispose();
+
+	return rc;
+}
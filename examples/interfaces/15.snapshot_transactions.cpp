@@ -0,0 +1,178 @@
+/*
+ *	PROGRAM:	Object oriented API samples.
+ *	MODULE:		15.snapshot_transactions.cpp
+ *	DESCRIPTION:	Start and commit empty snapshot transactions from a number
+ *					of threads, each with its own attachment, and print
+ *					transactions per second. Every transaction takes and frees
+ *					a slot in the shared list of active snapshots, so this
+ *					shows how that list scales. Runs with 1, 2, 4, ... up to
+ *					the given number of threads.
+ *
+ *					Usage: 15.snapshot_transactions [threads [transactions per thread]]
+ *
+ *					Creates database snapshots_15.fdb and drops it when done.
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "ifaceExamples.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static IMaster* master = fb_get_master_interface();
+
+static const char* dbName = "snapshots_15.fdb";
+
+static std::atomic<bool> failed(false);
+
+static void errPrint(IStatus* status)
+{
+	char buf[256];
+	master->getUtilInterface()->formatStatus(buf, sizeof(buf), status);
+	fprintf(stderr, "%s\n", buf);
+}
+
+static void drop(IAttachment** att)
+{
+	CheckStatusWrapper status(master->getStatus());
+
+	// drop database (will close interface)
+	(*att)->dropDatabase(&status);
+	if (status.getState() & IStatus::STATE_ERRORS)
+	{
+		errPrint(&status);
+		fprintf(stderr, "*** Drop database failed - do it manually before next run ***\n");
+	}
+	else
+		*att = NULL;
+
+	status.dispose();
+}
+
+static void worker(unsigned count)
+{
+	ThrowStatusWrapper status(master->getStatus());
+	IProvider* prov = master->getDispatcher();
+
+	IAttachment* att = NULL;
+	ITransaction* tra = NULL;
+
+	try
+	{
+		att = prov->attachDatabase(&status, dbName, 0, NULL);
+
+		// Default transaction parameters mean snapshot (concurrency) isolation
+		for (unsigned n = 0; n < count && !failed; n++)
+		{
+			tra = att->startTransaction(&status, 0, NULL);
+			tra->commit(&status);
+			tra = NULL;
+		}
+
+		att->detach(&status);
+		att = NULL;
+	}
+	catch (const FbException& error)
+	{
+		failed = true;
+		errPrint(error.getStatus());
+	}
+
+	if (tra)
+		tra->release();
+	if (att)
+		att->release();
+
+	prov->release();
+	status.dispose();
+}
+
+int main(int argc, char** argv)
+{
+	int rc = 0;
+
+	const int maxThreads = (argc > 1) ? atoi(argv[1]) : 32;
+	const unsigned count = (argc > 2) ? atoi(argv[2]) : 100000;
+
+	if (maxThreads <= 0 || count == 0)
+	{
+		fprintf(stderr, "Usage: %s [threads [transactions per thread]]\n", argv[0]);
+		return 1;
+	}
+
+	// set default password if none specified in environment
+	setenv("ISC_USER", "sysdba", 0);
+	setenv("ISC_PASSWORD", "masterkey", 0);
+
+	ThrowStatusWrapper status(master->getStatus());
+	IProvider* prov = master->getDispatcher();
+
+	IAttachment* att = NULL;
+
+	try
+	{
+		att = prov->createDatabase(&status, dbName, 0, NULL);
+
+		printf("threads transactions   trans/sec\n");
+
+		for (int threads = 1; ; threads = (threads * 2 < maxThreads) ? threads * 2 : maxThreads)
+		{
+			const auto start = std::chrono::steady_clock::now();
+
+			std::vector<std::thread> workers;
+			for (int n = 0; n < threads; n++)
+				workers.emplace_back(worker, count);
+
+			for (auto& thread : workers)
+				thread.join();
+
+			const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+			if (failed)
+				throw "Transaction failed - can't continue";
+
+			const double total = (double) threads * count;
+			printf("%7d %12.0f %11.0f\n", threads, total, total / elapsed.count());
+
+			if (threads == maxThreads)
+				break;
+		}
+	}
+	catch (const FbException& error)
+	{
+		// handle error
+		rc = 1;
+		errPrint(error.getStatus());
+	}
+	catch (const char* text)
+	{
+		rc = 1;
+		fprintf(stderr, "%s\n", text);
+	}
+
+	// cleanup, database is dropped after error too
+	if (att)
+		drop(&att);
+	if (att)
+		att->release();
+
+	prov->release();
+	status.dispose();
+
+	return rc;
+}
@@ -109,6 +109,7 @@ PARSER_TOKEN(TOK_BOTH, "BOTH", false)
 PARSER_TOKEN(TOK_BREAK, "BREAK", true)
 PARSER_TOKEN(TOK_BTRIM, "BTRIM", false)
 PARSER_TOKEN(TOK_BY, "BY", false)
+PARSER_TOKEN(TOK_CACHE, "CACHE", false)
 PARSER_TOKEN(TOK_CALL, "CALL", false)
 PARSER_TOKEN(TOK_CALLER, "CALLER", true)
 PARSER_TOKEN(TOK_CASCADE, "CASCADE", true)
@@ -201,6 +202,7 @@ PARSER_TOKEN(TOK_DOWNTO, "DOWNTO", true)
 PARSER_TOKEN(TOK_DROP, "DROP", false)
 PARSER_TOKEN(TOK_ELSE, "ELSE", false)
 PARSER_TOKEN(TOK_ENABLE, "ENABLE", true)
+PARSER_TOKEN(TOK_ENCODING, "ENCODING", true)
 PARSER_TOKEN(TOK_ENCRYPT, "ENCRYPT", true)
 PARSER_TOKEN(TOK_END, "END", false)
 PARSER_TOKEN(TOK_ENGINE, "ENGINE", true)
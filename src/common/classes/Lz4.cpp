@@ -0,0 +1,244 @@
+/*
+ *	PROGRAM:	Common class definition
+ *	MODULE:		Lz4.cpp
+ *	DESCRIPTION:	LZ4 block format compression.
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include <string.h>
+#include "../common/classes/Lz4.h"
+#include "../common/gdsassert.h"
+
+using namespace Firebird;
+
+// Block is a sequence of:
+//
+// token - high 4 bits are the literals length, low 4 bits are the match length minus 4,
+//		   value 15 means that the length is continued in the following bytes
+// [literals length bytes] - added to 15 until a byte that is less than 255
+// literals
+// offset - two bytes, little endian, distance from the current position back to the match
+// [match length bytes] - the same as for literals
+//
+// The last sequence contains literals only. The last 5 bytes of input are always literals
+// and the last match starts at least 12 bytes before the end of input.
+
+namespace
+{
+	constexpr ULONG MIN_MATCH = 4;
+	constexpr ULONG LAST_LITERALS = 5;
+	constexpr ULONG MATCH_LIMIT = 12;
+	constexpr ULONG MAX_OFFSET = 65535;
+	constexpr ULONG RUN_MASK = 15;
+
+	constexpr unsigned HASH_BITS = 12;
+
+	inline ULONG read32(const UCHAR* p) noexcept
+	{
+		ULONG value;
+		memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	inline unsigned hash(ULONG value) noexcept
+	{
+		return (value * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	inline void putLength(UCHAR*& output, ULONG length) noexcept
+	{
+		for (; length >= 255; length -= 255)
+			*output++ = 255;
+
+		*output++ = (UCHAR) length;
+	}
+
+	inline bool getLength(const UCHAR*& input, const UCHAR* end, ULONG& length) noexcept
+	{
+		UCHAR byte;
+
+		do
+		{
+			if (input >= end)
+				return false;
+
+			byte = *input++;
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	bool putSequence(UCHAR*& output, const UCHAR* end, const UCHAR* literals, ULONG litLength,
+		ULONG offset, ULONG matchLength) noexcept
+	{
+		// Worst case, extra length bytes are calculated roughly
+		ULONG needed = 1 + litLength + litLength / 255 + 1;
+
+		if (matchLength)
+			needed += sizeof(USHORT) + matchLength / 255 + 1;
+
+		if (needed > (ULONG) (end - output))
+			return false;
+
+		UCHAR* const token = output++;
+		*token = (UCHAR) (MIN(litLength, RUN_MASK) << 4);
+
+		if (litLength >= RUN_MASK)
+			putLength(output, litLength - RUN_MASK);
+
+		memcpy(output, literals, litLength);
+		output += litLength;
+
+		if (matchLength)
+		{
+			*output++ = (UCHAR) offset;
+			*output++ = (UCHAR) (offset >> 8);
+
+			matchLength -= MIN_MATCH;
+			*token |= (UCHAR) MIN(matchLength, RUN_MASK);
+
+			if (matchLength >= RUN_MASK)
+				putLength(output, matchLength - RUN_MASK);
+		}
+
+		return true;
+	}
+}
+
+
+ULONG Lz4::compress(const UCHAR* input, ULONG inLength, UCHAR* output, ULONG outCapacity) noexcept
+{
+	fb_assert(inLength <= MAX_INPUT_LENGTH);
+
+	const UCHAR* const inEnd = input + inLength;
+	const UCHAR* const outEnd = output + outCapacity;
+	UCHAR* out = output;
+	const UCHAR* anchor = input;
+
+	if (inLength > MATCH_LIMIT)
+	{
+		// Positions of the recently seen 4-byte sequences
+		USHORT table[1 << HASH_BITS];
+		memset(table, 0, sizeof(table));
+
+		const UCHAR* const matchLimit = inEnd - MATCH_LIMIT;
+		const UCHAR* const matchEnd = inEnd - LAST_LITERALS;
+		const UCHAR* p = input + 1;
+
+		while (p <= matchLimit)
+		{
+			const ULONG sequence = read32(p);
+			const unsigned h = hash(sequence);
+			const UCHAR* ref = input + table[h];
+			table[h] = (USHORT) (p - input);
+
+			if (ref >= p || p - ref > MAX_OFFSET || read32(ref) != sequence)
+			{
+				// Search faster through the incompressible data
+				p += 1 + ((p - anchor) >> 6);
+				continue;
+			}
+
+			while (p > anchor && ref > input && p[-1] == ref[-1])
+			{
+				p--;
+				ref--;
+			}
+
+			const UCHAR* q = p + MIN_MATCH;
+			const UCHAR* r = ref + MIN_MATCH;
+
+			while (q < matchEnd && *q == *r)
+			{
+				q++;
+				r++;
+			}
+
+			if (!putSequence(out, outEnd, anchor, p - anchor, p - ref, q - p))
+				return 0;
+
+			anchor = p = q;
+		}
+	}
+
+	if (!putSequence(out, outEnd, anchor, inEnd - anchor, 0, 0))
+		return 0;
+
+	return out - output;
+}
+
+
+bool Lz4::decompress(const UCHAR* input, ULONG inLength, UCHAR* output, ULONG outLength) noexcept
+{
+	const UCHAR* const inEnd = input + inLength;
+	const UCHAR* const outEnd = output + outLength;
+	UCHAR* out = output;
+
+	while (input < inEnd)
+	{
+		const ULONG token = *input++;
+
+		ULONG litLength = token >> 4;
+		if (litLength == RUN_MASK && !getLength(input, inEnd, litLength))
+			return false;
+
+		if (litLength > (ULONG) (inEnd - input) || litLength > (ULONG) (outEnd - out))
+			return false;
+
+		memcpy(out, input, litLength);
+		input += litLength;
+		out += litLength;
+
+		// The last sequence has no match
+		if (input == inEnd)
+			break;
+
+		if (inEnd - input < (ptrdiff_t) sizeof(USHORT))
+			return false;
+
+		const ULONG offset = input[0] | (input[1] << 8);
+		input += sizeof(USHORT);
+
+		if (!offset || offset > (ULONG) (out - output))
+			return false;
+
+		ULONG matchLength = token & RUN_MASK;
+		if (matchLength == RUN_MASK && !getLength(input, inEnd, matchLength))
+			return false;
+
+		matchLength += MIN_MATCH;
+
+		if (matchLength > (ULONG) (outEnd - out))
+			return false;
+
+		const UCHAR* const ref = out - offset;
+
+		if (offset >= matchLength)
+			memcpy(out, ref, matchLength);
+		else
+		{
+			// Overlapped match repeats the recent bytes
+			for (ULONG i = 0; i < matchLength; i++)
+				out[i] = ref[i];
+		}
+
+		out += matchLength;
+	}
+
+	return out == outEnd;
+}
@@ -0,0 +1,44 @@
+/*
+ *	PROGRAM:	Common class definition
+ *	MODULE:		Lz4.h
+ *	DESCRIPTION:	LZ4 block format compression.
+ *
+ *  The contents of this file are subject to the Initial
+ *  Developer's Public License Version 1.0 (the "License");
+ *  you may not use this file except in compliance with the
+ *  License. You may obtain a copy of the License at
+ *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+ *
+ *  Software distributed under the License is distributed AS IS,
+ *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing rights
+ *  and limitations under the License.
+ *
+ *  All Rights Reserved.
+ *  Contributor(s): ______________________________________.
+ */
+
+#ifndef COMMON_LZ4_H
+#define COMMON_LZ4_H
+
+namespace Firebird {
+
+// Compresses short (up to 64KB) buffers like database pages into the LZ4 block format,
+// thus they may be also decompressed by the LZ4 library. Compression is single pass
+// and greedy, it's fast but doesn't give the best possible compression ratio.
+
+class Lz4
+{
+public:
+	static constexpr ULONG MAX_INPUT_LENGTH = 65536;
+
+	// Returns the compressed length, or zero if it doesn't fit into the output
+	static ULONG compress(const UCHAR* input, ULONG inLength, UCHAR* output, ULONG outCapacity) noexcept;
+
+	// Returns false if the input is corrupted or isn't decompressed to exactly outLength bytes
+	static bool decompress(const UCHAR* input, ULONG inLength, UCHAR* output, ULONG outLength) noexcept;
+};
+
+} // namespace Firebird
+
+#endif // COMMON_LZ4_H
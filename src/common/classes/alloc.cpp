@@ -66,6 +66,7 @@
 #include "../common/config/config.h"
 #include "../common/os/os_utils.h"
 #include "../common/os/fbsyslog.h"
+#include "../common/utils_proto.h"
 #include "iberror.h"
 
 #ifdef USE_VALGRIND
@@ -199,6 +200,50 @@ inline size_t get_map_page_size()
 	return map_page_size;
 }
 
+
+// Large blocks may be backed by 2MB huge pages, see MemoryHugePages in firebird.conf
+
+const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+enum HugePages
+{
+	HUGE_PAGES_UNKNOWN,
+	HUGE_PAGES_NONE,
+	HUGE_PAGES_TRANSPARENT,
+	HUGE_PAGES_EXPLICIT
+};
+
+HugePages get_huge_pages()
+{
+	// Read once, same setting is used when block is allocated and released.
+	// Config is not read under cache_mutex as loading it allocates memory,
+	// concurrent callers get the same value anyway.
+	static volatile HugePages huge_pages = HUGE_PAGES_UNKNOWN;
+	if (huge_pages == HUGE_PAGES_UNKNOWN)
+	{
+		const char* const value = Firebird::Config::getMemoryHugePages();
+
+		if (value && fb_utils::stricmp(value, Firebird::MemoryHugePagesTransparent) == 0)
+			huge_pages = HUGE_PAGES_TRANSPARENT;
+		else if (value && fb_utils::stricmp(value, Firebird::MemoryHugePagesExplicit) == 0)
+			huge_pages = HUGE_PAGES_EXPLICIT;
+		else
+			huge_pages = HUGE_PAGES_NONE;
+	}
+	return huge_pages;
+}
+
+inline bool use_huge_pages(size_t size)
+{
+	return size >= HUGE_PAGE_SIZE && get_huge_pages() != HUGE_PAGES_NONE;
+}
+
+// Size of OS mapping for the block of given size
+inline size_t get_map_size(size_t size)
+{
+	return FB_ALIGN(size, use_huge_pages(size) ? HUGE_PAGE_SIZE : get_map_page_size());
+}
+
 } // anonymous namespace
 
 namespace Firebird {
@@ -684,7 +729,7 @@ public:
 		block->assertBig();
 		fb_assert(block->getSize() + hdrSize() == length);
 
-		vMap += FB_ALIGN(length, get_map_page_size());
+		vMap += get_map_size(length);
 		block->validate(pool, vUse);
 	}
 };
@@ -2380,7 +2425,7 @@ void MemPool::releaseBlock(MemBlock* block, bool decrUsage) noexcept
 
 	MemBigHunk* hunk = (MemBigHunk*)(((UCHAR*)block) - MemBigHunk::hdrSize());
 	SemiDoubleLink::remove(hunk);
-	decrement_mapping(FB_ALIGN(hunk->length, get_map_page_size()));
+	decrement_mapping(get_map_size(hunk->length));
 	releaseRaw(pool_destroying, hunk, hunk->length, nullptr);
 }
 
@@ -2404,11 +2449,23 @@ void* MemPool::allocRaw(size_t size)
 	}
 #endif
 
-	size = FB_ALIGN(size, get_map_page_size());
+	size = get_map_size(size);
 
 #ifdef WIN_NT
 
-	void* result = VirtualAlloc(NULL, size, MEM_COMMIT, PAGE_READWRITE);
+	void* result = NULL;
+
+	// Requires SeLockMemoryPrivilege, regular pages are used when it's missing
+	if (use_huge_pages(size) && get_huge_pages() == HUGE_PAGES_EXPLICIT)
+	{
+		const SIZE_T large_page = GetLargePageMinimum();
+		if (large_page && size % large_page == 0)
+			result = VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+	}
+
+	if (!result)
+		result = VirtualAlloc(NULL, size, MEM_COMMIT, PAGE_READWRITE);
+
 	if (!result)
 	{
 
@@ -2438,7 +2495,31 @@ void* MemPool::allocRaw(size_t size)
 
 #ifdef MAP_ANONYMOUS
 
-		result = os_utils::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		const bool huge = use_huge_pages(size);
+		result = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+		// Huge pages reserved by administrator, fall back to regular ones when exhausted
+		if (huge && get_huge_pages() == HUGE_PAGES_EXPLICIT)
+		{
+			int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_2MB
+			flags |= MAP_HUGE_2MB;
+#endif
+			result = os_utils::mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+		}
+#endif // MAP_HUGETLB
+
+		if (result == MAP_FAILED)
+		{
+			result = os_utils::mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+#ifdef MADV_HUGEPAGE
+			// Just a hint - nothing bad happens if transparent huge pages are disabled
+			if (huge && result != MAP_FAILED)
+				madvise(result, size, MADV_HUGEPAGE);
+#endif
+		}
 
 #else // MAP_ANONYMOUS
 
@@ -2515,7 +2596,7 @@ void MemPool::releaseRaw(bool destroying, void* block, size_t size, ExtentsCache
 	VALGRIND_MAKE_MEM_NOACCESS(block, size);
 #endif
 
-	size = FB_ALIGN(size, get_map_page_size());
+	size = get_map_size(size);
 
 	void* unmapBlockPtr = block;
 	size_t unmapBlockSize = size;
@@ -2554,7 +2635,7 @@ void MemPool::releaseRaw(bool destroying, void* block, size_t size, ExtentsCache
 	}
 #endif
 
-	size = FB_ALIGN(size, get_map_page_size());
+	size = get_map_size(size);
 #ifdef WIN_NT
 	if (!VirtualFree(block, 0, MEM_RELEASE))
 	{
@@ -0,0 +1,150 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../common/classes/Lz4.h"
+#include "../common/classes/array.h"
+
+using namespace Firebird;
+
+namespace
+{
+	class Generator
+	{
+	public:
+		ULONG next()
+		{
+			m_seed ^= m_seed << 13;
+			m_seed ^= m_seed >> 17;
+			m_seed ^= m_seed << 5;
+			return m_seed;
+		}
+
+	private:
+		ULONG m_seed = 2463534242u;
+	};
+
+	// Records of a data page: repeating text, small numbers and unused space
+	void fillPage(Generator& generator, UCHAR* data, ULONG length)
+	{
+		static const char TEXT[] = "Firebird data page 0123456789";
+
+		for (ULONG i = 0; i < length; i++)
+		{
+			if (i % 200 >= 120)
+				data[i] = 0;
+			else if (generator.next() % 5 == 0)
+				data[i] = (UCHAR) generator.next();
+			else
+				data[i] = TEXT[(i * 7) % (sizeof(TEXT) - 1)];
+		}
+	}
+
+	ULONG checkRoundTrip(const UCHAR* data, ULONG length)
+	{
+		Array<UCHAR> compressed, decompressed;
+		const ULONG capacity = length + length / 255 + 16;
+
+		const ULONG compressedLength = Lz4::compress(data, length, compressed.getBuffer(capacity), capacity);
+		BOOST_TEST(compressedLength != 0u);
+
+		BOOST_TEST(Lz4::decompress(compressed.begin(), compressedLength,
+			decompressed.getBuffer(length + 1), length));
+		BOOST_TEST(memcmp(decompressed.begin(), data, length) == 0);
+
+		// Length of the output must match exactly
+		if (length)
+		{
+			BOOST_TEST(!Lz4::decompress(compressed.begin(), compressedLength,
+				decompressed.begin(), length - 1));
+		}
+
+		BOOST_TEST(!Lz4::decompress(compressed.begin(), compressedLength,
+			decompressed.begin(), length + 1));
+
+		return compressedLength;
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(CommonSuite)
+BOOST_AUTO_TEST_SUITE(Lz4Suite)
+
+
+BOOST_AUTO_TEST_CASE(RoundTripTest)
+{
+	Generator generator;
+	Array<UCHAR> data;
+
+	for (ULONG length = 0; length <= 300; length++)
+	{
+		UCHAR* const p = data.getBuffer(length);
+
+		for (ULONG i = 0; i < length; i++)
+			p[i] = (UCHAR) (generator.next() % 3);
+
+		checkRoundTrip(p, length);
+	}
+
+	for (const ULONG length : {4096u, 8192u, 16384u, 32768u, 65536u})
+	{
+		UCHAR* const p = data.getBuffer(length);
+
+		fillPage(generator, p, length);
+		BOOST_TEST(checkRoundTrip(p, length) < length / 2);
+
+		memset(p, 0, length);
+		BOOST_TEST(checkRoundTrip(p, length) < length / 100);
+
+		for (ULONG i = 0; i < length; i++)
+			p[i] = (UCHAR) generator.next();
+
+		checkRoundTrip(p, length);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CapacityTest)
+{
+	Generator generator;
+	UCHAR data[8192], compressed[8192];
+
+	for (auto& c : data)
+		c = (UCHAR) generator.next();
+
+	// Random data doesn't compress
+	BOOST_TEST(Lz4::compress(data, sizeof(data), compressed, sizeof(compressed)) == 0u);
+
+	fillPage(generator, data, sizeof(data));
+	const ULONG length = Lz4::compress(data, sizeof(data), compressed, sizeof(compressed));
+	BOOST_TEST(length != 0u);
+	BOOST_TEST(Lz4::compress(data, sizeof(data), compressed, length - 1) == 0u);
+}
+
+// Decompression must never write outside the output, whatever the input is
+BOOST_AUTO_TEST_CASE(CorruptedInputTest)
+{
+	Generator generator;
+	UCHAR data[8192], compressed[8192], decompressed[sizeof(data) + 16];
+
+	fillPage(generator, data, sizeof(data));
+	const ULONG length = Lz4::compress(data, sizeof(data), compressed, sizeof(compressed));
+	BOOST_TEST(length != 0u);
+
+	for (unsigned i = 0; i < 1000; i++)
+	{
+		UCHAR corrupted[sizeof(compressed)];
+		memcpy(corrupted, compressed, length);
+		corrupted[generator.next() % length] ^= (UCHAR) (1 + generator.next() % 255);
+
+		memset(decompressed, 0xAA, sizeof(decompressed));
+		Lz4::decompress(corrupted, length - generator.next() % 2, decompressed, sizeof(data));
+
+		for (ULONG j = sizeof(data); j < sizeof(decompressed); j++)
+			BOOST_TEST(decompressed[j] == 0xAA);
+	}
+
+	// Offset beyond the start of output
+	const UCHAR badOffset[] = {0x10, 'a', 0xFF, 0x00, 0x00};
+	BOOST_TEST(!Lz4::decompress(badOffset, sizeof(badOffset), decompressed, 5));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// Lz4Suite
+BOOST_AUTO_TEST_SUITE_END()	// CommonSuite
@@ -137,6 +137,16 @@ const char*	GCPolicyCooperative	= "cooperative";
 const char*	GCPolicyBackground	= "background";
 const char*	GCPolicyCombined	= "combined";
 
+const char*	PageReplacementLRU	= "LRU";
+const char*	PageReplacement2Q	= "2Q";
+
+const char*	PageCachePlacementThread	= "thread";
+const char*	PageCachePlacementHash		= "hash";
+
+const char*	MemoryHugePagesNone			= "none";
+const char*	MemoryHugePagesTransparent	= "transparent";
+const char*	MemoryHugePagesExplicit		= "explicit";
+
 ConfigValue Config::defaults[MAX_CONFIG_KEY];
 
 /******************************************************************************
@@ -379,6 +389,42 @@ void Config::checkValues()
 		}
 	}
 
+	strVal = values[KEY_PAGE_REPLACEMENT_POLICY].strVal;
+	if (strVal)
+	{
+		NoCaseString policy(strVal);
+		if (policy != PageReplacementLRU && policy != PageReplacement2Q)
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_PAGE_REPLACEMENT_POLICY] = defaults[KEY_PAGE_REPLACEMENT_POLICY];
+		}
+	}
+
+	checkIntForLoBound(KEY_PAGE_CACHE_PARTITIONS, 0, true);
+
+	strVal = values[KEY_PAGE_CACHE_PLACEMENT].strVal;
+	if (strVal)
+	{
+		NoCaseString placement(strVal);
+		if (placement != PageCachePlacementThread && placement != PageCachePlacementHash)
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_PAGE_CACHE_PLACEMENT] = defaults[KEY_PAGE_CACHE_PLACEMENT];
+		}
+	}
+
+	strVal = values[KEY_MEMORY_HUGE_PAGES].strVal;
+	if (strVal)
+	{
+		NoCaseString hugePages(strVal);
+		if (hugePages != MemoryHugePagesNone && hugePages != MemoryHugePagesTransparent &&
+			hugePages != MemoryHugePagesExplicit)
+		{
+			// user-provided value is invalid - fail to default
+			values[KEY_MEMORY_HUGE_PAGES] = defaults[KEY_MEMORY_HUGE_PAGES];
+		}
+	}
+
 	strVal = values[KEY_WIRE_CRYPT].strVal;
 	if (strVal)
 	{
@@ -424,6 +470,10 @@ void Config::checkValues()
 
 	checkIntForLoBound(KEY_PARALLEL_WORKERS, 1, true);
 	checkIntForHiBound(KEY_PARALLEL_WORKERS, values[KEY_MAX_PARALLEL_WORKERS].intVal, false);
+
+	checkIntForLoBound(KEY_HASH_JOIN_MEMORY_LIMIT, 0, true);
+
+	checkIntForLoBound(KEY_ADAPTIVE_JOIN_FACTOR, 0, true);
 }
 
 
@@ -78,6 +78,16 @@ extern const char*	GCPolicyCooperative;
 extern const char*	GCPolicyBackground;
 extern const char*	GCPolicyCombined;
 
+extern const char*	PageReplacementLRU;
+extern const char*	PageReplacement2Q;
+
+extern const char*	PageCachePlacementThread;
+extern const char*	PageCachePlacementHash;
+
+extern const char*	MemoryHugePagesNone;
+extern const char*	MemoryHugePagesTransparent;
+extern const char*	MemoryHugePagesExplicit;
+
 inline constexpr int WIRE_CRYPT_DISABLED = 0;
 inline constexpr int WIRE_CRYPT_ENABLED = 1;
 inline constexpr int WIRE_CRYPT_REQUIRED = 2;
@@ -186,6 +196,14 @@ enum ConfigKey
 	KEY_PARALLEL_WORKERS,
 	KEY_MAX_PARALLEL_WORKERS,
 	KEY_OPTIMIZE_FOR_FIRST_ROWS,
+	KEY_HASH_JOIN_MEMORY_LIMIT,
+	KEY_PAGE_REPLACEMENT_POLICY,
+	KEY_PAGE_CACHE_PARTITIONS,
+	KEY_PAGE_CACHE_PLACEMENT,
+	KEY_ADAPTIVE_JOIN_FACTOR,
+	KEY_PAGE_COMPRESSION,
+	KEY_INDEX_BULK_INSERT_THRESHOLD,
+	KEY_MEMORY_HUGE_PAGES,
 	MAX_CONFIG_KEY		// keep it last
 };
 
@@ -298,7 +316,15 @@ inline constexpr ConfigEntry entries[MAX_CONFIG_KEY] =
 	{TYPE_INTEGER,	"MaxStatementCacheSize",	false,	2 * 1048576},	// bytes
 	{TYPE_INTEGER,	"ParallelWorkers",			true,	1},
 	{TYPE_INTEGER,	"MaxParallelWorkers",		true,	1},
-	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false}
+	{TYPE_BOOLEAN,	"OptimizeForFirstRows",		false,	false},
+	{TYPE_INTEGER,	"HashJoinMemoryLimit",		false,	64 * 1048576},	// bytes
+	{TYPE_STRING,	"PageReplacementPolicy",	false,	"LRU"},		// page cache replacement policy
+	{TYPE_INTEGER,	"PageCachePartitions",		false,	1},			// 0 - one partition per NUMA node
+	{TYPE_STRING,	"PageCachePlacement",		false,	"thread"},	// how pages are placed into partitions
+	{TYPE_INTEGER,	"AdaptiveJoinFactor",		false,	0},		// 0 - never switch nested loop to hash join
+	{TYPE_BOOLEAN,	"PageCompression",			false,	false},		// compress data and blob pages on disk
+	{TYPE_INTEGER,	"IndexBulkInsertThreshold",	false,	0},			// records, 0 - insert index keys at once
+	{TYPE_STRING,	"MemoryHugePages",			true,	"none"}		// huge pages for large memory blocks
 };
 
 
@@ -619,6 +645,22 @@ public:
 	CONFIG_GET_GLOBAL_INT(getMaxParallelWorkers, KEY_MAX_PARALLEL_WORKERS);
 
 	CONFIG_GET_PER_DB_BOOL(getOptimizeForFirstRows, KEY_OPTIMIZE_FOR_FIRST_ROWS);
+
+	CONFIG_GET_PER_DB_KEY(FB_UINT64, getHashJoinMemoryLimit, KEY_HASH_JOIN_MEMORY_LIMIT, getInt);
+
+	CONFIG_GET_PER_DB_STR(getPageReplacementPolicy, KEY_PAGE_REPLACEMENT_POLICY);
+
+	CONFIG_GET_PER_DB_INT(getPageCachePartitions, KEY_PAGE_CACHE_PARTITIONS);
+
+	CONFIG_GET_PER_DB_STR(getPageCachePlacement, KEY_PAGE_CACHE_PLACEMENT);
+
+	CONFIG_GET_PER_DB_INT(getAdaptiveJoinFactor, KEY_ADAPTIVE_JOIN_FACTOR);
+
+	CONFIG_GET_PER_DB_BOOL(getPageCompression, KEY_PAGE_COMPRESSION);
+
+	CONFIG_GET_PER_DB_INT(getIndexBulkInsertThreshold, KEY_INDEX_BULK_INSERT_THRESHOLD);
+
+	CONFIG_GET_GLOBAL_STR(getMemoryHugePages, KEY_MEMORY_HUGE_PAGES);
 };
 
 // Implementation of interface to access master configuration file
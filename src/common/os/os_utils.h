@@ -362,6 +362,13 @@ namespace os_utils
 	void setDefaultAffinity();
 #endif
 
+	// NUMA topology, 1 node is reported if it's unknown or not supported
+	unsigned getNumaNodes();
+	// CPU and NUMA node the calling thread runs on
+	void getCurrentCpu(unsigned& cpu, unsigned& node);
+	// ask OS to place given memory at given NUMA node, best effort
+	void bindToNumaNode(void* memory, size_t size, unsigned node);
+
 	class CtrlCHandler
 	{
 	public:
@@ -84,6 +84,15 @@
 #include <utime.h>
 #endif
 
+#ifdef LINUX
+#include <sys/syscall.h>
+#include <sched.h>
+#endif
+
+#ifdef HAVE_LINUX_MEMPOLICY_H
+#include <linux/mempolicy.h>
+#endif
+
 #include <stdio.h>
 
 using namespace Firebird;
@@ -428,6 +437,139 @@ void getUniqueFileId(const char* name, UCharBuffer& id)
 	makeUniqueFileId(statistics, id);
 }
 
+
+namespace
+{
+	// NUMA topology read once from sysfs: number of nodes and node of every CPU
+
+	class NumaTopology
+	{
+	public:
+		explicit NumaTopology(MemoryPool& pool)
+			: cpuNodes(pool), nodes(1)
+		{
+#ifdef HAVE_LINUX_MEMPOLICY_H
+			// Online nodes and CPUs of a node are listed as ranges, e.g. "0" or "0-1,3"
+			const auto online = readList("/sys/devices/system/node/online");
+			for (const auto node : online)
+			{
+				nodes = MAX(nodes, node + 1);
+
+				char path[BUFFER_SMALL];
+				snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+
+				for (const auto cpu : readList(path))
+				{
+					if (cpu >= cpuNodes.getCount())
+						cpuNodes.grow(cpu + 1);
+
+					cpuNodes[cpu] = node;
+				}
+			}
+#endif
+		}
+
+		unsigned getNodes() const
+		{
+			return nodes;
+		}
+
+		unsigned getNode(unsigned cpu) const
+		{
+			return (cpu < cpuNodes.getCount()) ? cpuNodes[cpu] : 0;
+		}
+
+	private:
+		static HalfStaticArray<unsigned, 64> readList(const char* fileName)
+		{
+			HalfStaticArray<unsigned, 64> list;
+
+			FILE* const file = os_utils::fopen(fileName, "r");
+			if (!file)
+				return list;
+
+			char buffer[BUFFER_LARGE];
+
+			if (fgets(buffer, sizeof(buffer), file))
+			{
+				for (const char* p = buffer; *p; )
+				{
+					if (!isdigit(*p))
+					{
+						p++;
+						continue;
+					}
+
+					char* end;
+					const unsigned first = (unsigned) strtoul(p, &end, 10);
+					unsigned last = first;
+
+					if (*end == '-' && isdigit(end[1]))
+						last = (unsigned) strtoul(end + 1, &end, 10);
+
+					for (unsigned n = first; n <= last && n < MAX_CPUS; n++)
+						list.add(n);
+
+					p = end;
+				}
+			}
+
+			fclose(file);
+			return list;
+		}
+
+		static const unsigned MAX_CPUS = 65536;
+
+		HalfStaticArray<unsigned, 64> cpuNodes;
+		unsigned nodes;
+	};
+
+	InitInstance<NumaTopology> numaTopology;
+}
+
+
+unsigned getNumaNodes()
+{
+	return numaTopology().getNodes();
+}
+
+
+void getCurrentCpu(unsigned& cpu, unsigned& node)
+{
+#ifdef LINUX
+	const int current = sched_getcpu();
+	if (current >= 0)
+	{
+		cpu = current;
+		node = numaTopology().getNode(cpu);
+		return;
+	}
+#endif
+
+	cpu = node = 0;
+}
+
+
+void bindToNumaNode(void* memory, size_t size, unsigned node)
+{
+#if defined(HAVE_LINUX_MEMPOLICY_H) && defined(SYS_mbind)
+	const unsigned long maxNode = sizeof(unsigned long) * 8;
+
+	if (node >= maxNode - 1)
+		return;
+
+	const unsigned long nodeMask = 1UL << node;
+
+	// mbind() works with whole pages, leave partial ones to the first touch
+	const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+	const uintptr_t begin = ((uintptr_t) memory + pageSize - 1) & ~(pageSize - 1);
+	const uintptr_t end = ((uintptr_t) memory + size) & ~(pageSize - 1);
+
+	if (begin < end)
+		syscall(SYS_mbind, begin, end - begin, MPOL_PREFERRED, &nodeMask, maxNode, MPOL_MF_MOVE);
+#endif
+}
+
 /// class CtrlCHandler
 
 bool CtrlCHandler::terminated = false;
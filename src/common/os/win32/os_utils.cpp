@@ -621,6 +621,37 @@ void setDefaultAffinity()
 }
 
 
+unsigned getNumaNodes()
+{
+	ULONG highest = 0;
+	if (!GetNumaHighestNodeNumber(&highest))
+		return 1;
+
+	return highest + 1;
+}
+
+
+void getCurrentCpu(unsigned& cpu, unsigned& node)
+{
+	PROCESSOR_NUMBER number;
+	GetCurrentProcessorNumberEx(&number);
+
+	USHORT nodeNumber = 0;
+	if (!GetNumaProcessorNodeEx(&number, &nodeNumber))
+		nodeNumber = 0;
+
+	cpu = number.Group * 64 + number.Number;
+	node = nodeNumber;
+}
+
+
+void bindToNumaNode(void* /*memory*/, size_t /*size*/, unsigned /*node*/)
+{
+	// Memory of existing allocation can't be moved to another node, it's placed
+	// at the node of thread that touches it first.
+}
+
+
 /// class CtrlCHandler
 
 bool CtrlCHandler::terminated = false;
@@ -1199,7 +1199,7 @@ public:
 	}
 
 	static SSHORT store(thread_db* tdbb, jrd_tra* transaction, const QualifiedName& name,
-		fb_sysflag sysFlag, SINT64 value, SLONG step);
+		fb_sysflag sysFlag, SINT64 value, SLONG step, SLONG cacheSize = 1);
 
 public:
 	Firebird::string internalPrint(NodePrinter& printer) const override;
@@ -1239,6 +1239,7 @@ public:
 	QualifiedName name;
 	std::optional<SINT64> value;
 	std::optional<SLONG> step;
+	std::optional<SLONG> cacheSize;
 };
 
 
@@ -1415,7 +1416,8 @@ public:
 			TYPE_DROP_COLUMN,
 			TYPE_DROP_CONSTRAINT,
 			TYPE_ALTER_SQL_SECURITY,
-			TYPE_ALTER_PUBLICATION
+			TYPE_ALTER_PUBLICATION,
+			TYPE_ALTER_ENCODING
 		};
 
 		explicit Clause(MemoryPool& p, Type aType) noexcept
@@ -1668,6 +1670,7 @@ public:
 	std::optional<ULONG> tempRowsFlag;	// REL_temp_tran, REL_temp_conn
 	Firebird::TriState ssDefiner;
 	Firebird::TriState replicationState;
+	Firebird::TriState encodingState;
 };
 
 
@@ -2025,6 +2028,39 @@ public:
 };
 
 
+class SetTableStatisticsNode final : public DdlNode
+{
+public:
+	SetTableStatisticsNode(MemoryPool& p, const QualifiedName& aName)
+		: DdlNode(p),
+		  name(p, aName)
+	{
+	}
+
+public:
+	Firebird::string internalPrint(NodePrinter& printer) const override;
+	void checkPermission(thread_db* tdbb, jrd_tra* transaction) override;
+	void execute(thread_db* tdbb, DsqlCompilerScratch* dsqlScratch, jrd_tra* transaction) override;
+
+	DdlNode* dsqlPass(DsqlCompilerScratch* dsqlScratch) override
+	{
+		dsqlScratch->qualifyExistingName(name, obj_relation);
+		dsqlScratch->ddlSchema = name.schema;
+
+		return DdlNode::dsqlPass(dsqlScratch);
+	}
+
+protected:
+	void putErrorPrefix(Firebird::Arg::StatusVector& statusVector) override
+	{
+		statusVector << Firebird::Arg::Gds(isc_dsql_alter_table_failed) << name.toQuotedString();
+	}
+
+public:
+	QualifiedName name;
+};
+
+
 class DropIndexNode final : public DdlNode
 {
 public:
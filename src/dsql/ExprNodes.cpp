@@ -5180,7 +5180,7 @@ ValueExprNode* DefaultNode::createFromField(thread_db* tdbb, CompilerScratch* cs
 			csb->csb_pool, (csb->blrVersion == 4), fld->fld_generator_name, NULL, true, true);
 
 		bool sysGen = false;
-		if (!MET_load_generator(tdbb, genNode->generator, &sysGen, &genNode->step))
+		if (!MET_load_generator(tdbb, genNode->generator, &sysGen, &genNode->step, &genNode->cacheSize))
 			status_exception::raise(Arg::Gds(isc_gennotdef) << fld->fld_generator_name.toQuotedString());
 
 		if (sysGen)
@@ -7121,6 +7121,7 @@ GenIdNode::GenIdNode(MemoryPool& pool, bool aDialect1,
 	  generator(pool, name),
 	  arg(aArg),
 	  step(0),
+	  cacheSize(1),
 	  dialect1(aDialect1),
 	  sysGen(false),
 	  implicit(aImplicit),
@@ -7156,7 +7157,7 @@ DmlNode* GenIdNode::parse(thread_db* tdbb, MemoryPool& pool, CompilerScratch* cs
 
 		node->generator.id = 0;
 	}
-	else if (!MET_load_generator(tdbb, node->generator, &node->sysGen, &node->step))
+	else if (!MET_load_generator(tdbb, node->generator, &node->sysGen, &node->step, &node->cacheSize))
 		PAR_error(csb, Arg::Gds(isc_gennotdef) << name.toQuotedString());
 
 	if (csb->collectingDependencies())
@@ -7177,6 +7178,7 @@ string GenIdNode::internalPrint(NodePrinter& printer) const
 	NODE_PRINT(printer, generator);
 	NODE_PRINT(printer, arg);
 	NODE_PRINT(printer, step);
+	NODE_PRINT(printer, cacheSize);
 	NODE_PRINT(printer, sysGen);
 	NODE_PRINT(printer, implicit);
 	NODE_PRINT(printer, identity);
@@ -7192,6 +7194,7 @@ ValueExprNode* GenIdNode::dsqlPass(DsqlCompilerScratch* dsqlScratch)
 		dialect1, generator.name, doDsqlPass(dsqlScratch, arg), implicit, identity);
 	node->generator = generator;
 	node->step = step;
+	node->cacheSize = cacheSize;
 	node->sysGen = sysGen;
 	return node;
 }
@@ -7270,6 +7273,7 @@ ValueExprNode* GenIdNode::copy(thread_db* tdbb, NodeCopier& copier) const
 				  copier.copy(tdbb, arg), implicit, identity);
 	node->generator = generator;
 	node->step = step;
+	node->cacheSize = cacheSize;
 	node->sysGen = sysGen;
 	return node;
 }
@@ -7349,7 +7353,10 @@ dsc* GenIdNode::execute(thread_db* tdbb, Request* request) const
 			status_exception::raise(Arg::Gds(isc_cant_modify_sysobj) << "generator" << generator.name.toQuotedString());
 	}
 
-	const SINT64 new_val = DPM_gen_id(tdbb, generator.id, false, change);
+	// NEXT VALUE FOR takes values reserved by the attachment, if the sequence allows that
+	const SINT64 new_val = (implicit && cacheSize > 1) ?
+		tdbb->getAttachment()->att_generator_cache.next(tdbb, generator.id, generator.name, step, cacheSize) :
+		DPM_gen_id(tdbb, generator.id, false, change);
 
 	if (dialect1)
 		impure->make_long((SLONG) new_val);
@@ -926,6 +926,7 @@ public:
 	GeneratorItem generator;
 	NestConst<ValueExprNode> arg;
 	SLONG step;
+	SLONG cacheSize;
 	const bool dialect1;
 
 private:
@@ -706,9 +706,11 @@ using namespace Firebird;
 %token <metaNamePtr> BIN_OR_AGG
 %token <metaNamePtr> BIN_XOR_AGG
 %token <metaNamePtr> BTRIM
+%token <metaNamePtr> CACHE
 %token <metaNamePtr> CALL
 %token <metaNamePtr> CURRENT_SCHEMA
 %token <metaNamePtr> DOWNTO
+%token <metaNamePtr> ENCODING
 %token <metaNamePtr> ERROR
 %token <metaNamePtr> FORMAT
 %token <metaNamePtr> GENERATE_SERIES
@@ -2009,6 +2011,7 @@ create_sequence_options($seqNode)
 create_seq_option($seqNode)
 	: start_with_opt($seqNode)
 	| step_option($seqNode)
+	| cache_option($seqNode)
 	;
 
 %type start_with_opt(<createAlterSequenceNode>)
@@ -2026,6 +2029,14 @@ step_option($seqNode)
 		{ setClause($seqNode->step, "INCREMENT BY", $3); }
 	;
 
+%type cache_option(<createAlterSequenceNode>)
+cache_option($seqNode)
+	: CACHE pos_short_integer
+		{ setClause($seqNode->cacheSize, "CACHE", $2); }
+	| NO CACHE
+		{ setClause($seqNode->cacheSize, "CACHE", 1); }
+	;
+
 by_noise
 	: // nothing
 	| BY
@@ -2041,7 +2052,7 @@ replace_sequence_clause
 	  replace_sequence_options($2)
 		{
 			// Remove this to implement CORE-5137
-			if (!$2->restartSpecified && !$2->step.has_value())
+			if (!$2->restartSpecified && !$2->step.has_value() && !$2->cacheSize.has_value())
 				yyerrorIncompleteCmd(YYPOSNARG(3));
 			$$ = $2;
 		}
@@ -2061,6 +2072,7 @@ replace_seq_option($seqNode)
 		}
 	| start_with_opt($seqNode)
 	| step_option($seqNode)
+	| cache_option($seqNode)
 	;
 
 %type <createAlterSequenceNode> alter_sequence_clause
@@ -2074,8 +2086,11 @@ alter_sequence_clause
 		}
 	  alter_sequence_options($2)
 		{
-			if (!$2->restartSpecified && !$2->value.has_value() && !$2->step.has_value())
+			if (!$2->restartSpecified && !$2->value.has_value() && !$2->step.has_value() &&
+				!$2->cacheSize.has_value())
+			{
 				yyerrorIncompleteCmd(YYPOSNARG(3));
+			}
 			$$ = $2;
 		}
 
@@ -2089,6 +2104,7 @@ alter_sequence_options($seqNode)
 alter_seq_option($seqNode)
 	: restart_option($seqNode)
 	| step_option($seqNode)
+	| cache_option($seqNode)
 	;
 
 
@@ -2396,6 +2412,8 @@ table_attribute($relationNode)
 		{ setClause($relationNode->ssDefiner, "SQL SECURITY", $1); }
 	| publication_state
 		{ setClause($relationNode->replicationState, "PUBLICATION", $1); }
+	| encoding_state
+		{ setClause($relationNode->encodingState, "COLUMN ENCODING", $1); }
 	;
 
 %type <boolVal> sql_security_clause
@@ -2410,6 +2428,12 @@ publication_state
 	| DISABLE PUBLICATION		{ $$ = false; }
 	;
 
+%type <boolVal> encoding_state
+encoding_state
+	: ENABLE COLUMN ENCODING	{ $$ = true; }
+	| DISABLE COLUMN ENCODING	{ $$ = false; }
+	;
+
 %type <createRelationNode> gtt_table_clause
 gtt_table_clause
 	: simple_table_name
@@ -4641,6 +4665,13 @@ alter_op($relationNode)
 				newNode<RelationNode::Clause>(RelationNode::Clause::TYPE_ALTER_PUBLICATION);
 			$relationNode->clauses.add(clause);
 		}
+	| encoding_state
+		{
+			setClause($relationNode->encodingState, "COLUMN ENCODING", $1);
+			RelationNode::Clause* clause =
+				newNode<RelationNode::Clause>(RelationNode::Clause::TYPE_ALTER_ENCODING);
+			$relationNode->clauses.add(clause);
+		}
 	;
 
 %type <metaNamePtr> alter_column_name
@@ -6188,6 +6219,8 @@ table_list
 set_statistics
 	: SET STATISTICS INDEX symbol_index_name
 		{ $$ = newNode<SetStatisticsNode>(*$4); }
+	| SET STATISTICS TABLE symbol_table_name
+		{ $$ = newNode<SetTableStatisticsNode>(*$4); }
 	;
 
 %type <ddlNode> comment
@@ -10091,7 +10124,9 @@ non_reserved_word
 	| BIN_AND_AGG
 	| BIN_OR_AGG
 	| BIN_XOR_AGG
+	| CACHE
 	| DOWNTO
+	| ENCODING
 	| FORMAT
 	| GENERATE_SERIES
 	| OWNER
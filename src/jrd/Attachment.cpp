@@ -53,6 +53,7 @@
 #include "../common/classes/fb_string.h"
 #include "../common/StatusArg.h"
 #include "../common/TimeZoneUtil.h"
+#include "../common/Task.h"
 #include "../common/isc_proto.h"
 #include "../common/classes/RefMutex.h"
 
@@ -269,6 +270,7 @@ Jrd::Attachment::Attachment(MemoryPool* pool, Database* dbb, JProvider* provider
 	  att_procedures(*pool),
 	  att_functions(*pool),
 	  att_generators(*pool),
+	  att_generator_cache(*pool),
 	  att_internal(*pool),
 	  att_dyn_req(*pool),
 	  att_internal_cached_statements(*pool),
@@ -815,7 +817,13 @@ void Jrd::Attachment::releaseLocks(thread_db* tdbb)
 				{
 					if (index->idb_lock)
 						LCK_release(tdbb, index->idb_lock);
+
+					if (index->idb_histogram_lock)
+						LCK_release(tdbb, index->idb_histogram_lock);
 				}
+
+				if (relation->rel_histogram_lock)
+					LCK_release(tdbb, relation->rel_histogram_lock);
 			}
 		}
 	}
@@ -882,6 +890,8 @@ void Jrd::Attachment::releaseLocks(thread_db* tdbb)
 	if (att_profiler_listener_lock)
 		LCK_release(tdbb, att_profiler_listener_lock);
 
+	att_generator_cache.releaseLocks(tdbb);
+
 	// And release the system requests
 
 	for (Statement** itr = att_internal.begin(); itr != att_internal.end(); ++itr)
@@ -1231,6 +1241,43 @@ void Attachment::releaseProfilerManager(thread_db* tdbb)
 		att_profiler_manager.reset();
 }
 
+// In-memory sorts (sort buffers, hash join tables) don't access the engine, so their
+// worker threads need no attachments. The threads are kept between the sorts.
+// Sort buffers are sorted with the attachment checked out, so another request of the
+// attachment may find the threads busy, then it should sort serially.
+
+bool Attachment::runSortTask(Task* task)
+{
+	if (!att_sort_mutex.tryEnter(FB_FUNCTION))
+		return false;
+
+	try
+	{
+		if (!att_sort_coordinator)
+			att_sort_coordinator.reset(FB_NEW_POOL(*att_pool) Coordinator(att_pool));
+
+		att_sort_coordinator->runSync(task);
+	}
+	catch (const Exception&)
+	{
+		att_sort_mutex.leave();
+		throw;
+	}
+
+	att_sort_mutex.leave();
+	return true;
+}
+
+void Attachment::releaseSortCoordinator(thread_db* tdbb)
+{
+	if (!att_sort_coordinator)
+		return;
+
+	// Coordinator waits for its threads to finish
+	EngineCheckout cout(tdbb, FB_FUNCTION);
+	att_sort_coordinator.reset();
+}
+
 bool Attachment::qualifyNewName(thread_db* tdbb, QualifiedName& name, const ObjectsArray<MetaString>* schemaSearchPath)
 {
 	if (!schemaSearchPath)
@@ -34,6 +34,7 @@
 #include "../jrd/RuntimeStatistics.h"
 #include "../jrd/Coercion.h"
 #include "../jrd/LocalTemporaryTable.h"
+#include "../jrd/GeneratorCache.h"
 
 #include "../common/classes/ByteChunk.h"
 #include "../common/classes/GenericMap.h"
@@ -67,6 +68,8 @@ namespace Replication
 
 namespace Firebird {
 	class TextType;
+	class Coordinator;
+	class Task;
 }
 
 class CharSetContainer;
@@ -682,6 +685,7 @@ public:
 	TrigVector*						att_ddl_triggers;
 	Firebird::Array<Function*>		att_functions;			// User defined functions
 	GeneratorFinder					att_generators;
+	GeneratorCache					att_generator_cache;	// values reserved by CACHE sequences
 
 	Firebird::Array<Statement*>	att_internal;			// internal statements
 	Firebird::Array<Statement*>	att_dyn_req;			// internal dyn statements
@@ -868,6 +872,9 @@ public:
 	bool isProfilerActive();
 	void releaseProfilerManager(thread_db* tdbb);
 
+	bool runSortTask(Firebird::Task* task);
+	void releaseSortCoordinator(thread_db* tdbb);
+
 	JProvider* getProvider() noexcept
 	{
 		fb_assert(att_provider);
@@ -893,6 +900,8 @@ private:
 	InitialOptions att_initial_options;	// Initial session options
 	DebugOptions att_debug_options;
 	Firebird::AutoPtr<ProfilerManager> att_profiler_manager;	// ProfilerManager
+	Firebird::AutoPtr<Firebird::Coordinator> att_sort_coordinator;	// Threads of parallel in-memory sorts
+	Firebird::Mutex att_sort_mutex;		// Serializes the use of att_sort_coordinator
 
 	Lock* att_repl_lock;				// Replication set lock
 	JProvider* att_provider;	// Provider which created this attachment
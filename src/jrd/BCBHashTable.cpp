@@ -0,0 +1,349 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		BCBHashTable.cpp
+ *	DESCRIPTION:	Hash table of page buffers of disk cache manager
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/BCBHashTable.h"
+#include "../common/classes/init.h"
+#include "../yvalve/gds_proto.h"
+
+#ifdef HASH_USE_CDS_LIST
+#include "../jrd/InitCDSLib.h"
+#endif
+
+using namespace Jrd;
+using namespace Firebird;
+
+// Given pointer a field in the block, find the block
+
+#define BLOCK(fld_ptr, type, fld) (type*)((SCHAR*) fld_ptr - offsetof(type, fld))
+
+
+namespace Jrd {
+
+/// class BCBHashTable::Slots
+
+BCBHashTable::Slots::Slots(MemoryPool& pool, ULONG count) :
+	m_count(count),
+	m_slots(FB_NEW_POOL(pool) Slot[count])
+{
+#ifndef HASH_USE_CDS_LIST
+	// Initialize all new chains
+	for (Slot* slot = m_slots; slot < m_slots + m_count; slot++)
+		QUE_INIT(slot->m_chain);
+#endif
+}
+
+BCBHashTable::Slots::~Slots()
+{
+#ifdef HASH_USE_CDS_LIST
+	for (Slot* slot = m_slots; slot < m_slots + m_count; slot++)
+		slot->m_chain.clear();
+#endif
+
+	delete[] m_slots;
+}
+
+
+/// class BCBHashTable
+
+void BCBHashTable::resize(ULONG count)
+{
+#ifdef HASH_USE_CDS_LIST
+	// Retired slots could be freed after the cache and its pool
+	MemoryPool& pool = *getDefaultMemoryPool();
+#else
+	MemoryPool& pool = m_pool;
+#endif
+
+	Slots* const old_slots = m_slots.load(std::memory_order_relaxed);
+	Slots* const new_slots = FB_NEW_POOL(pool) Slots(pool, count);
+
+	m_slots.store(new_slots, std::memory_order_release);
+
+	if (!old_slots)
+		return;
+
+	const Slot* const old_end = old_slots->m_slots + old_slots->m_count;
+
+	// Move any active buffers from old hash table to new
+	for (Slot* old_slot = old_slots->m_slots; old_slot < old_end; old_slot++)
+	{
+		chain_type* const old_tail = &old_slot->m_chain;
+		old_slot->m_hint.store(nullptr, std::memory_order_relaxed);
+
+#ifndef HASH_USE_CDS_LIST
+		while (QUE_NOT_EMPTY(*old_tail))
+		{
+			QUE que_inst = old_tail->que_forward;
+			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
+			QUE_DELETE(*que_inst);
+			QUE mod_que = &new_slots->get(bdb->bdb_page).m_chain;
+			QUE_INSERT(*mod_que, *que_inst);
+		}
+#else
+		while (!old_tail->empty())
+		{
+			auto n = old_tail->begin();
+			old_tail->erase(n->first);				// bdb_page
+
+			chain_type* new_chain = &new_slots->get(n->first).m_chain;
+			new_chain->insert(n->first, n->second);	// bdb_page, bdb
+		}
+#endif
+	}
+
+#ifdef HASH_USE_CDS_LIST
+	struct Disposer
+	{
+		void operator()(Slots* slots)
+		{
+			delete slots;
+		}
+	};
+
+	cds::gc::DHP::retire<Disposer>(old_slots);
+#else
+	delete old_slots;
+#endif
+}
+
+void BCBHashTable::clear()
+{
+	delete m_slots.exchange(nullptr);
+}
+
+BufferDesc* BCBHashTable::findChain(chain_type& list, const PageNumber& page)
+{
+#ifndef HASH_USE_CDS_LIST
+	QUE que_inst = list.que_forward;
+	for (; que_inst != &list; que_inst = que_inst->que_forward)
+	{
+		BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
+		if (bdb->bdb_page == page)
+			return bdb;
+	}
+
+#else // HASH_USE_CDS_LIST
+	auto ptr = list.get(page);
+	if (!ptr.empty())
+	{
+		fb_assert(ptr->second != nullptr);
+#ifdef DEV_BUILD
+		// Original libcds have no update(key, value), use this code with it,
+		// see also comment in get_buffer()
+		while (ptr->second == nullptr)
+			cds::backoff::pause();
+#endif
+		if (ptr->second->bdb_page == page)
+			return ptr->second;
+	}
+#endif
+
+	return nullptr;
+}
+
+BufferDesc* BCBHashTable::emplace(BufferDesc* bdb, const PageNumber& page, bool remove)
+{
+	SlotsGuard guard;
+	Slots* const slots = guard.protect(m_slots);
+	Slot& slot = slots->get(page);
+
+#ifndef HASH_USE_CDS_LIST
+	// bcb_syncObject should be locked in EX mode
+
+	BufferDesc* bdb2 = findChain(slot.m_chain, page);
+	if (!bdb2)
+	{
+		if (remove)
+		{
+			QUE_DELETE(bdb->bdb_que);
+			clearHint(slots->get(bdb->bdb_page), bdb);
+		}
+
+		QUE_INSERT(slot.m_chain, bdb->bdb_que);
+		bdb->bdb_hash_key.store(hashKey(page), std::memory_order_release);
+		slot.m_hint.store(bdb, std::memory_order_release);
+	}
+	return bdb2;
+#else // HASH_USE_CDS_LIST
+
+	BufferDesc* bdb2 = nullptr;
+	BdbList& list = slot.m_chain;
+
+/*
+	// Original libcds have no update(key, value), use this code with it
+
+	auto ret = list.update(page, [bdb, &bdb2](bool bNew, BdbList::value_type& val)
+		{
+			if (bNew)
+				val.second = bdb;
+			else
+				while (!(bdb2 = val.second))
+					cds::backoff::pause();
+		},
+		true);
+*/
+
+	auto ret = list.update(page, bdb, [&bdb2](bool bNew, BdbList::value_type& val)
+		{
+			// someone might have put a page buffer in the chain concurrently, so
+			// we store it for the further investigation
+			if (!bNew)
+				bdb2 = val.second;
+		},
+		true);
+	fb_assert(ret.first);
+
+	// if we have inserted the page buffer that we found (empty or oldest)
+	if (bdb2 == nullptr)
+	{
+		fb_assert(ret.second);
+#ifdef DEV_BUILD
+		auto p1 = list.get(page);
+		fb_assert(!p1.empty() && p1->first == page && p1->second == bdb);
+#endif
+
+		if (remove)
+		{
+			// remove the page buffer from old hash slot
+			const PageNumber oldPage = bdb->bdb_page;
+			Slot& oldSlot = slots->get(oldPage);
+			BdbList& oldList = oldSlot.m_chain;
+
+#ifdef DEV_BUILD
+			p1 = oldList.get(oldPage);
+			fb_assert(!p1.empty() && p1->first == oldPage && p1->second == bdb);
+#endif
+
+			const bool ok = oldList.erase(oldPage);
+			fb_assert(ok);
+
+			clearHint(oldSlot, bdb);
+
+#ifdef DEV_BUILD
+			p1 = oldList.get(oldPage);
+			fb_assert(p1.empty() || p1->second != bdb);
+#endif
+		}
+
+		bdb->bdb_hash_key.store(hashKey(page), std::memory_order_release);
+		slot.m_hint.store(bdb, std::memory_order_release);
+
+#ifdef DEV_BUILD
+		p1 = list.get(page);
+		fb_assert(!p1.empty() && p1->first == page && p1->second == bdb);
+#endif
+	}
+	return bdb2;
+#endif
+}
+
+
+void BCBHashTable::remove(BufferDesc* bdb)
+{
+	SlotsGuard guard;
+	Slot& slot = guard.protect(m_slots)->get(bdb->bdb_page);
+
+#ifndef HASH_USE_CDS_LIST
+	QUE_DELETE(bdb->bdb_que);
+#else
+	BdbList& list = slot.m_chain;
+
+#ifdef DEV_BUILD
+	auto p = list.get(bdb->bdb_page);
+	fb_assert(!p.empty() && p->first == bdb->bdb_page && p->second == bdb);
+#endif
+
+	list.erase(bdb->bdb_page);
+#endif
+
+	bdb->bdb_hash_key.store(~FB_UINT64(0), std::memory_order_release);
+	clearHint(slot, bdb);
+}
+
+
+} // namespace Jrd
+
+
+#ifdef HASH_USE_CDS_LIST
+
+///	 class ListNodeAllocator<T>
+
+class InitPool
+{
+public:
+	explicit InitPool(MemoryPool&)
+		: m_pool(InitCDS::createPool()),
+		  m_stats(m_pool->getStatsGroup())
+	{ }
+
+	~InitPool()
+	{
+		// m_pool will be deleted by InitCDS dtor after cds termination
+		// some memory could still be not freed until that moment
+
+#ifdef DEBUG_CDS_MEMORY
+		char str[256];
+		snprintf(str, sizeof(str),
+			"CCH list's common pool stats:\n"
+			"  usage         = %llu\n"
+			"  mapping       = %llu\n"
+			"  max usage     = %llu\n"
+			"  max mapping   = %llu\n"
+			"\n",
+			m_stats.getCurrentUsage(),
+			m_stats.getCurrentMapping(),
+			m_stats.getMaximumUsage(),
+			m_stats.getMaximumMapping()
+		);
+		gds__log(str);
+#endif
+	}
+
+	void* alloc(size_t size)
+	{
+		return m_pool->allocate(size ALLOC_ARGS);
+	}
+
+private:
+	MemoryPool* m_pool;
+	MemoryStats& m_stats;
+};
+
+static InitInstance<InitPool> initPool;
+
+
+template <typename T>
+T* Jrd::ListNodeAllocator<T>::allocate(std::size_t n)
+{
+	return static_cast<T*>(initPool().alloc(n * sizeof(T)));
+}
+
+template <typename T>
+void Jrd::ListNodeAllocator<T>::deallocate(T* p, std::size_t /* n */)
+{
+	// It uses the correct pool stored within memory block itself
+	MemoryPool::globalFree(p);
+}
+
+#endif // HASH_USE_CDS_LIST
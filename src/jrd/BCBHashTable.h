@@ -0,0 +1,199 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		BCBHashTable.h
+ *	DESCRIPTION:	Hash table of page buffers of disk cache manager
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_BCB_HASH_TABLE_H
+#define JRD_BCB_HASH_TABLE_H
+
+#include <atomic>
+#include "../jrd/cch.h"
+
+#ifndef CDS_UNAVAILABLE
+// Use lock-free lists in hash table implementation
+#define HASH_USE_CDS_LIST
+#endif
+
+#ifdef HASH_USE_CDS_LIST
+#include <cds/container/michael_kvlist_dhp.h>
+#endif
+
+namespace Jrd
+{
+
+#ifdef HASH_USE_CDS_LIST
+
+template <typename T>
+class ListNodeAllocator
+{
+public:
+	typedef T value_type;
+
+	ListNodeAllocator() {};
+
+	template <class U>
+	constexpr ListNodeAllocator(const ListNodeAllocator<U>&) noexcept {}
+
+	T* allocate(std::size_t n);
+	void deallocate(T* p, std::size_t n);
+
+private:
+};
+
+struct BdbTraits : public cds::container::michael_list::traits
+{
+	typedef ListNodeAllocator<int> allocator;
+	//typedef std::less<PageNumber> compare;
+};
+
+typedef cds::container::MichaelKVList<cds::gc::DHP, PageNumber, BufferDesc*, BdbTraits> BdbList;
+
+#endif // HASH_USE_CDS_LIST
+
+
+// Every hash slot has a hint - the page buffer last put into or found in the
+// slot. find() checks the hint first: it costs a couple of atomic loads and
+// doesn't walk the chain. The hint is compared against bdb_hash_key, the page
+// number the buffer was put into the table with, as bdb_page is changed
+// without any synchronization with readers. It is safe as page buffers are
+// never freed while the cache exists, and callers re-check bdb_page after the
+// buffer is latched anyway (see also PageToBufferMap).
+//
+// The slots array is replaced as a whole when table is resized. Lock-free
+// readers protect the array with a hazard pointer, the previous one is retired
+// and freed when no reader uses it anymore.
+
+class BCBHashTable
+{
+#ifdef HASH_USE_CDS_LIST
+	using chain_type = BdbList;
+#else
+	using chain_type = que;
+#endif
+
+	struct Slot
+	{
+		chain_type m_chain;
+		std::atomic<BufferDesc*> m_hint = nullptr;
+	};
+
+	struct Slots
+	{
+		Slots(MemoryPool& pool, ULONG count);
+		~Slots();
+
+		ULONG hash(const PageNumber& pageno) const
+		{
+			return pageno.getPageNum() % m_count;
+		}
+
+		Slot& get(const PageNumber& pageno)
+		{
+			return m_slots[hash(pageno)];
+		}
+
+		const ULONG m_count;
+		Slot* const m_slots;
+	};
+
+#ifdef HASH_USE_CDS_LIST
+	// Keeps the slots array from being freed by concurrent resize()
+	typedef cds::gc::DHP::Guard SlotsGuard;
+#else
+	// Slots array is replaced while bcb_syncObject is locked exclusively
+	struct SlotsGuard
+	{
+		Slots* protect(const std::atomic<Slots*>& slots)
+		{
+			return slots.load(std::memory_order_acquire);
+		}
+	};
+#endif
+
+public:
+	BCBHashTable(MemoryPool& pool, ULONG count) :
+		m_pool(pool),
+		m_slots(nullptr)
+	{
+		resize(count);
+	}
+
+	~BCBHashTable()
+	{
+		clear();
+	}
+
+	void resize(ULONG count);
+	void clear();
+
+	BufferDesc* find(const PageNumber& page) const
+	{
+		SlotsGuard guard;
+		Slot& slot = guard.protect(m_slots)->get(page);
+
+		BufferDesc* hint = slot.m_hint.load(std::memory_order_acquire);
+		if (hint && hint->bdb_hash_key.load(std::memory_order_acquire) == hashKey(page))
+			return hint;
+
+		BufferDesc* const bdb = findChain(slot.m_chain, page);
+
+		// Buffer could be removed after we found it in the chain, then remove()
+		// had nothing to clear yet. Make sure it's still there after the hint is set.
+		if (bdb && slot.m_hint.compare_exchange_strong(hint, bdb))
+		{
+			BufferDesc* const current = findChain(slot.m_chain, page);
+			if (current != bdb)
+			{
+				clearHint(slot, bdb);
+				return current;
+			}
+		}
+
+		return bdb;
+	}
+
+	// tries to put bdb into hash slot by page
+	// if succeed, removes bdb from old slot, if necessary, and returns NULL
+	// else, returns BufferDesc that is currently occupies target slot
+	BufferDesc* emplace(BufferDesc* bdb, const PageNumber& page, bool remove);
+
+	void remove(BufferDesc* bdb);
+
+private:
+	static BufferDesc* findChain(chain_type& chain, const PageNumber& page);
+
+	static FB_UINT64 hashKey(const PageNumber& page)
+	{
+		return ((FB_UINT64) page.getPageSpaceID() << 32) | page.getPageNum();
+	}
+
+	static void clearHint(Slot& slot, BufferDesc* bdb)
+	{
+		slot.m_hint.compare_exchange_strong(bdb, nullptr);
+	}
+
+	MemoryPool& m_pool;
+	std::atomic<Slots*> m_slots;
+};
+
+} // namespace Jrd
+
+#endif // JRD_BCB_HASH_TABLE_H
@@ -41,6 +41,7 @@
 #include "../jrd/pag.h"
 #include "../jrd/nbak.h"
 #include "../jrd/cch_proto.h"
+#include "../jrd/err_proto.h"
 #include "../jrd/lck_proto.h"
 #include "../jrd/pag_proto.h"
 #include "firebird/impl/inf_pub.h"
@@ -50,6 +51,7 @@
 #include "../common/classes/auto.h"
 #include "../common/classes/RefMutex.h"
 #include "../common/classes/ClumpletWriter.h"
+#include "../common/classes/Lz4.h"
 #include "../common/sha.h"
 
 using namespace Firebird;
@@ -70,6 +72,52 @@ namespace
 	const UCHAR CRYPT_INIT = LCK_EX;
 
 	constexpr int MAX_PLUGIN_NAME_LEN = sizeof(Ods::header_page::hdr_crypt_plugin) - 1;
+
+	// See Ods::compressed_page for the layout of compressed pages
+
+	bool compressPage(ULONG pageSize, const Ods::pag* page, Ods::pag* to)
+	{
+		if (page->pag_type != pag_data && page->pag_type != pag_blob)
+			return false;
+
+		// Compression makes sense only if the page releases at least one block
+		if (pageSize <= Ods::COMPRESSED_PAGE_BLOCK)
+			return false;
+
+		const ULONG length = pageSize - sizeof(Ods::pag);
+		const auto output = reinterpret_cast<UCHAR*>(&to[1]);
+
+		const ULONG compressedLength = Lz4::compress(reinterpret_cast<const UCHAR*>(&page[1]), length,
+			output, pageSize - Ods::COMPRESSED_PAGE_BLOCK - sizeof(Ods::pag));
+
+		if (!compressedLength)
+			return false;
+
+		to[0] = page[0];
+		to->pag_flags |= Ods::compressed_page;
+		to->pag_reserved = (USHORT) compressedLength;
+		memset(output + compressedLength, 0, length - compressedLength);
+
+		return true;
+	}
+
+	bool decompressPage(ULONG pageSize, const Ods::pag* page, Ods::pag* to)
+	{
+		const ULONG length = pageSize - sizeof(Ods::pag);
+
+		if (page->pag_reserved > length ||
+			!Lz4::decompress(reinterpret_cast<const UCHAR*>(&page[1]), page->pag_reserved,
+				reinterpret_cast<UCHAR*>(&to[1]), length))
+		{
+			return false;
+		}
+
+		to[0] = page[0];
+		to->pag_flags &= ~Ods::compressed_page;
+		to->pag_reserved = 0;
+
+		return true;
+	}
 }
 
 
@@ -1270,6 +1318,14 @@ namespace Jrd
 				return FAILED_CRYPT;
 			}
 		}
+		else if (page->pag_flags & Ods::compressed_page)
+		{
+			Buffer to;
+			if (!decompressPage(dbb.dbb_page_size, page, to))
+				BUGCHECK(179);	// msg 179 decompression overran buffer
+
+			memcpy(page, to, dbb.dbb_page_size);
+		}
 
 		return SUCCESS_ALL;
 	}
@@ -1367,6 +1423,10 @@ namespace Jrd
 		else
 		{
 			page->pag_flags &= ~Ods::crypted_page;
+
+			if ((dbb.dbb_flags & DBB_compressed_pages) && dbb.dbb_config->getPageCompression() &&
+				compressPage(dbb.dbb_page_size, page, to))
+				dest = to;
 		}
 
 		if (!io->callback(tdbb, sv, dest))
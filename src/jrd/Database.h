@@ -231,6 +231,7 @@ inline constexpr ULONG DBB_sweep_starting			= 0x40000L;		// Auto-sweep is starti
 inline constexpr ULONG DBB_creating					= 0x80000L;		// Database creation is in progress
 inline constexpr ULONG DBB_shared					= 0x100000L;	// Database object is shared among connections
 inline constexpr ULONG DBB_restoring				= 0x200000L;	// Database restore is in progress
+inline constexpr ULONG DBB_compressed_pages			= 0x400000L;	// Header allows compressed pages on disk
 
 //
 // dbb_ast_flags
@@ -0,0 +1,154 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		GeneratorCache.cpp
+ *	DESCRIPTION:	Generator values cached by attachment
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/GeneratorCache.h"
+#include "../jrd/jrd.h"
+#include "../jrd/lck.h"
+#include "../jrd/tra.h"
+#include "../jrd/dpm_proto.h"
+#include "../jrd/lck_proto.h"
+
+using namespace Jrd;
+using namespace Firebird;
+
+
+GeneratorCache::~GeneratorCache()
+{
+	for (auto& item : m_entries)
+	{
+		delete item.second->lock;
+		delete item.second;
+	}
+}
+
+
+SINT64 GeneratorCache::next(thread_db* tdbb, SLONG id, const QualifiedName& name, SLONG step, SLONG cacheSize)
+{
+	// Generator created by the current transaction keeps its value in the transaction
+	jrd_tra* const transaction = tdbb->getTransaction();
+	SINT64 value;
+
+	if (transaction && transaction->tra_gen_ids && transaction->tra_gen_ids->get(id, value))
+		return DPM_gen_id(tdbb, id, false, step);
+
+	Entry* entry = nullptr;
+
+	if (!m_entries.get(id, entry))
+	{
+		MemoryPool& pool = m_entries.getPool();
+
+		entry = FB_NEW_POOL(pool) Entry(pool, name);
+		entry->lock = FB_NEW_RPT(pool, 0) Lock(tdbb, sizeof(SLONG), LCK_gen_cache, entry, blockingAst);
+		entry->lock->setKey(id);
+
+		m_entries.put(id, entry);
+	}
+	else if (entry->remaining && entry->step == step)
+	{
+		entry->remaining--;
+		entry->value += step;
+		return entry->value;
+	}
+
+	entry->name = name;
+	entry->step = step;
+	entry->cacheSize = cacheSize;
+	entry->remaining = 0;
+
+	if (entry->lock->lck_logical == LCK_none)
+		LCK_lock(tdbb, entry->lock, LCK_SR, LCK_WAIT);
+
+	const SINT64 last = DPM_gen_id(tdbb, id, false, (SINT64) step * cacheSize);
+	value = last - (SINT64) step * (cacheSize - 1);
+
+	// Don't keep the rest if the generator was set while we were reserving the values
+	if (entry->lock->lck_logical != LCK_none)
+	{
+		entry->value = value;
+		entry->remaining = cacheSize - 1;
+	}
+
+	return value;
+}
+
+
+void GeneratorCache::reset(thread_db* tdbb, SLONG id)
+{
+	Attachment* const attachment = tdbb->getAttachment();
+
+	if (!attachment)
+		return;
+
+	// Own values go first, so our lock doesn't conflict with the exclusive one
+
+	Entry* entry = nullptr;
+
+	if (attachment->att_generator_cache.m_entries.get(id, entry))
+	{
+		entry->remaining = 0;
+
+		if (entry->lock->lck_logical != LCK_none)
+			LCK_release(tdbb, entry->lock);
+	}
+
+	// Signal other attachments to forget their values
+
+	Lock temp(tdbb, sizeof(SLONG), LCK_gen_cache);
+	temp.setKey(id);
+
+	if (LCK_lock(tdbb, &temp, LCK_EX, LCK_WAIT))
+		LCK_release(tdbb, &temp);
+}
+
+
+void GeneratorCache::releaseLocks(thread_db* tdbb)
+{
+	for (auto& item : m_entries)
+	{
+		Entry* const entry = item.second;
+		entry->remaining = 0;
+
+		if (entry->lock->lck_logical != LCK_none)
+			LCK_release(tdbb, entry->lock);
+	}
+}
+
+
+int GeneratorCache::blockingAst(void* astObject)
+{
+	Entry* const entry = static_cast<Entry*>(astObject);
+
+	try
+	{
+		Database* const dbb = entry->lock->lck_dbb;
+		AsyncContextHolder tdbb(dbb, FB_FUNCTION, entry->lock);
+
+		entry->remaining = 0;
+		LCK_release(tdbb, entry->lock);
+	}
+	catch (const Exception&)
+	{} // no-op
+
+	return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		GeneratorCache.h
+ *	DESCRIPTION:	Generator values cached by attachment
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_GENERATOR_CACHE_H
+#define JRD_GENERATOR_CACHE_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/GenericMap.h"
+#include "../jrd/QualifiedName.h"
+
+namespace Jrd
+{
+
+class thread_db;
+class Lock;
+
+// Every NEXT VALUE FOR modifies the generator page, so it becomes a hot spot under high
+// insert rates. For sequences created with CACHE n, attachment reserves n values with
+// a single page update and hands them out from memory. Values not used before the
+// attachment is gone are lost.
+//
+// Attachment caching the generator values holds a shared lock of the generator. Setting
+// the generator (ALTER SEQUENCE RESTART, SET GENERATOR, etc.) takes the lock exclusively,
+// thus other attachments forget the values they reserved before.
+
+class GeneratorCache
+{
+public:
+	class Entry
+	{
+	public:
+		Entry(MemoryPool& pool, const QualifiedName& aName)
+			: name(pool, aName)
+		{}
+
+		QualifiedName name;
+		SINT64 value = 0;		// last value returned
+		SLONG step = 0;
+		SLONG cacheSize = 0;
+		SLONG remaining = 0;	// values reserved but not returned yet
+		Lock* lock = nullptr;
+	};
+
+	typedef Firebird::NonPooledMap<SLONG, Entry*> Entries;
+
+	explicit GeneratorCache(MemoryPool& pool)
+		: m_entries(pool)
+	{}
+
+	~GeneratorCache();
+
+	// Returns next value of the generator, reserves cacheSize values when cached ones are used
+	SINT64 next(thread_db* tdbb, SLONG id, const QualifiedName& name, SLONG step, SLONG cacheSize);
+
+	// Makes all attachments forget the cached values after the generator is set
+	static void reset(thread_db* tdbb, SLONG id);
+
+	void releaseLocks(thread_db* tdbb);
+
+	const Entries& getEntries() const
+	{
+		return m_entries;
+	}
+
+private:
+	static int blockingAst(void* astObject);
+
+	Entries m_entries;
+};
+
+} // namespace Jrd
+
+#endif // JRD_GENERATOR_CACHE_H
@@ -0,0 +1,104 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		HashSpillFile.cpp
+ *	DESCRIPTION:	Partitioned temporary storage of hash join entries
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/HashSpillFile.h"
+
+using namespace Jrd;
+using namespace Firebird;
+
+
+static const char* const SCRATCH = "fb_hash_";
+
+
+HashSpillFile::HashSpillFile(MemoryPool& pool, ULONG streamCount, ULONG partitionCount)
+	: PermanentStorage(pool), m_space(pool, SCRATCH),
+	  m_partitions(pool), m_partitionCount(partitionCount), m_shift(32),
+	  m_reader(nullptr), m_readEntries(nullptr), m_readChunk(0), m_readCount(0), m_readPos(0)
+{
+	fb_assert(partitionCount >= 2 && partitionCount <= MAX_PARTITIONS);
+	fb_assert(!(partitionCount & (partitionCount - 1)));
+
+	for (ULONG count = partitionCount; count > 1; count >>= 1)
+		m_shift--;
+
+	for (ULONG i = 0; i < streamCount * partitionCount; i++)
+		m_partitions.add();
+}
+
+void HashSpillFile::put(ULONG stream, ULONG hash, ULONG position)
+{
+	Partition& partition = m_partitions[stream * m_partitionCount + getPartition(hash)];
+
+	if (partition.count == CHUNK_SIZE)
+	{
+		const offset_t offset = m_space.getSize();
+		m_space.write(offset, partition.entries, sizeof(partition.entries));
+		partition.chunks.add(offset);
+		partition.count = 0;
+	}
+
+	Entry& entry = partition.entries[partition.count++];
+	entry.hash = hash;
+	entry.position = position;
+}
+
+void HashSpillFile::open(ULONG stream, ULONG partition)
+{
+	fb_assert(partition < m_partitionCount);
+
+	m_reader = &m_partitions[stream * m_partitionCount + partition];
+	m_readEntries = nullptr;
+	m_readChunk = 0;
+	m_readCount = m_readPos = 0;
+}
+
+bool HashSpillFile::next(ULONG& hash, ULONG& position)
+{
+	fb_assert(m_reader);
+
+	while (m_readPos >= m_readCount)
+	{
+		if (m_readChunk < m_reader->chunks.getCount())
+		{
+			m_space.read(m_reader->chunks[m_readChunk++], m_readBuffer, sizeof(m_readBuffer));
+			m_readEntries = m_readBuffer;
+			m_readCount = CHUNK_SIZE;
+		}
+		else if (m_readEntries != m_reader->entries)
+		{
+			// Flushed chunks are exhausted, switch to the pending entries
+			m_readEntries = m_reader->entries;
+			m_readCount = m_reader->count;
+		}
+		else
+			return false;
+
+		m_readPos = 0;
+	}
+
+	const Entry& entry = m_readEntries[m_readPos++];
+	hash = entry.hash;
+	position = entry.position;
+	return true;
+}
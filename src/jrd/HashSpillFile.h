@@ -0,0 +1,105 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		HashSpillFile.h
+ *	DESCRIPTION:	Partitioned temporary storage of hash join entries
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_HASH_SPILL_FILE_H
+#define JRD_HASH_SPILL_FILE_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/objects_array.h"
+#include "../jrd/TempSpace.h"
+
+namespace Jrd
+{
+
+// Hash join entries (hash value and record position) of several streams, partitioned
+// by the hash value. Entries are accumulated in per-partition chunks, the filled chunks
+// are flushed into the temporary space. Entries of every stream and partition are read
+// back in the order they were put.
+
+class HashSpillFile final : public Firebird::PermanentStorage
+{
+	static constexpr ULONG CHUNK_SIZE = 512;	// 4KB per chunk
+
+	struct Entry
+	{
+		ULONG hash;
+		ULONG position;
+	};
+
+	struct Partition
+	{
+		explicit Partition(MemoryPool& pool)
+			: chunks(pool), count(0)
+		{}
+
+		Firebird::Array<offset_t> chunks;	// offsets of the flushed chunks
+		Entry entries[CHUNK_SIZE];			// pending (not flushed yet) entries
+		ULONG count;
+	};
+
+public:
+	static constexpr ULONG MAX_PARTITIONS = 256;
+
+	// Partition count must be a power of two
+	HashSpillFile(MemoryPool& pool, ULONG streamCount, ULONG partitionCount);
+
+	ULONG getPartitionCount() const noexcept
+	{
+		return m_partitionCount;
+	}
+
+	FB_UINT64 getSize() const noexcept
+	{
+		return m_space.getSize();
+	}
+
+	void put(ULONG stream, ULONG hash, ULONG position);
+
+	void open(ULONG stream, ULONG partition);
+	bool next(ULONG& hash, ULONG& position);
+
+private:
+	ULONG getPartition(ULONG hash) const noexcept
+	{
+		// Use the upper bits of the multiplicative hash, thus making the partition number
+		// independent from the hash table slot (which is calculated as modulo of the hash)
+		return (ULONG) ((hash * 2654435769U) >> m_shift);
+	}
+
+	TempSpace m_space;
+	Firebird::ObjectsArray<Partition> m_partitions;
+	const ULONG m_partitionCount;
+	ULONG m_shift;
+
+	const Partition* m_reader;
+	const Entry* m_readEntries;
+	FB_SIZE_T m_readChunk;
+	ULONG m_readCount;
+	ULONG m_readPos;
+	Entry m_readBuffer[CHUNK_SIZE];
+};
+
+} // namespace Jrd
+
+#endif // JRD_HASH_SPILL_FILE_H
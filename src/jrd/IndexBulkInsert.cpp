@@ -0,0 +1,297 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		IndexBulkInsert.cpp
+ *	DESCRIPTION:	Deferred insertion of index keys for large loads
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/IndexBulkInsert.h"
+#include "../jrd/jrd.h"
+#include "../jrd/btr.h"
+#include "../jrd/cch.h"
+#include "../jrd/sort.h"
+#include "../jrd/tra.h"
+#include "../jrd/Relation.h"
+#include "../jrd/btr_proto.h"
+#include "../jrd/cch_proto.h"
+
+using namespace Jrd;
+using namespace Ods;
+using namespace Firebird;
+
+
+IndexBulkInsert::~IndexBulkInsert()
+{
+	clear();
+}
+
+
+IndexBulkInsert* IndexBulkInsert::start(thread_db* tdbb, jrd_tra* transaction, jrd_rel* relation)
+{
+	const int threshold = tdbb->getDatabase()->dbb_config->getIndexBulkInsertThreshold();
+
+	// Temporary tables keep their pages per attachment or transaction, don't bother with them
+	if (threshold <= 0 || !transaction || (transaction->tra_flags & TRA_system) ||
+		relation->isSystem() || relation->isTemporary())
+	{
+		return nullptr;
+	}
+
+	IndexBulkInsert* bulkInsert = transaction->tra_bulk_insert;
+
+	if (!bulkInsert)
+	{
+		bulkInsert = FB_NEW_POOL(*transaction->tra_pool)
+			IndexBulkInsert(*transaction->tra_pool, transaction);
+		transaction->tra_bulk_insert = bulkInsert;
+	}
+
+	RelationKeys* relKeys = bulkInsert->find(relation);
+
+	if (!relKeys)
+	{
+		relKeys = &bulkInsert->m_relations.add();
+		relKeys->relation = relation;
+	}
+
+	return (++relKeys->stored > (FB_UINT64) threshold) ? bulkInsert : nullptr;
+}
+
+
+bool IndexBulkInsert::add(thread_db* tdbb, jrd_rel* relation, index_desc* idx,
+	const temporary_key* key, RecordNumber number)
+{
+	if (idx->idx_flags & (idx_unique | idx_primary | idx_foreign))
+		return false;
+
+	RelationKeys* const relKeys = find(relation);
+	fb_assert(relKeys);
+
+	IndexKeys* keys = nullptr;
+
+	for (auto& item : relKeys->indices)
+	{
+		if (item.id == idx->idx_id)
+		{
+			keys = &item;
+			break;
+		}
+	}
+
+	if (!keys)
+	{
+		keys = &relKeys->indices.add();
+		keys->id = idx->idx_id;
+		keys->root = 0;
+		keys->sort = nullptr;
+	}
+
+	if (keys->root != idx->idx_root)
+	{
+		// Index was recreated, it contains all the records already
+		delete keys->sort;
+		keys->sort = nullptr;
+
+		keys->root = idx->idx_root;
+		keys->keyLength = ROUNDUP(BTR_key_length(tdbb, relation, idx), sizeof(SINT64));
+	}
+
+	if (key->key_length > keys->keyLength)
+		return false;
+
+	if (!keys->sort)
+	{
+		// Keys are sorted just to touch leaf pages in order, so the exact
+		// ordering of NULLs and keys of descending indices doesn't matter
+
+		sort_key_def keyDesc[2];
+		keyDesc[0].setSkdLength(SKD_bytes, keys->keyLength);
+		keyDesc[0].skd_flags = SKD_ascending;
+		keyDesc[0].setSkdOffset();
+		keyDesc[0].skd_vary_offset = 0;
+		keyDesc[1].setSkdLength(SKD_int64, sizeof(RecordNumber));
+		keyDesc[1].skd_flags = SKD_ascending;
+		keyDesc[1].setSkdOffset(keyDesc);
+		keyDesc[1].skd_vary_offset = 0;
+
+		keys->sort = FB_NEW_POOL(m_transaction->tra_sorts.getPool())
+			Sort(tdbb->getDatabase(), &m_transaction->tra_sorts,
+				 keys->keyLength + sizeof(index_sort_record), 2, 2, keyDesc, NULL, NULL);
+	}
+
+	UCHAR* record;
+	keys->sort->put(tdbb, reinterpret_cast<ULONG**>(&record));
+
+	memcpy(record, key->key_data, key->key_length);
+	memset(record + key->key_length, 0, keys->keyLength - key->key_length);
+
+	index_sort_record* const isr = (index_sort_record*) (record + keys->keyLength);
+	isr->isr_record_number = number.getValue();
+	isr->isr_key_length = key->key_length;
+	isr->isr_flags = 0;
+
+	return true;
+}
+
+
+void IndexBulkInsert::flush(thread_db* tdbb, jrd_rel* relation, USHORT id)
+{
+	jrd_tra* const transaction = tdbb->getTransaction();
+
+	if (transaction && transaction->tra_bulk_insert)
+	{
+		IndexBulkInsert* const bulkInsert = transaction->tra_bulk_insert;
+
+		if (RelationKeys* const relKeys = bulkInsert->find(relation))
+			bulkInsert->flush(tdbb, relKeys, id);
+	}
+}
+
+
+void IndexBulkInsert::flush(thread_db* tdbb, jrd_rel* relation)
+{
+	flush(tdbb, relation, idx_invalid);
+}
+
+
+void IndexBulkInsert::flush(thread_db* tdbb)
+{
+	for (auto& relKeys : m_relations)
+		flush(tdbb, &relKeys, idx_invalid);
+}
+
+
+void IndexBulkInsert::clear()
+{
+	for (auto& relKeys : m_relations)
+	{
+		for (auto& keys : relKeys.indices)
+			delete keys.sort;
+	}
+
+	m_relations.clear();
+}
+
+
+IndexBulkInsert::RelationKeys* IndexBulkInsert::find(const jrd_rel* relation)
+{
+	for (auto& relKeys : m_relations)
+	{
+		if (relKeys.relation == relation)
+			return &relKeys;
+	}
+
+	return nullptr;
+}
+
+
+void IndexBulkInsert::flush(thread_db* tdbb, RelationKeys* relKeys, USHORT id)
+{
+	try
+	{
+		for (auto& keys : relKeys->indices)
+		{
+			if (keys.sort && (id == idx_invalid || keys.id == id))
+				flushIndex(tdbb, relKeys->relation, keys);
+		}
+	}
+	catch (const Exception&)
+	{
+		// Keys not inserted are lost, so records stored by the
+		// transaction are missing in the index and can't be committed
+		m_transaction->tra_flags |= TRA_invalidated;
+		throw;
+	}
+}
+
+
+void IndexBulkInsert::flushIndex(thread_db* tdbb, jrd_rel* relation, IndexKeys& keys)
+{
+	AutoPtr<Sort> sort(keys.sort);
+	keys.sort = nullptr;
+
+	if (relation->rel_flags & (REL_deleted | REL_deleting))
+		return;
+
+	sort->sort(tdbb);
+
+	// Make sure the index is still the one keys were collected for
+
+	index_desc idx;
+	idx.idx_id = idx_invalid;
+
+	WIN window(relation->getPages(tdbb)->rel_pg_space_id, -1);
+	bool found = false;
+
+	while (BTR_next_index(tdbb, relation, m_transaction, &idx, &window))
+	{
+		if (idx.idx_id == keys.id)
+		{
+			found = (idx.idx_root == keys.root);
+			break;
+		}
+	}
+
+	if (!found)
+	{
+		if (window.win_bdb)
+			CCH_RELEASE(tdbb, &window);
+
+		return;
+	}
+
+	temporary_key key;
+	key.key_flags = 0;
+	key.key_nulls = 0;
+
+	index_insertion insertion;
+	insertion.iib_descriptor = &idx;
+	insertion.iib_relation = relation;
+	insertion.iib_key = &key;
+	insertion.iib_transaction = m_transaction;
+	insertion.iib_btr_level = 0;
+
+	BtrSortedInsert sortedInsert(tdbb);
+
+	UCHAR* record;
+	sort->get(tdbb, reinterpret_cast<ULONG**>(&record));
+
+	while (record)
+	{
+		const index_sort_record* const isr = (index_sort_record*) (record + keys.keyLength);
+
+		key.key_length = isr->isr_key_length;
+		memcpy(key.key_data, record, key.key_length);
+
+		insertion.iib_number.setValue(isr->isr_record_number);
+		insertion.iib_duplicates = NULL;
+
+		// Insertion releases the index root page
+		if (!window.win_bdb)
+			CCH_FETCH(tdbb, &window, LCK_read, pag_root);
+
+		sortedInsert.insert(tdbb, &window, &insertion);
+
+		sort->get(tdbb, reinterpret_cast<ULONG**>(&record));
+	}
+
+	if (window.win_bdb)
+		CCH_RELEASE(tdbb, &window);
+}
@@ -0,0 +1,115 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		IndexBulkInsert.h
+ *	DESCRIPTION:	Deferred insertion of index keys for large loads
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_INDEX_BULK_INSERT_H
+#define JRD_INDEX_BULK_INSERT_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/objects_array.h"
+#include "../jrd/RecordNumber.h"
+
+namespace Jrd
+{
+
+class jrd_rel;
+class jrd_tra;
+class thread_db;
+class Sort;
+struct index_desc;
+struct temporary_key;
+
+// Large loads (INSERT ... SELECT, batches) into a table insert every key into every index
+// of the table, so leaf pages are read and written in random order. When a transaction has
+// stored many records into a table, keys of its non-unique indices are collected and sorted
+// instead, and inserted later in index order, thus every leaf page is modified once per
+// many keys. Every key is inserted into the leaf page the previous one went into, so keys
+// beyond the index maximum are appended to the rightmost leaf, and the tree is descended
+// from the root only when the leaf page is full.
+//
+// Keys not inserted yet can't be found in the index, so the transaction inserts them before
+// it reads the index, before it garbage collects keys of the table and at commit. Other
+// transactions don't see the new records anyway. Unique indices are never deferred as their
+// duplicates must be detected at once. Foreign key indices are never deferred either, as
+// transactions deleting or modifying the master record look there for the detail records.
+
+class IndexBulkInsert
+{
+public:
+	IndexBulkInsert(MemoryPool& pool, jrd_tra* transaction)
+		: m_transaction(transaction), m_relations(pool)
+	{}
+
+	~IndexBulkInsert();
+
+	// Counts the record stored into the relation, returns not NULL
+	// when keys of the record should be collected
+	static IndexBulkInsert* start(thread_db* tdbb, jrd_tra* transaction, jrd_rel* relation);
+
+	// Returns false if the key can't be deferred and must be inserted now
+	bool add(thread_db* tdbb, jrd_rel* relation, index_desc* idx,
+		const temporary_key* key, RecordNumber number);
+
+	// Insert keys collected by the current transaction for the index,
+	// or for all indices of the relation
+	static void flush(thread_db* tdbb, jrd_rel* relation, USHORT id);
+	static void flush(thread_db* tdbb, jrd_rel* relation);
+
+	// Insert all collected keys
+	void flush(thread_db* tdbb);
+
+	// Forget collected keys as their records are going away
+	void clear();
+
+private:
+	struct IndexKeys
+	{
+		USHORT id;
+		ULONG root;
+		USHORT keyLength;	// key part of the sort record
+		Sort* sort;
+	};
+
+	class RelationKeys
+	{
+	public:
+		explicit RelationKeys(MemoryPool& pool)
+			: indices(pool)
+		{}
+
+		jrd_rel* relation = nullptr;
+		FB_UINT64 stored = 0;	// records stored by transaction
+		Firebird::HalfStaticArray<IndexKeys, 4> indices;
+	};
+
+	RelationKeys* find(const jrd_rel* relation);
+	void flush(thread_db* tdbb, RelationKeys* relKeys, USHORT id);
+	void flushIndex(thread_db* tdbb, jrd_rel* relation, IndexKeys& keys);
+
+	jrd_tra* const m_transaction;
+	Firebird::ObjectsArray<RelationKeys> m_relations;
+};
+
+} // namespace Jrd
+
+#endif // JRD_INDEX_BULK_INSERT_H
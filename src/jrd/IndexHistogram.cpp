@@ -0,0 +1,341 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		IndexHistogram.cpp
+ *	DESCRIPTION:	Distribution of index keys for the optimizer
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/IndexHistogram.h"
+#include "../jrd/ods.h"
+#include "../common/classes/ClumpletWriter.h"
+#include <algorithm>
+
+using namespace Jrd;
+using namespace Firebird;
+
+
+namespace
+{
+	// Version of the stored histogram, used as the clumplet buffer tag
+	const UCHAR HISTOGRAM_VERSION1 = 1;
+
+	enum HistogramTag : UCHAR
+	{
+		tag_count = 1,
+		tag_distinct,
+		tag_step,
+		tag_bound,
+		tag_value,
+		tag_value_count,
+		tag_key_type
+	};
+}
+
+
+// Compound keys consist of groups of STUFF_COUNT bytes prefixed with
+// the segment marker. The first segment has the largest marker number.
+
+USHORT IndexHistogram::getLeadingLength(const UCHAR* key, USHORT length, USHORT segments, bool descending)
+{
+	if (segments == 1)
+		return length;
+
+	const UCHAR marker = descending ? 255 - segments : segments;
+
+	USHORT pos = 0;
+	while (pos < length && key[pos] == marker)
+		pos += Ods::STUFF_COUNT + 1;
+
+	return MIN(pos, length);
+}
+
+void IndexHistogram::add(const UCHAR* key, USHORT length)
+{
+	Key current;
+	current.assign(key, length);
+
+	if (m_count && !current.compare(m_last))
+		m_run++;
+	else
+	{
+		if (m_count)
+			addValue(m_last, m_run);
+
+		m_last = current;
+		m_run = 1;
+		m_distinct++;
+	}
+
+	if (++m_count % m_step)
+		return;
+
+	m_bounds.add(current);
+
+	// When there are too many buckets, merge every pair of the adjacent ones
+
+	if (m_bounds.getCount() == 2 * MAX_BUCKETS)
+	{
+		for (unsigned i = 0; i < MAX_BUCKETS; i++)
+			m_bounds[i] = m_bounds[2 * i + 1];
+
+		m_bounds.shrink(MAX_BUCKETS);
+		m_step *= 2;
+	}
+}
+
+void IndexHistogram::finish()
+{
+	if (m_run)
+	{
+		addValue(m_last, m_run);
+		m_run = 0;
+	}
+
+	// Values that are not more common than the average one don't deserve to be remembered
+
+	for (FB_SIZE_T i = 0; i < m_values.getCount(); )
+	{
+		if (m_values[i].count * m_distinct <= m_count)
+			m_values.remove(i);
+		else
+			i++;
+	}
+}
+
+void IndexHistogram::addSample(FB_SIZE_T position, const UCHAR* key, USHORT length)
+{
+	Key sample;
+	sample.assign(key, length);
+
+	if (position < m_samples.getCount())
+		m_samples[position] = sample;
+	else
+		m_samples.add(sample);
+}
+
+void IndexHistogram::finishSample(FB_UINT64 totalCount)
+{
+	std::sort(m_samples.begin(), m_samples.end(),
+		[](const Key& key1, const Key& key2) { return key1.compare(key2) < 0; });
+
+	for (const auto& sample : m_samples)
+		add(sample.data, sample.length);
+
+	m_samples.free();
+	finish();
+
+	// Keys met only once in the sample are likely to have unseen companions,
+	// so scale the number of distinct keys (Haas-Stokes estimator)
+
+	if (m_count && totalCount > m_count)
+	{
+		const double sampled = (double) m_count;
+		const double total = (double) totalCount;
+		const double singles = (double) m_singles;
+
+		const double distinct = sampled * m_distinct / (sampled - singles + singles * sampled / total);
+		m_distinct = (FB_UINT64) MIN(MAX(distinct, (double) m_distinct), total);
+	}
+}
+
+void IndexHistogram::addValue(const Key& key, FB_UINT64 count)
+{
+	if (count == 1)
+	{
+		m_singles++;
+		return;
+	}
+
+	if (m_values.getCount() < MAX_VALUES)
+	{
+		m_values.add({key, count});
+		return;
+	}
+
+	Value* least = m_values.begin();
+	for (auto& value : m_values)
+	{
+		if (value.count < least->count)
+			least = &value;
+	}
+
+	if (count > least->count)
+		*least = {key, count};
+}
+
+void IndexHistogram::store(UCharBuffer& buffer) const
+{
+	ClumpletWriter writer(ClumpletReader::Tagged, MAX_ULONG, HISTOGRAM_VERSION1);
+
+	writer.insertBigInt(tag_count, m_count);
+	writer.insertBigInt(tag_distinct, m_distinct);
+	writer.insertBigInt(tag_step, m_step);
+
+	if (m_keyType != UNKNOWN_KEY_TYPE)
+		writer.insertInt(tag_key_type, m_keyType);
+
+	for (const auto& bound : m_bounds)
+		writer.insertBytes(tag_bound, bound.data, bound.length);
+
+	for (const auto& value : m_values)
+	{
+		writer.insertBytes(tag_value, value.key.data, value.key.length);
+		writer.insertBigInt(tag_value_count, value.count);
+	}
+
+	buffer.assign(writer.getBuffer(), writer.getBufferLength());
+}
+
+bool IndexHistogram::parse(const UCHAR* buffer, ULONG length)
+{
+	m_bounds.clear();
+	m_values.clear();
+	m_count = m_distinct = 0;
+	m_step = 1;
+	m_keyType = UNKNOWN_KEY_TYPE;
+
+	ClumpletReader reader(ClumpletReader::Tagged, buffer, length);
+
+	if (reader.getBufferTag() != HISTOGRAM_VERSION1)
+		return false;
+
+	for (reader.rewind(); !reader.isEof(); reader.moveNext())
+	{
+		Key key;
+
+		switch (reader.getClumpTag())
+		{
+			case tag_count:
+				m_count = reader.getBigInt();
+				break;
+
+			case tag_distinct:
+				m_distinct = reader.getBigInt();
+				break;
+
+			case tag_step:
+				m_step = reader.getBigInt();
+				break;
+
+			case tag_bound:
+				key.assign(reader.getBytes(), reader.getClumpLength());
+				m_bounds.add(key);
+				break;
+
+			case tag_value:
+				key.assign(reader.getBytes(), reader.getClumpLength());
+				m_values.add({key, 0});
+				break;
+
+			case tag_value_count:
+				if (m_values.hasData())
+					m_values.back().count = reader.getBigInt();
+				break;
+
+			case tag_key_type:
+				m_keyType = (USHORT) reader.getInt();
+				break;
+		}
+	}
+
+	if (!m_count || !m_distinct || !m_step)
+	{
+		m_count = 0;
+		return false;
+	}
+
+	return true;
+}
+
+double IndexHistogram::getEqualSelectivity(const UCHAR* key, USHORT length) const
+{
+	fb_assert(m_count);
+
+	Key probe;
+	probe.assign(key, length);
+
+	FB_UINT64 commonCount = 0;
+
+	for (const auto& value : m_values)
+	{
+		if (!value.key.compare(probe))
+			return (double) value.count / m_count;
+
+		commonCount += value.count;
+	}
+
+	// Assume the remaining keys to be distributed uniformly among the remaining values
+
+	const FB_UINT64 restCount = (m_count > commonCount) ? m_count - commonCount : 1;
+	const FB_UINT64 restDistinct = (m_distinct > m_values.getCount()) ? m_distinct - m_values.getCount() : 1;
+
+	return (double) restCount / restDistinct / m_count;
+}
+
+double IndexHistogram::getRangeSelectivity(const UCHAR* lower, USHORT lowerLength, bool excludeLower,
+	const UCHAR* upper, USHORT upperLength, bool excludeUpper) const
+{
+	fb_assert(m_count);
+
+	double first = 0, last = (double) m_count;
+	Key probe;
+
+	if (lower)
+	{
+		probe.assign(lower, lowerLength);
+		first = getKeysBefore(probe, excludeLower);
+	}
+
+	if (upper)
+	{
+		probe.assign(upper, upperLength);
+		last = getKeysBefore(probe, !excludeUpper);
+	}
+
+	// Bounds inside the same bucket are not distinguished, so let the range
+	// contain at least the average value
+
+	const double count = MAX(last - first, (double) m_count / m_distinct);
+
+	return MIN(count / m_count, 1.0);
+}
+
+// Estimate the number of keys less than (or equal to) the given one.
+// Key inside a bucket is assumed to be in its middle.
+
+double IndexHistogram::getKeysBefore(const Key& key, bool inclusive) const
+{
+	FB_SIZE_T pos = 0;
+	for (FB_SIZE_T high = m_bounds.getCount(); pos < high; )
+	{
+		const FB_SIZE_T mid = (pos + high) / 2;
+		const int result = m_bounds[mid].compare(key);
+
+		if (result < 0 || (inclusive && result == 0))
+			pos = mid + 1;
+		else
+			high = mid;
+	}
+
+	const double bucketStart = (double) pos * m_step;
+	const double bucketEnd = (pos < m_bounds.getCount()) ? bucketStart + m_step : (double) m_count;
+
+	return MIN((bucketStart + bucketEnd) / 2, (double) m_count);
+}
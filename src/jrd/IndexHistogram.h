@@ -0,0 +1,210 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		IndexHistogram.h
+ *	DESCRIPTION:	Distribution of index keys for the optimizer
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_INDEX_HISTOGRAM_H
+#define JRD_INDEX_HISTOGRAM_H
+
+#include "../common/classes/alloc.h"
+#include "../common/classes/array.h"
+#include "../common/classes/RefCounted.h"
+
+namespace Jrd
+{
+
+class Format;
+
+// Distribution of the leading segment values of an index. It's collected by
+// BTR_selectivity() walking the leaf level, so keys are added in index order.
+//
+// Histogram of a non-indexed column is built by SET STATISTICS TABLE from a sample
+// of data pages. Column values are turned into the keys of a single segment index
+// on the column, sampled keys are sorted by finishSample() and then added as usual.
+//
+// The histogram is equi-depth: every bucket holds the same number of keys and
+// is described by its upper bound. The most common values are kept aside with
+// their exact counts, so a few heavy values (status codes, tenant ids, etc)
+// don't distort the estimations made for all the others.
+//
+// Keys are compared in their binary-comparable form, i.e. as they're stored in
+// the index, truncated to MAX_KEY_LENGTH bytes.
+//
+// Histogram cached in the index block is reference counted, as the block may
+// forget it while a statement being compiled still looks there.
+
+class IndexHistogram : public Firebird::RefCounted
+{
+public:
+	static const unsigned MAX_BUCKETS = 64;
+	static const unsigned MAX_VALUES = 16;
+	static const unsigned MAX_KEY_LENGTH = 64;
+	static const USHORT UNKNOWN_KEY_TYPE = MAX_USHORT;
+
+	explicit IndexHistogram(MemoryPool& pool)
+		: m_bounds(pool), m_values(pool), m_samples(pool)
+	{}
+
+	static USHORT getLeadingLength(const UCHAR* key, USHORT length, USHORT segments, bool descending);
+
+	void add(const UCHAR* key, USHORT length);
+	void finish();
+
+	// Sampled keys come in any order. Position either replaces a key sampled before
+	// or, if it's beyond the sample, appends the key. Total count is the estimated number of keys
+	// the sample was taken from, it's used to estimate the number of distinct keys.
+	void addSample(FB_SIZE_T position, const UCHAR* key, USHORT length);
+	void finishSample(FB_UINT64 totalCount);
+
+	FB_SIZE_T getSampleCount() const
+	{
+		return m_samples.getCount();
+	}
+
+	bool isEmpty() const
+	{
+		return !m_count;
+	}
+
+	// Index key type (idx_itype) of the column values, unknown for index histograms
+	USHORT getKeyType() const
+	{
+		return m_keyType;
+	}
+
+	void setKeyType(USHORT keyType)
+	{
+		m_keyType = keyType;
+	}
+
+	void store(Firebird::UCharBuffer& buffer) const;
+	bool parse(const UCHAR* buffer, ULONG length);
+
+	// Both return the fraction of index keys matching the given key(s),
+	// missing range bound means the range is open from that side
+	double getEqualSelectivity(const UCHAR* key, USHORT length) const;
+	double getRangeSelectivity(const UCHAR* lower, USHORT lowerLength, bool excludeLower,
+		const UCHAR* upper, USHORT upperLength, bool excludeUpper) const;
+
+private:
+	struct Key
+	{
+		USHORT length;
+		UCHAR data[MAX_KEY_LENGTH];
+
+		void assign(const UCHAR* key, USHORT keyLength)
+		{
+			length = MIN(keyLength, MAX_KEY_LENGTH);
+			memcpy(data, key, length);
+		}
+
+		int compare(const Key& other) const
+		{
+			const int result = memcmp(data, other.data, MIN(length, other.length));
+			return result ? result : (int) length - (int) other.length;
+		}
+	};
+
+	struct Value
+	{
+		Key key;
+		FB_UINT64 count;
+	};
+
+	void addValue(const Key& key, FB_UINT64 count);
+	double getKeysBefore(const Key& key, bool inclusive) const;
+
+	Firebird::Array<Key> m_bounds;
+	Firebird::Array<Value> m_values;
+	FB_UINT64 m_count = 0;			// number of keys
+	FB_UINT64 m_distinct = 0;		// number of distinct keys
+	FB_UINT64 m_step = 1;			// number of keys per bucket
+	USHORT m_keyType = UNKNOWN_KEY_TYPE;
+
+	// building state
+	Key m_last;
+	FB_UINT64 m_run = 0;
+	FB_UINT64 m_singles = 0;		// number of keys met only once
+	Firebird::Array<Key> m_samples;
+};
+
+// Histograms of the columns of a relation, cached in the relation block.
+// Reference counted for the same reason as the index histogram. Format is
+// the relation format they were checked against when loaded.
+
+class ColumnHistograms : public Firebird::RefCounted
+{
+	struct Column
+	{
+		USHORT id;					// field id
+		SSHORT scale;				// scale used to make keys of big exact numerics
+		IndexHistogram* histogram;	// referenced
+	};
+
+public:
+	explicit ColumnHistograms(MemoryPool& pool, const Format* format = nullptr)
+		: m_format(format), m_columns(pool)
+	{}
+
+	~ColumnHistograms()
+	{
+		for (const auto& column : m_columns)
+			column.histogram->release();
+	}
+
+	void add(USHORT id, SSHORT scale, IndexHistogram* histogram)
+	{
+		histogram->addRef();
+		m_columns.add({id, scale, histogram});
+	}
+
+	const IndexHistogram* get(USHORT id, SSHORT& scale) const
+	{
+		for (const auto& column : m_columns)
+		{
+			if (column.id == id)
+			{
+				scale = column.scale;
+				return column.histogram;
+			}
+		}
+
+		return nullptr;
+	}
+
+	bool isEmpty() const
+	{
+		return m_columns.isEmpty();
+	}
+
+	const Format* getFormat() const
+	{
+		return m_format;
+	}
+
+private:
+	const Format* const m_format;
+	Firebird::Array<Column> m_columns;
+};
+
+} // namespace Jrd
+
+#endif // JRD_INDEX_HISTOGRAM_H
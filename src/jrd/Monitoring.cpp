@@ -469,6 +469,8 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 	const auto tab_stat_buffer = allocBuffer(tdbb, pool, rel_mon_tab_stats);
 	const auto local_temp_tables_buffer = allocBuffer(tdbb, pool, rel_mon_local_temp_tables);
 	const auto local_temp_table_columns_buffer = allocBuffer(tdbb, pool, rel_mon_local_temp_table_columns);
+	const auto cache_partitions_buffer = allocBuffer(tdbb, pool, rel_mon_cache_partitions);
+	const auto seq_caches_buffer = allocBuffer(tdbb, pool, rel_mon_seq_caches);
 
 	// Increment the global monitor generation
 
@@ -610,6 +612,12 @@ MonitoringSnapshot::MonitoringSnapshot(thread_db* tdbb, MemoryPool& pool)
 		case rel_mon_local_temp_table_columns:
 			buffer = local_temp_table_columns_buffer;
 			break;
+		case rel_mon_cache_partitions:
+			buffer = cache_partitions_buffer;
+			break;
+		case rel_mon_seq_caches:
+			buffer = seq_caches_buffer;
+			break;
 		default:
 			fb_assert(false);
 		}
@@ -1023,6 +1031,22 @@ void Monitoring::putDatabase(thread_db* tdbb, SnapshotData::DumpRecord& record)
 
 	record.storeInteger(f_mon_db_repl_mode, dbb->dbb_replica_mode);
 
+	// page cache replacement policy and its counters
+	const auto& partitions = dbb->dbb_bcb->bcb_partitions;
+	if (partitions.hasData())
+	{
+		FB_UINT64 hits = 0, misses = 0;
+		for (const auto partition : partitions)
+		{
+			hits += partition->cp_replacement->getHits();
+			misses += partition->cp_replacement->getMisses();
+		}
+
+		record.storeString(f_mon_db_page_repl, string(partitions[0]->cp_replacement->getName()));
+		record.storeInteger(f_mon_db_cache_hits, hits);
+		record.storeInteger(f_mon_db_cache_misses, misses);
+	}
+
 	// statistics
 	const int stat_id = fb_utils::genUniqueId();
 	record.storeGlobalId(f_mon_db_stat_id, getGlobalId(stat_id));
@@ -1042,6 +1066,9 @@ void Monitoring::putDatabase(thread_db* tdbb, SnapshotData::DumpRecord& record)
 		putStatistics(tdbb, record, zero_rt_stats, stat_id, stat_database);
 		putMemoryUsage(record, zero_mem_stats, stat_id, stat_database);
 	}
+
+	for (const auto partition : partitions)
+		putCachePartition(record, partition);
 }
 
 
@@ -1510,6 +1537,11 @@ void Monitoring::putStatistics(thread_db* tdbb, SnapshotData::DumpRecord& record
 	record.storeInteger(f_mon_io_page_writes, statistics[PageStatType::WRITES]);
 	record.storeInteger(f_mon_io_page_fetches, statistics[PageStatType::FETCHES]);
 	record.storeInteger(f_mon_io_page_marks, statistics[PageStatType::MARKS]);
+	record.storeInteger(f_mon_io_page_prefetches, statistics[PageStatType::PREFETCHES]);
+	record.storeInteger(f_mon_io_page_prefetch_hits, statistics[PageStatType::PREFETCH_HITS]);
+	record.storeInteger(f_mon_io_hash_spills, statistics[TempStatType::HASH_SPILLS]);
+	record.storeInteger(f_mon_io_hash_partitions, statistics[TempStatType::HASH_PARTITIONS]);
+	record.storeInteger(f_mon_io_hash_spill_bytes, statistics[TempStatType::HASH_SPILL_BYTES]);
 	record.write();
 
 	// logical I/O statistics (global)
@@ -1638,6 +1670,45 @@ void Monitoring::putMemoryUsage(SnapshotData::DumpRecord& record, const MemorySt
 }
 
 
+void Monitoring::putCachePartition(SnapshotData::DumpRecord& record, const CachePartition* partition)
+{
+	record.reset(rel_mon_cache_partitions);
+
+	record.storeInteger(f_mon_cp_id, partition->cp_number);
+	if (partition->cp_node >= 0)
+		record.storeInteger(f_mon_cp_node, partition->cp_node);
+	record.storeInteger(f_mon_cp_page_bufs, partition->cp_count);
+	record.storeInteger(f_mon_cp_hits, partition->cp_replacement->getHits());
+	record.storeInteger(f_mon_cp_misses, partition->cp_replacement->getMisses());
+	record.storeInteger(f_mon_cp_page_writes, partition->cp_writes.value());
+
+	record.write();
+}
+
+
+void Monitoring::putSequenceCaches(SnapshotData::DumpRecord& record, const Attachment* attachment)
+{
+	for (const auto& item : attachment->att_generator_cache.getEntries())
+	{
+		const GeneratorCache::Entry* const entry = item.second;
+
+		if (!entry->remaining)
+			continue;
+
+		record.reset(rel_mon_seq_caches);
+
+		record.storeInteger(f_mon_seq_att_id, attachment->att_attachment_id);
+		record.storeString(f_mon_seq_schema, entry->name.schema);
+		record.storeString(f_mon_seq_name, entry->name.object);
+		record.storeInteger(f_mon_seq_cache_size, entry->cacheSize);
+		record.storeInteger(f_mon_seq_next_value, entry->value + entry->step);
+		record.storeInteger(f_mon_seq_last_value, entry->value + (SINT64) entry->step * entry->remaining);
+
+		record.write();
+	}
+}
+
+
 void Monitoring::checkState(thread_db* tdbb)
 {
 	const auto* dbb = tdbb->getDatabase();
@@ -1751,6 +1822,10 @@ void Monitoring::dumpAttachment(thread_db* tdbb, Attachment* attachment, ULONG g
 		putLocalTempTables(tdbb, record, attachment, item.second);
 		putLocalTempTableFields(tdbb, record, attachment, item.second);
 	}
+
+	// Values reserved by sequences with CACHE
+
+	putSequenceCaches(record, attachment);
 }
 
 
@@ -41,6 +41,7 @@ class Record;
 class RecordBuffer;
 class RuntimeStatistics;
 class LocalTemporaryTable;
+class CachePartition;
 
 class SnapshotData
 {
@@ -431,6 +432,8 @@ private:
 	static void putLocalTempTableFields(thread_db*, SnapshotData::DumpRecord&, const Attachment*, const LocalTemporaryTable*);
 	static void putContextVars(SnapshotData::DumpRecord&, const Firebird::StringMap&, SINT64, bool);
 	static void putMemoryUsage(SnapshotData::DumpRecord&, const Firebird::MemoryStats&, int, int);
+	static void putCachePartition(SnapshotData::DumpRecord&, const CachePartition*);
+	static void putSequenceCaches(SnapshotData::DumpRecord&, const Attachment*);
 };
 
 } // namespace
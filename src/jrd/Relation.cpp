@@ -593,6 +593,7 @@ void RelationPages::free(RelationPages*& nextFree)
 	rel_index_root = rel_data_pages = 0;
 	rel_slot_space = rel_pri_data_space = rel_sec_data_space = 0;
 	rel_last_free_pri_dp = rel_last_free_blb_dp = 0;
+	rel_bulk_free_dp = rel_bulk_free_count = 0;
 	rel_instance_id = 0;
 
 	dpMap.clear();
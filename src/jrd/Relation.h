@@ -35,6 +35,7 @@ namespace Jrd
 {
 
 class BoolExprNode;
+class ColumnHistograms;
 class RseNode;
 class StmtNode;
 
@@ -87,6 +88,8 @@ public:
 	ULONG rel_sec_data_space;	// lowest pointer page with secondary data page space
 	ULONG rel_last_free_pri_dp;	// last primary data page found with space
 	ULONG rel_last_free_blb_dp;	// last blob data page found with space
+	ULONG rel_bulk_free_dp;		// sequence of next empty data page reserved for bulk inserts
+	USHORT rel_bulk_free_count;	// count of empty data pages reserved for bulk inserts
 	USHORT rel_pg_space_id;
 
 	RelationPages(Firebird::MemoryPool& pool)
@@ -94,6 +97,7 @@ public:
 		  rel_index_root(0), rel_data_pages(0), rel_slot_space(0),
 		  rel_pri_data_space(0), rel_sec_data_space(0),
 		  rel_last_free_pri_dp(0), rel_last_free_blb_dp(0),
+		  rel_bulk_free_dp(0), rel_bulk_free_count(0),
 		  rel_pg_space_id(DB_PAGE_SPACE), rel_next_free(NULL),
 		  useCount(0),
 		  dpMap(pool),
@@ -256,6 +260,9 @@ public:
 	Lock*		rel_gc_lock;			// garbage collection lock
 	IndexLock*	rel_index_locks;		// index existence locks
 	IndexBlock*	rel_index_blocks;		// index blocks for caching index info
+	ColumnHistograms* rel_histograms;	// distribution of column values (referenced)
+	bool		rel_histograms_loaded;	// histograms were looked up (they may be missing)
+	Lock*		rel_histogram_lock;		// lock to discard histograms when they're updated
 	TrigVector*	rel_pre_erase; 			// Pre-operation erase trigger
 	TrigVector*	rel_post_erase;			// Post-operation erase trigger
 	TrigVector*	rel_pre_modify;			// Pre-operation modify trigger
@@ -408,6 +415,7 @@ inline constexpr ULONG REL_gc_lockneed			= 0x40000;	// gc lock should be acquire
 inline constexpr ULONG REL_temp_gtt				= 0x80000;	// relation is a GTT
 inline constexpr ULONG REL_temp_ltt				= 0x100000;	// relation is a LTT
 inline constexpr ULONG REL_rescan				= 0x200000;	// rescan request was submitted while relation being scanning
+inline constexpr ULONG REL_encoded_records		= 0x400000;	// records use column-aware encoding
 
 
 /// class jrd_rel
@@ -50,6 +50,8 @@ enum class PageStatType
 	READS,
 	MARKS,
 	WRITES,
+	PREFETCHES,
+	PREFETCH_HITS,
 	TOTAL_ITEMS
 };
 
@@ -73,15 +75,24 @@ enum class RecordStatType
 	TOTAL_ITEMS
 };
 
+enum class TempStatType
+{
+	HASH_SPILLS = 0,
+	HASH_PARTITIONS,
+	HASH_SPILL_BYTES,
+	TOTAL_ITEMS
+};
+
 class RuntimeStatistics : protected Firebird::AutoStorage
 {
 	static constexpr size_t PAGE_TOTAL_ITEMS = static_cast<size_t>(PageStatType::TOTAL_ITEMS);
 	static constexpr size_t RECORD_TOTAL_ITEMS = static_cast<size_t>(RecordStatType::TOTAL_ITEMS);
+	static constexpr size_t TEMP_TOTAL_ITEMS = static_cast<size_t>(TempStatType::TOTAL_ITEMS);
 
 public:
 	// Number of globally counted items.
 	//
-	// dimitr:	Currently, they include page-level and record-level counters.
+	// dimitr:	Currently, they include page-level, record-level and temporary space counters.
 	// 			However, this is not strictly required to maintain global record-level counters,
 	//			as they may be aggregated from the tableCounters array on demand. This would slow down
 	//			the retrieval of counters but save some CPU cycles inside tdbb->bumpStats().
@@ -90,7 +101,7 @@ public:
 	//			So far I leave everything as is but it can be reconsidered in the future.
 	//			sumValue() method is already in place for that purpose.
 	//
-	static constexpr size_t GLOBAL_ITEMS = PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS;
+	static constexpr size_t GLOBAL_ITEMS = PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS + TEMP_TOTAL_ITEMS;
 
 private:
 	template <typename T> class CountsVector
@@ -396,6 +407,19 @@ public:
 		}
 	}
 
+	const SINT64& operator[](const TempStatType type) const
+	{
+		const auto index = static_cast<size_t>(type);
+		return values[PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS + index];
+	}
+
+	void bumpValue(const TempStatType type, SINT64 delta = 1)
+	{
+		++allChgNumber;
+		const auto index = static_cast<size_t>(type);
+		values[PAGE_TOTAL_ITEMS + RECORD_TOTAL_ITEMS + index] += delta;
+	}
+
 	// Calculate difference between counts stored in this object and current
 	// counts of given request. Counts stored in object are destroyed.
 	void setToDiff(const RuntimeStatistics& newStats);
@@ -0,0 +1,166 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		SnapshotSlots.cpp
+ *	DESCRIPTION:	Shared list of active snapshots
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/SnapshotSlots.h"
+
+using namespace Jrd;
+
+
+bool SnapshotSlots::allocate(AttNumber attachmentId, SnapshotHandle& handle) noexcept
+{
+	fb_assert(attachmentId && !isReserved(attachmentId));
+
+	// Scan previously used slots first
+	const ULONG hint = min_free_slot.load(std::memory_order_relaxed);
+	const ULONG used = slots_used.load();
+
+	if (findFree(hint, used, attachmentId, handle) ||
+		findFree(0, MIN(hint, used), attachmentId, handle))
+	{
+		// Move allocator watermark position unless someone already moved it
+		ULONG expected = hint;
+		min_free_slot.compare_exchange_strong(expected, handle + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// See if we have some space left in the snapshots block
+	ULONG last = slots_used.load();
+
+	while (last < slots_allocated.load(std::memory_order_relaxed))
+	{
+		if (!slots_used.compare_exchange_weak(last, last + 1))
+			continue;
+
+		if (claim(last, attachmentId))
+		{
+			handle = last;
+			return true;
+		}
+
+		// Taken by someone scanning the used slots
+		last = slots_used.load();
+	}
+
+	return false;
+}
+
+
+void SnapshotSlots::release(SnapshotHandle handle, AttNumber releaser) noexcept
+{
+	Slot* const slot = slots + handle;
+
+	slot->snapshot.store(0, std::memory_order_release);
+	slot->attachment_id.store(0);
+
+	// Make slot available for allocator
+	if (min_free_slot.load(std::memory_order_relaxed) > handle)
+		min_free_slot.store(handle, std::memory_order_relaxed);
+
+	cutOff(handle + 1, releaser);
+}
+
+
+bool SnapshotSlots::resetReserved(ULONG slotNumber, AttNumber reserved, AttNumber releaser) noexcept
+{
+	fb_assert(isReserved(reserved));
+
+	if (!slots[slotNumber].attachment_id.compare_exchange_strong(reserved, 0))
+		return false;
+
+	if (min_free_slot.load(std::memory_order_relaxed) > slotNumber)
+		min_free_slot.store(slotNumber, std::memory_order_relaxed);
+
+	cutOff(slotNumber + 1, releaser);
+	return true;
+}
+
+
+void SnapshotSlots::cutOff(ULONG end, AttNumber releaser) noexcept
+{
+	fb_assert(releaser && !isReserved(releaser));
+
+	// Update used slots count if the last one was released. Free slots at the end are
+	// reserved first, so nobody allocates them while the count is being decreased.
+	ULONG used = slots_used.load();
+
+	if (end != used)
+		return;
+
+	while (used)
+	{
+		ULONG count = used;
+
+		for (; count; count--)
+		{
+			AttNumber expected = 0;
+			if (!slots[count - 1].attachment_id.compare_exchange_strong(expected, RESERVED | releaser))
+				break;
+		}
+
+		if (count == used)
+			return;
+
+		// Does nothing if someone took the next slot meanwhile
+		const ULONG reserved = used;
+		slots_used.compare_exchange_strong(used, count);
+
+		for (ULONG n = count; n < reserved; n++)
+			slots[n].attachment_id.store(0);
+
+		// Slot below could be released meanwhile by someone who saw the old count, or
+		// allocator could fail to claim a slot above that was still reserved by us
+		used = slots_used.load();
+	}
+}
+
+
+bool SnapshotSlots::findFree(ULONG from, ULONG to, AttNumber attachmentId, SnapshotHandle& handle) noexcept
+{
+	for (ULONG n = from; n < to; n++)
+	{
+		if (!slots[n].attachment_id.load(std::memory_order_relaxed) && claim(n, attachmentId))
+		{
+			handle = n;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+bool SnapshotSlots::claim(ULONG slotNumber, AttNumber attachmentId) noexcept
+{
+	AttNumber expected = 0;
+	if (!slots[slotNumber].attachment_id.compare_exchange_strong(expected, attachmentId))
+		return false;
+
+	// Slot could be released by its previous owner and cut off from the used ones after
+	// we've seen it. As it's not reserved anymore, nobody else decreases the count below it.
+	ULONG used = slots_used.load();
+	while (used <= slotNumber && !slots_used.compare_exchange_weak(used, slotNumber + 1))
+		;
+
+	return true;
+}
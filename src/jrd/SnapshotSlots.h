@@ -0,0 +1,100 @@
+/*
+ *	PROGRAM:	JRD Access Method
+ *	MODULE:		SnapshotSlots.h
+ *	DESCRIPTION:	Shared list of active snapshots
+ *
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#ifndef JRD_SNAPSHOT_SLOTS_H
+#define JRD_SNAPSHOT_SLOTS_H
+
+#include <atomic>
+#include "../common/isc_s_proto.h"
+
+namespace Jrd {
+
+// Snapshots of all attachments of all processes, placed into shared memory by TipCache.
+// Every transaction and read consistency statement takes a slot, so slots are allocated
+// and released without locks: a slot is owned by whoever changes its attachment_id from
+// zero. Readers (see TipCache::updateActiveSnapshots) scan slots below slots_used and
+// ignore slots with zero snapshot, i.e. the ones being allocated or released.
+//
+// Free slots at the end are reserved by the releasing attachment while slots_used is
+// being decreased. If its process dies meanwhile, they are left reserved: readers
+// check the attachment and reset such slots, see resetReserved().
+//
+// Note: when maintaining this structure, we are extra careful
+// to keep it consistent at all times, so that the process using it
+// can be killed at any time without adverse consequences.
+
+class SnapshotSlots : public Firebird::MemoryHeader
+{
+public:
+	// Marks free slots being cut off from the used ones, other bits of attachment_id
+	// of such slot tell what attachment does it
+	static constexpr AttNumber RESERVED = AttNumber(1) << 63;
+
+	static bool isReserved(AttNumber attachmentId) noexcept
+	{
+		return (attachmentId & RESERVED) != 0;
+	}
+
+	static AttNumber reservedBy(AttNumber attachmentId) noexcept
+	{
+		return attachmentId & ~RESERVED;
+	}
+
+	struct Slot
+	{
+		std::atomic<AttNumber> attachment_id; // Unused slots have attachment_id == 0
+		std::atomic<CommitNumber> snapshot;
+	};
+
+	void initSlots(ULONG count) noexcept
+	{
+		slots_allocated.store(count, std::memory_order_relaxed);
+		slots_used.store(0, std::memory_order_relaxed);
+		min_free_slot.store(0, std::memory_order_relaxed);
+	}
+
+	// Takes a free slot for the attachment, returns false if all slots are used.
+	// Slot gets visible to readers when its snapshot is stored by the caller.
+	bool allocate(AttNumber attachmentId, SnapshotHandle& handle) noexcept;
+
+	// Frees slot taken by allocate(), on behalf of given attachment
+	void release(SnapshotHandle handle, AttNumber releaser) noexcept;
+
+	// Frees slot left reserved by the dead attachment, on behalf of given one.
+	// Returns false if the slot is not reserved the same way anymore.
+	bool resetReserved(ULONG slotNumber, AttNumber reserved, AttNumber releaser) noexcept;
+
+	std::atomic<ULONG> slots_allocated;
+	std::atomic<ULONG> slots_used;
+	std::atomic<ULONG> min_free_slot; // Position where to start looking for free space
+	Slot slots[1];
+
+private:
+	bool findFree(ULONG from, ULONG to, AttNumber attachmentId, SnapshotHandle& handle) noexcept;
+	bool claim(ULONG slotNumber, AttNumber attachmentId) noexcept;
+	void cutOff(ULONG end, AttNumber releaser) noexcept;
+};
+
+} // namespace Jrd
+
+#endif // JRD_SNAPSHOT_SLOTS_H
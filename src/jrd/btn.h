@@ -261,6 +261,84 @@ struct IndexNode
 		return localPointer;
 	}
 
+	UCHAR* readNodeKey(UCHAR* pagePointer, bool leafNode)
+	{
+	/**************************************
+	 *
+	 *	r e a d N o d e K e y
+	 *
+	 **************************************
+	 *
+	 * Functional description
+	 *	Same as readNode but only prefix, length
+	 *  and data are read, record and page numbers
+	 *  are skipped without decoding. It's enough
+	 *  to walk the page comparing keys.
+	 *
+	 **************************************/
+		nodePointer = pagePointer;
+
+		UCHAR* localPointer = pagePointer;
+		const UCHAR internalFlags = ((*localPointer++ & 0xE0) >> 5);
+
+		isEndLevel = (internalFlags == BTN_END_LEVEL_FLAG);
+		isEndBucket = (internalFlags == BTN_END_BUCKET_FLAG);
+
+		if (isEndLevel)
+		{
+			prefix = 0;
+			length = 0;
+			return localPointer;
+		}
+
+		// Skip remaining bytes of record number and then page number,
+		// the last byte of a number has high bit cleared
+		while (*localPointer++ & 0x80)
+			;
+
+		if (!leafNode)
+		{
+			while (*localPointer++ & 0x80)
+				;
+		}
+
+		if (internalFlags == BTN_ZERO_PREFIX_ZERO_LENGTH_FLAG)
+			prefix = 0;
+		else
+		{
+			ULONG tmp = *localPointer++;
+			prefix = (tmp & 0x7F);
+			if (tmp & 0x80)
+			{
+				tmp = *localPointer++;
+				prefix |= (tmp & 0x7F) << 7;
+			}
+		}
+
+		if ((internalFlags == BTN_ZERO_LENGTH_FLAG) ||
+			(internalFlags == BTN_ZERO_PREFIX_ZERO_LENGTH_FLAG))
+		{
+			length = 0;
+		}
+		else if (internalFlags == BTN_ONE_LENGTH_FLAG)
+			length = 1;
+		else
+		{
+			ULONG tmp = *localPointer++;
+			length = (tmp & 0x7F);
+			if (tmp & 0x80)
+			{
+				tmp = *localPointer++;
+				length |= (tmp & 0x7F) << 7;
+			}
+		}
+
+		data = localPointer;
+		localPointer += length;
+
+		return localPointer;
+	}
+
 };
 
 struct IndexJumpNode
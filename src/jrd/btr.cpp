@@ -28,6 +28,7 @@
 #include <string.h>
 #include <stdlib.h>
 #include <math.h>
+#include <bit>
 #include "memory_routines.h"
 #include "../common/TimeZoneUtil.h"
 #include "../common/classes/vector.h"
@@ -38,6 +39,8 @@
 #include "../jrd/val.h"
 #include "../jrd/btr.h"
 #include "../jrd/btn.h"
+#include "../jrd/IndexHistogram.h"
+#include "../jrd/IndexBulkInsert.h"
 #include "../jrd/req.h"
 #include "../jrd/tra.h"
 #include "../jrd/intl.h"
@@ -62,6 +65,11 @@
 #include "../jrd/pag_proto.h"
 #include "../jrd/tra_proto.h"
 
+#if defined(_M_X64) || defined(__x86_64__)
+#define BTR_SIMD
+#include <emmintrin.h>
+#endif
+
 using namespace Jrd;
 using namespace Ods;
 using namespace Firebird;
@@ -185,10 +193,99 @@ namespace
 		temporary_key jumpKey;
 	};
 
+	// Leaf pages of the index being built are allocated in runs of consecutive pages,
+	// from PAGES_IN_EXTENT growing up to MAX_EXTENT_PAGES, so they are read in order by
+	// index scans. Pages left in the last run are released when the build is done.
+	class LeafPageRuns
+	{
+	public:
+		pag* allocate(thread_db* tdbb, WIN* window)
+		{
+			if (m_count)
+			{
+				window->win_page = PageNumber(window->win_page.getPageSpaceID(), m_next++);
+				m_count--;
+
+				return CCH_fake(tdbb, window, 1);
+			}
+
+			// The first page goes alone, small index needs no more
+			const unsigned length = m_length;
+			m_length = length ? MIN(length * 2, MAX_EXTENT_PAGES) : PAGES_IN_EXTENT;
+
+			pag* const page = length ?
+				PAG_allocate_pages(tdbb, window, length, true) : PAG_allocate(tdbb, window);
+
+			m_next = window->win_page.getPageNum() + 1;
+			m_count = length ? length - 1 : 0;
+
+			return page;
+		}
+
+		void release(thread_db* tdbb, USHORT pageSpaceId)
+		{
+			if (!m_count)
+				return;
+
+			HalfStaticArray<ULONG, MAX_EXTENT_PAGES> pages;
+			for (unsigned i = 0; i < m_count; i++)
+				pages.add(m_next + i);
+
+			m_count = 0;
+			PAG_release_pages(tdbb, pageSpaceId, pages.getCount(), pages.begin(), 0);
+		}
+
+	private:
+		ULONG m_next = 0;
+		unsigned m_count = 0;
+		unsigned m_length = 0;
+	};
+
+	// Returns the number of equal bytes at the start of two keys.
+	// Compares 16 (or 8) bytes at once, keys on a page are mostly longer than a few bytes.
+	inline USHORT commonLength(const UCHAR* p, const UCHAR* q, USHORT length)
+	{
+		USHORT n = 0;
+
+#ifdef BTR_SIMD
+		for (; n + sizeof(__m128i) <= length; n += sizeof(__m128i))
+		{
+			const __m128i a = _mm_loadu_si128((const __m128i*) (p + n));
+			const __m128i b = _mm_loadu_si128((const __m128i*) (q + n));
+			const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) ^ 0xFFFF;
+
+			if (mask)
+				return n + std::countr_zero(mask);
+		}
+#endif
+
+		for (; n + sizeof(FB_UINT64) <= length; n += sizeof(FB_UINT64))
+		{
+			FB_UINT64 a, b;
+			memcpy(&a, p + n, sizeof(a));
+			memcpy(&b, q + n, sizeof(b));
+
+			if (const FB_UINT64 diff = a ^ b)
+			{
+#ifdef WORDS_BIGENDIAN
+				return n + std::countl_zero(diff) / 8;
+#else
+				return n + std::countr_zero(diff) / 8;
+#endif
+			}
+		}
+
+		while (n < length && p[n] == q[n])
+			n++;
+
+		return n;
+	}
+
 } // namespace
 
 static ULONG add_node(thread_db*, WIN*, index_insertion*, temporary_key*, RecordNumber*,
 					  ULONG*, ULONG*);
+static int compare_keys(const temporary_key*, const temporary_key*, bool);
 static void compress(thread_db*, const dsc*, const SSHORT scale, temporary_key*,
 					 USHORT, bool, USHORT, bool*);
 static USHORT compress_root(thread_db*, index_root_page*);
@@ -212,7 +309,7 @@ static void generate_jump_nodes(thread_db*, btree_page*, JumpNodeList*, USHORT,
 								USHORT*, USHORT*, USHORT*, USHORT);
 
 static ULONG insert_node(thread_db*, WIN*, index_insertion*, temporary_key*,
-						 RecordNumber*, ULONG*, ULONG*);
+						 RecordNumber*, ULONG*, ULONG*, bool* = nullptr);
 
 static INT64_KEY make_int64_key(SINT64, SSHORT);
 #ifdef DEBUG_INDEXKEY
@@ -272,6 +369,142 @@ bool BtrPageGCLock::isPageGCAllowed(thread_db* tdbb, const PageNumber& page)
 	return true;
 }
 
+// BtrSortedInsert class
+
+BtrSortedInsert::BtrSortedInsert(thread_db* tdbb)
+	: m_leafLock(tdbb), m_leafPage(0), m_lastNumber(0)
+{
+	m_lastKey.key_length = 0;
+	m_lastKey.key_flags = 0;
+	m_lastKey.key_nulls = 0;
+}
+
+BtrSortedInsert::~BtrSortedInsert()
+{
+	if (m_leafLock.isActive())
+		LCK_release(JRD_get_thread_data(), &m_leafLock);
+}
+
+void BtrSortedInsert::insert(thread_db* tdbb, WIN* root_window, index_insertion* insertion)
+{
+/**************************************
+ *
+ * Functional description
+ *	Insert a node of the keys sorted in the index order. The node goes
+ *	into the leaf page the previous one was inserted into (or into its
+ *	right sibling), so keys are merged into the index in leaf order and
+ *	keys beyond the current maximum are appended to the rightmost leaf.
+ *	Only when the leaf page has no room for the node, it's inserted from
+ *	the index root by BTR_insert() that splits the page.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	const index_desc* const idx = insertion->iib_descriptor;
+	temporary_key* const key = insertion->iib_key;
+
+	// Duplicates found by insert_node() are not validated here
+	fb_assert(!(idx->idx_flags & (idx_unique | idx_primary)));
+
+	// The remembered leaf can't be used for a key less than the last one, it could be
+	// below the leaf. Keys are sorted by the caller but it may order keys differently,
+	// e.g. the ones with trailing zero bytes.
+	if (m_leafPage)
+	{
+		const int result = compare_keys(&m_lastKey, key, (idx->idx_flags & idx_descending));
+
+		if (result > 0 || (result == 0 && m_lastNumber >= insertion->iib_number))
+			releaseLeaf(tdbb);
+	}
+
+	RelationPages* relPages = insertion->iib_relation->getPages(tdbb);
+	WIN window(relPages->rel_pg_space_id, m_leafPage ? m_leafPage : idx->idx_root);
+	btree_page* bucket;
+
+	if (m_leafPage)
+	{
+		CCH_RELEASE(tdbb, root_window);
+
+		// The page is protected from garbage collection, so it's still a leaf of the index
+		bucket = (btree_page*) CCH_FETCH(tdbb, &window, LCK_write, pag_index);
+		fb_assert(bucket->btr_level == 0 && bucket->btr_relation == insertion->iib_relation->rel_id);
+	}
+	else
+	{
+		// Descend to the leaf level the way add_node() does
+		bucket = (btree_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_index);
+
+		if (bucket->btr_level == 0)
+		{
+			CCH_RELEASE(tdbb, &window);
+			bucket = (btree_page*) CCH_FETCH(tdbb, &window, LCK_write, pag_index);
+		}
+
+		CCH_RELEASE(tdbb, root_window);
+
+		while (bucket->btr_level > 0)
+		{
+			const ULONG page = find_page(bucket, key, idx, insertion->iib_number);
+
+			if (page == END_BUCKET)
+			{
+				bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, bucket->btr_sibling,
+					LCK_read, pag_index);
+			}
+			else
+			{
+				bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, page,
+					(bucket->btr_level == 1) ? LCK_write : LCK_read, pag_index);
+			}
+		}
+	}
+
+	temporary_key splitKey;
+	splitKey.key_flags = 0;
+	splitKey.key_length = 0;
+	RecordNumber splitNumber(0);
+	bool full = false;
+
+	while (true)
+	{
+		// Remember the leaf while it's latched, so it can't be garbage collected
+		if (window.win_page.getPageNum() != m_leafPage)
+		{
+			releaseLeaf(tdbb);
+			m_leafLock.disablePageGC(tdbb, window.win_page);
+			m_leafPage = window.win_page.getPageNum();
+		}
+
+		if (insert_node(tdbb, &window, insertion, &splitKey, &splitNumber,
+				NULL, NULL, &full) != NO_VALUE_PAGE)
+		{
+			break;
+		}
+
+		bucket = (btree_page*) CCH_HANDOFF(tdbb, &window, bucket->btr_sibling, LCK_write, pag_index);
+	}
+
+	if (full)
+	{
+		// Let BTR_insert() split the leaf. Its left part is still
+		// the lowest page the next keys could go into.
+		CCH_FETCH(tdbb, root_window, LCK_read, pag_root);
+		BTR_insert(tdbb, root_window, insertion);
+	}
+
+	copy_key(key, &m_lastKey);
+	m_lastNumber = insertion->iib_number;
+}
+
+void BtrSortedInsert::releaseLeaf(thread_db* tdbb)
+{
+	if (m_leafPage)
+	{
+		m_leafLock.enablePageGC(tdbb);
+		m_leafPage = 0;
+	}
+}
+
 // IndexErrorContext class
 
 void IndexErrorContext::raise(thread_db* tdbb, idx_e result, Record* record)
@@ -980,6 +1213,7 @@ bool BTR_description(thread_db* tdbb, jrd_rel* relation, index_root_page* root,
 	idx->idx_condition = nullptr;
 	idx->idx_condition_statement = nullptr;
 	idx->idx_fraction = 1.0;
+	idx->idx_histogram = nullptr;
 
 	// pick up field ids and type descriptions for each of the fields
 	const UCHAR* ptr = (UCHAR*) root + irt_desc->irt_desc;
@@ -1335,6 +1569,9 @@ btree_page* BTR_find_page(thread_db* tdbb,
 
 	SET_TDBB(tdbb);
 
+	// Keys collected by a large load are to be found as well
+	IndexBulkInsert::flush(tdbb, retrieval->irb_relation, retrieval->irb_index);
+
 	RelationPages* relPages = retrieval->irb_relation->getPages(tdbb);
 	fb_assert(window->win_page.getPageSpaceID() == relPages->rel_pg_space_id);
 
@@ -2380,7 +2617,8 @@ void BTR_reserve_slot(thread_db* tdbb, IndexCreation& creation)
 }
 
 
-void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity)
+void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity,
+	IndexHistogram* histogram)
 {
 /**************************************
  *
@@ -2394,6 +2632,8 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
  *	without visiting data pages. Thus the
  *	effects of uncommitted transactions
  *	will be included in the calculation.
+ *	If requested, collect the histogram of
+ *	the leading segment keys as well.
  *
  **************************************/
 
@@ -2553,6 +2793,13 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 			// keep the key value current for comparison with the next key
 			key.key_length = l;
 			memcpy(key.key_data + node.prefix, node.data, node.length);
+
+			if (histogram)
+			{
+				histogram->add(key.key_data,
+					IndexHistogram::getLeadingLength(key.key_data, key.key_length, segments, descending));
+			}
+
 			pointer = node.readNode(pointer, true);
 		}
 
@@ -2565,6 +2812,9 @@ void BTR_selectivity(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityL
 
 	CCH_RELEASE_TAIL(tdbb, &window);
 
+	if (histogram)
+		histogram->finish();
+
 	// calculate the selectivity
 	selectivity.grow(segments);
 	if (segments > 1)
@@ -2766,6 +3016,31 @@ static ULONG add_node(thread_db* tdbb,
 }
 
 
+static int compare_keys(const temporary_key* key1, const temporary_key* key2, bool descending)
+{
+/**************************************
+ *
+ *	c o m p a r e _ k e y s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compare two keys in the index order.
+ *	A key goes before the longer keys it's a prefix of,
+ *	unless the index is descending.
+ *
+ **************************************/
+
+	const int result = memcmp(key1->key_data, key2->key_data,
+		MIN(key1->key_length, key2->key_length));
+
+	if (result || key1->key_length == key2->key_length)
+		return result;
+
+	return ((key1->key_length < key2->key_length) != descending) ? -1 : 1;
+}
+
+
 static void compress(thread_db* tdbb,
 					 const dsc* desc,
 					 const SSHORT matchScale,
@@ -3808,6 +4083,7 @@ static ULONG fast_load(thread_db* tdbb,
 
 	HalfStaticArray<FB_UINT64, 4> duplicatesList(pool);
 	HalfStaticArray<FastLoadLevel, 4> levels(pool);
+	LeafPageRuns leafPages;
 
 	try
 	{
@@ -3823,7 +4099,7 @@ static ULONG fast_load(thread_db* tdbb,
 		// of the id and hope for the best.  Index buckets are (almost) always
 		// located through the index structure (dmp being an exception used
 		// only for debug) so the id is actually redundant.
-		btree_page* bucket = (btree_page*) DPM_allocate(tdbb, &leafLevel->window);
+		btree_page* bucket = (btree_page*) leafPages.allocate(tdbb, &leafLevel->window);
 		bucket->btr_header.pag_type = pag_index;
 		bucket->btr_relation = relation->rel_id;
 		bucket->btr_id = (UCHAR)(idx->idx_id % 256);
@@ -3919,6 +4195,16 @@ static ULONG fast_load(thread_db* tdbb,
 				// mark the end of the previous page
 				const RecordNumber lastRecordNumber = previousNode.recordNumber;
 				previousNode.readNode(previousNode.nodePointer, true);
+
+				// Propagate the shortest key that still separates pages, see insert_node()
+				USHORT splitKeyLength = leafKey->key_length;
+				if (!descending && previousNode.length > 1 &&
+					previousNode.nodePointer != bucket->btr_nodes)
+				{
+					previousNode.length = 1;
+					splitKeyLength = previousNode.prefix + previousNode.length;
+				}
+
 				previousNode.setEndBucket();
 				pointer = previousNode.writeNode(previousNode.nodePointer, true, false);
 				bucket->btr_length = pointer - (UCHAR*) bucket;
@@ -3957,7 +4243,7 @@ static ULONG fast_load(thread_db* tdbb,
 					BUGCHECK(205);	// msg 205 index bucket overfilled
 
 				// Allocate new bucket.
-				btree_page* split = (btree_page*) DPM_allocate(tdbb, &split_window);
+				btree_page* split = (btree_page*) leafPages.allocate(tdbb, &split_window);
 				bucket->btr_sibling = split_window.win_page.getPageNum();
 				split->btr_left_sibling = leafLevel->window.win_page.getPageNum();
 				split->btr_header.pag_type = pag_index;
@@ -4007,6 +4293,7 @@ static ULONG fast_load(thread_db* tdbb,
 
 				// save the first key on page as the page to be propagated
 				copy_key(leafKey, &split_key);
+				split_key.key_length = splitKeyLength;
 
 				// Clear jumplist.
 				IndexJumpNode* walkJumpNode = leafJumpNodes->begin();
@@ -4455,6 +4742,9 @@ static ULONG fast_load(thread_db* tdbb,
 #endif
 		}
 
+		// Release leaf pages allocated but not used
+		leafPages.release(tdbb, pageSpaceID);
+
 		// Finally clean up dynamic memory used.
 		for (unsigned i = 0; i < levels.getCount(); i++)
 		{
@@ -4510,6 +4800,8 @@ static ULONG fast_load(thread_db* tdbb,
 				CCH_RELEASE(tdbb, &levels[i].window);
 		}
 
+		leafPages.release(tdbb, pageSpaceID);
+
 		if (window)
 		{
 			delete_tree(tdbb, relation->rel_id, idx->idx_id,
@@ -4588,7 +4880,7 @@ static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key,
 	const UCHAR* p = key->key_data + prefix;
 
 	IndexNode node;
-	pointer = node.readNode(pointer, leafPage);
+	pointer = node.readNodeKey(pointer, leafPage);
 
 	// Check if pointer is still valid
 	if (pointer > endPointer)
@@ -4604,7 +4896,7 @@ static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key,
 	if (!leafPage && descending &&
 		(node.nodePointer == bucket->btr_nodes + bucket->btr_jump_size) && (node.length == 0))
 	{
-		pointer = node.readNode(pointer, leafPage);
+		pointer = node.readNodeKey(pointer, leafPage);
 
 		// Check if pointer is still valid
 		if (pointer > endPointer)
@@ -4661,17 +4953,14 @@ static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key,
 			else if (node.length > 0 || firstPass)
 			{
 				firstPass = false;
-				while (true)
-				{
-					if (p == key_end)
-						goto done;
 
-					if (q == nodeEnd || *p > *q)
-						break;
+				const USHORT equal = commonLength(p, q, MIN(key_end - p, nodeEnd - q));
+				p += equal;
+				q += equal;
 
-					if (*p++ < *q++)
-						goto done;
-				}
+				// Either the key is over or its next byte is less than the node one
+				if (p == key_end || (q < nodeEnd && *p < *q))
+					goto done;
 			}
 			prefix = (USHORT)(p - key->key_data);
 		}
@@ -4692,7 +4981,7 @@ static UCHAR* find_node_start_point(btree_page* bucket, temporary_key* key,
 			return NULL;
 		}
 
-		pointer = node.readNode(pointer, leafPage);
+		pointer = node.readNodeKey(pointer, leafPage);
 
 		// Check if pointer is still valid
 		if (pointer > endPointer)
@@ -4847,62 +5136,56 @@ static UCHAR* find_area_start_point(btree_page* bucket, const temporary_key* key
 		}
 		else if (jumpNode.prefix <= testPrefix)
 		{
-			while (true)
+			const USHORT equal = commonLength(keyPointer, q, MIN(keyEnd - keyPointer, nodeEnd - q));
+			keyPointer += equal;
+			q += equal;
+
+			if (keyPointer == keyEnd)
 			{
-				if (keyPointer == keyEnd)
+				// Reached end of our key we're searching for.
+				done = true;
+				// Check if this is a exact match or a duplicate
+				// If the node is pointing to its end and the length is
+				// the same as the key then we have found a exact match.
+				// Now start walking between the jump nodes until we
+				// found a node reference that's not equal anymore
+				// or the record number is higher then the one we need.
+				if (useFindRecordNumber && q == nodeEnd)
 				{
-					// Reached end of our key we're searching for.
-					done = true;
-					// Check if this is a exact match or a duplicate
-					// If the node is pointing to its end and the length is
-					// the same as the key then we have found a exact match.
-					// Now start walking between the jump nodes until we
-					// found a node reference that's not equal anymore
-					// or the record number is higher then the one we need.
-					if (useFindRecordNumber && q == nodeEnd)
+					n--;
+					while (n)
 					{
-						n--;
-						while (n)
+						if (find_record_number <= node.recordNumber)
 						{
-							if (find_record_number <= node.recordNumber)
-							{
-								// If the record number from leaf is higer
-								// then we should be in our previous area.
-								break;
-							}
-							// Calculate new prefix to return right prefix.
-							prefix = jumpNode.length + jumpNode.prefix;
-
-							prevJumpNode = jumpNode;
-							pointer = jumpNode.readJumpNode(pointer);
-							node.readNode((UCHAR*) bucket + jumpNode.offset, leafPage);
-
-							if (node.length != 0 ||
-								node.prefix != prevJumpNode.prefix + prevJumpNode.length ||
-								jumpNode.prefix != prevJumpNode.prefix + prevJumpNode.length ||
-								node.isEndBucket || node.isEndLevel)
-							{
-								break;
-							}
-
-							n--;
+							// If the record number from leaf is higer
+							// then we should be in our previous area.
+							break;
 						}
-					}
-					break;
-				}
+						// Calculate new prefix to return right prefix.
+						prefix = jumpNode.length + jumpNode.prefix;
 
-				if (q == nodeEnd)	// End of node data reached
-					break;
+						prevJumpNode = jumpNode;
+						pointer = jumpNode.readJumpNode(pointer);
+						node.readNode((UCHAR*) bucket + jumpNode.offset, leafPage);
 
-				if (*keyPointer > *q)	// Our key is bigger so check next node.
-					break;
+						if (node.length != 0 ||
+							node.prefix != prevJumpNode.prefix + prevJumpNode.length ||
+							jumpNode.prefix != prevJumpNode.prefix + prevJumpNode.length ||
+							node.isEndBucket || node.isEndLevel)
+						{
+							break;
+						}
 
-				if (*keyPointer++ < *q++)
-				{
-					done = true;
-					break;
+						n--;
+					}
 				}
 			}
+			else if (q < nodeEnd && *keyPointer < *q)
+			{
+				// Our key is less than the node, otherwise check next node.
+				keyPointer++;
+				done = true;
+			}
 
 			testPrefix = (USHORT)(keyPointer - key->key_data);
 		}
@@ -5059,27 +5342,25 @@ static ULONG find_page(btree_page* bucket, const temporary_key* key,
 			{
 				firstPass = false;
 				// Ascending index
-				while (true)
+				const USHORT equal = commonLength(p, q, MIN(keyEnd - p, nodeEnd - q));
+				p += equal;
+				q += equal;
+
+				if (p == keyEnd)
 				{
-					if (p == keyEnd)
+					// Check for exact match and if we need to do
+					// record number matching.
+					if (find_record_number != NO_VALUE && q == nodeEnd)
 					{
-						// Check for exact match and if we need to do
-						// record number matching.
-						if (find_record_number != NO_VALUE && q == nodeEnd)
-						{
-							return IndexNode::findPageInDuplicates(bucket,
-								node.nodePointer, previousNumber, find_record_number);
-						}
-
-						return previousNumber;
+						return IndexNode::findPageInDuplicates(bucket,
+							node.nodePointer, previousNumber, find_record_number);
 					}
 
-					if (q == nodeEnd || *p > *q)
-						break;
-
-					if (*p++ < *q++)
-						return previousNumber;
+					return previousNumber;
 				}
+
+				if (q < nodeEnd && *p < *q)
+					return previousNumber;
 			}
 		}
 		prefix = p - key->key_data;
@@ -5762,7 +6043,8 @@ static ULONG insert_node(thread_db* tdbb,
 						 temporary_key* new_key,
 						 RecordNumber* new_record_number,
 						 ULONG* original_page,
-						 ULONG* sibling_page)
+						 ULONG* sibling_page,
+						 bool* full)
 {
 /**************************************
  *
@@ -5775,6 +6057,8 @@ static ULONG insert_node(thread_db* tdbb,
  *  If this isn't the right bucket, return NO_VALUE.
  *  If it splits, return the split page number and
  *	leading string.  This is the workhorse for add_node.
+ *  If the full flag is passed, the bucket is never split,
+ *  the flag is set instead and NO_SPLIT is returned.
  *
  **************************************/
 
@@ -6082,6 +6366,23 @@ static ULONG insert_node(thread_db* tdbb,
 		return NO_SPLIT;
 	}
 
+	if (full)
+	{
+		if (fragmentedOffset)
+		{
+			IndexJumpNode* walkJumpNode = jumpNodes->begin();
+			for (size_t i = 0; i < jumpNodes->getCount(); i++)
+				delete[] walkJumpNode[i].data;
+		}
+
+		jumpNodes->clear();
+
+		CCH_RELEASE(tdbb, window);
+		*full = true;
+
+		return NO_SPLIT;
+	}
+
 	// We've a bucket split in progress.  We need to determine the split point.
 	// Set it halfway through the page, unless we are at the end of the page,
 	// in which case put only the new node on the new page.  This will ensure
@@ -6288,6 +6589,18 @@ static ULONG insert_node(thread_db* tdbb,
 	// back to the original buffer.  After cleaning up the last node,
 	// we're done!
 
+	// The upper level needs just a key that is greater than the last node on
+	// the original page and not greater than the first node on the split page,
+	// i.e. the first node key cut right after the prefix it shares with the
+	// previous node. Shorter keys make pointer pages hold more nodes and keep the
+	// tree lower. In descending index a shorter key goes after the longer one,
+	// so the whole key is propagated there.
+	if (leafPage && !(idx->idx_flags & idx_descending) && node.length > 1)
+	{
+		node.length = 1;
+		new_key->key_length = node.prefix + node.length;
+	}
+
 	// mark the end of the page; note that the end_bucket marker must
 	// contain info about the first node on the next page. So we don't
 	// overwrite the existing data.
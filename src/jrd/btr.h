@@ -46,10 +46,12 @@ template <typename T> class vec;
 class Statement;
 struct temporary_key;
 class thread_db;
+class IndexHistogram;
 class BtrPageGCLock;
 class Sort;
 class PartitionedSort;
 struct sort_key_def;
+struct win;
 
 // Index descriptor block -- used to hold info from index root page
 
@@ -72,6 +74,7 @@ struct index_desc
 	BoolExprNode* idx_condition;			// node tree for index condition
 	Statement* idx_condition_statement;		// stored statement for index condition
 	float idx_fraction;						// fraction of keys included in the index
+	const IndexHistogram* idx_histogram;	// distribution of leading segment keys (optimizer only)
 	// This structure should exactly match IRTD structure for current ODS
 	struct idx_repeat
 	{
@@ -288,6 +291,28 @@ private:
 #endif
 };
 
+// Insertion of keys sorted in the index order. The leaf page the last key was inserted
+// into is remembered and protected from garbage collection, the next key is inserted
+// there (or into the right siblings) without descending from the index root, as long
+// as the leaf page has room for it.
+
+class BtrSortedInsert
+{
+public:
+	explicit BtrSortedInsert(thread_db* tdbb);
+	~BtrSortedInsert();
+
+	void insert(thread_db* tdbb, win* root_window, index_insertion* insertion);
+
+private:
+	void releaseLeaf(thread_db* tdbb);
+
+	BtrPageGCLock m_leafLock;
+	ULONG m_leafPage;
+	temporary_key m_lastKey;
+	RecordNumber m_lastNumber;
+};
+
 // Struct used for index creation
 
 struct IndexCreation
@@ -51,7 +51,8 @@ void	BTR_make_null_key(Jrd::thread_db*, const Jrd::index_desc*, Jrd::temporary_k
 bool	BTR_next_index(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::jrd_tra*, Jrd::index_desc*, Jrd::win*);
 void	BTR_remove(Jrd::thread_db*, Jrd::win*, Jrd::index_insertion*);
 void	BTR_reserve_slot(Jrd::thread_db*, Jrd::IndexCreation&);
-void	BTR_selectivity(Jrd::thread_db*, Jrd::jrd_rel*, USHORT, Jrd::SelectivityList&);
+void	BTR_selectivity(Jrd::thread_db*, Jrd::jrd_rel*, USHORT, Jrd::SelectivityList&,
+	Jrd::IndexHistogram* = nullptr);
 bool	BTR_types_comparable(const dsc& target, const dsc& source);
 
 #endif // JRD_BTR_PROTO_H
@@ -58,22 +58,13 @@
 #include "../common/ThreadStart.h"
 #include "../jrd/tra_proto.h"
 #include "../common/config/config.h"
+#include "../common/os/os_utils.h"
 #include "../common/classes/ClumpletWriter.h"
 #include "../common/classes/MsgPrint.h"
 #include "../jrd/CryptoManager.h"
 #include "../common/utils_proto.h"
 #include "../jrd/PageToBufferMap.h"
-
-#ifndef CDS_UNAVAILABLE
-// Use lock-free lists in hash table implementation
-#define HASH_USE_CDS_LIST
-#endif
-
-
-#ifdef HASH_USE_CDS_LIST
-#include <cds/container/michael_kvlist_dhp.h>
-#include "../jrd/InitCDSLib.h"
-#endif
+#include "../jrd/BCBHashTable.h"
 
 
 using namespace Jrd;
@@ -126,7 +117,7 @@ enum LatchState
 	lsPageChanged
 };
 
-static void adjust_scan_count(WIN* window, bool mustRead);
+static void adjust_scan_count(thread_db* tdbb, WIN* window, bool mustRead);
 static int blocking_ast_bdb(void*);
 #ifdef CACHE_READER
 static void prefetch_epilogue(Prefetch*, FbStatusVector *);
@@ -139,11 +130,14 @@ static void check_precedence(thread_db*, WIN*, PageNumber);
 static void clear_precedence(thread_db*, BufferDesc*);
 static void down_grade(thread_db*, BufferDesc*, int high = 0);
 static bool expand_buffers(thread_db*, ULONG);
+static ULONG allocate_buffers(thread_db*, BufferControl*, ULONG);
 static BufferDesc* get_buffer(thread_db*, const PageNumber, SyncType, int);
+static CachePartition* get_partition(BufferControl*, const PageNumber&);
 static int get_related(BufferDesc*, PagesArray&, int, const ULONG);
 static ULONG get_prec_walk_mark(BufferControl*);
 static LockState lock_buffer(thread_db*, BufferDesc*, const SSHORT, const SCHAR);
-static ULONG memory_init(thread_db*, BufferControl*, ULONG);
+static void init_partitions(thread_db*, BufferControl*, ULONG);
+static ULONG memory_init(thread_db*, BufferControl*, CachePartition*, ULONG);
 static void page_validation_error(thread_db*, win*, SSHORT);
 static void purgePrecedence(BufferControl*, BufferDesc*);
 static SSHORT related(BufferDesc*, const BufferDesc*, SSHORT, const ULONG);
@@ -154,6 +148,7 @@ static bool set_diff_page(thread_db*, BufferDesc*);
 static void clear_dirty_flag_and_nbak_state(thread_db*, BufferDesc*);
 
 static BufferDesc* get_dirty_buffer(thread_db*);
+static bool read_queued_pages(thread_db*, BufferControl*);
 
 
 static inline void insertDirty(BufferControl* bcb, BufferDesc* bdb)
@@ -194,7 +189,7 @@ static void flushAll(thread_db* tdbb, USHORT flush_flag);
 static void flushPages(thread_db* tdbb, USHORT flush_flag, BufferDesc** begin, FB_SIZE_T count);
 
 static void recentlyUsed(BufferDesc* bdb);
-static void requeueRecentlyUsed(BufferControl* bcb);
+static void requeueRecentlyUsed(CachePartition* partition);
 
 
 constexpr ULONG MIN_BUFFER_SEGMENT = 65536;
@@ -210,80 +205,205 @@ constexpr int PRE_UNKNOWN		= -2;
 namespace Jrd
 {
 
-#ifdef HASH_USE_CDS_LIST
+// Classic LRU: referenced buffers are moved to the head of single que
 
-template <typename T>
-class ListNodeAllocator
+class LruReplacement : public PageReplacement
 {
 public:
-	typedef T value_type;
+	explicit LruReplacement(CachePartition* partition)
+		: PageReplacement(partition)
+	{}
 
-	ListNodeAllocator() {};
+	const char* getName() const override
+	{
+		return PageReplacementLRU;
+	}
 
-	template <class U>
-	constexpr ListNodeAllocator(const ListNodeAllocator<U>&) noexcept {}
+	void assigned(BufferDesc* bdb) override
+	{
+		referenced(bdb);
+	}
 
-	T* allocate(std::size_t n);
-	void deallocate(T* p, std::size_t n);
+	void referenced(BufferDesc* bdb) override
+	{
+		QUE_DELETE(bdb->bdb_in_use);
+		QUE_INSERT(m_partition->cp_in_use, bdb->bdb_in_use);
+	}
 
-private:
-};
+	void released(BufferDesc* bdb) override
+	{
+		QUE_DELETE(bdb->bdb_in_use);
+		QUE_APPEND(m_partition->cp_in_use, bdb->bdb_in_use);
+	}
 
-struct BdbTraits : public cds::container::michael_list::traits
-{
-	typedef ListNodeAllocator<int> allocator;
-	//typedef std::less<PageNumber> compare;
-};
+	void removed(BufferDesc* bdb) override
+	{
+		QUE_DELETE(bdb->bdb_in_use);
+		QUE_INIT(bdb->bdb_in_use);
+	}
 
-typedef cds::container::MichaelKVList<cds::gc::DHP, PageNumber, BufferDesc*, BdbTraits> BdbList;
+	unsigned getVictimQues(que** ques) override
+	{
+		ques[0] = &m_partition->cp_in_use;
+		return 1;
+	}
+};
 
-#endif // HASH_USE_CDS_LIST
 
+// Simplified 2Q: buffers with new pages are put into probation que (FIFO) and
+// move into main LRU que (cp_in_use) when referenced again after correlated
+// references period, i.e. when half of probation que was read after them.
+// Pages of system types (index, pointer, etc) are moved into main que on first
+// repeated reference. While probation que holds more than a quarter of partition
+// buffers, victims are looked for there first, thus large scans can't flush main
+// que.
 
-class BCBHashTable
+class TwoQueueReplacement : public PageReplacement
 {
-#ifdef HASH_USE_CDS_LIST
-	using chain_type = BdbList;
-#else
-	using chain_type = que;
-#endif
-
 public:
-	BCBHashTable(MemoryPool& pool, ULONG count) :
-		m_pool(pool),
-		m_count(0),
-		m_chains(nullptr)
+	explicit TwoQueueReplacement(CachePartition* partition)
+		: PageReplacement(partition),
+		  m_probationCount(0)
+	{
+		QUE_INIT(m_probation);
+	}
+
+	const char* getName() const override
 	{
-		resize(count);
+		return PageReplacement2Q;
 	}
 
-	~BCBHashTable()
+	void assigned(BufferDesc* bdb) override
 	{
-		clear();
+		QUE_DELETE(bdb->bdb_in_use);
+		QUE_INSERT(m_probation, bdb->bdb_in_use);
+		setProbation(bdb);
+	}
+
+	void referenced(BufferDesc* bdb) override
+	{
+		if (bdb->bdb_flags & BDB_lru_probation)
+		{
+			if (!promote(bdb))
+				return;
+
+			bdb->bdb_flags &= ~BDB_lru_probation;
+			m_probationCount--;
+		}
+
+		QUE_DELETE(bdb->bdb_in_use);
+		QUE_INSERT(m_partition->cp_in_use, bdb->bdb_in_use);
+	}
+
+	void released(BufferDesc* bdb) override
+	{
+		QUE_DELETE(bdb->bdb_in_use);
+		QUE_APPEND(m_probation, bdb->bdb_in_use);
+		setProbation(bdb);
 	}
 
-	void resize(ULONG count);
-	void clear();
+	void removed(BufferDesc* bdb) override
+	{
+		QUE_DELETE(bdb->bdb_in_use);
+		QUE_INIT(bdb->bdb_in_use);
+
+		if (bdb->bdb_flags & BDB_lru_probation)
+		{
+			bdb->bdb_flags &= ~BDB_lru_probation;
+			m_probationCount--;
+		}
+	}
 
-	BufferDesc* find(const PageNumber& page) const;
+	unsigned getVictimQues(que** ques) override
+	{
+		const bool probationFirst = (m_probationCount > probationSize());
 
-	// tries to put bdb into hash slot by page
-	// if succeed, removes bdb from old slot, if necessary, and returns NULL
-	// else, returns BufferDesc that is currently occupies target slot
-	BufferDesc* emplace(BufferDesc* bdb, const PageNumber& page, bool remove);
+		ques[probationFirst ? 0 : 1] = &m_probation;
+		ques[probationFirst ? 1 : 0] = &m_partition->cp_in_use;
+		return 2;
+	}
 
-	void remove(BufferDesc* bdb);
 private:
-	ULONG hash(const PageNumber& pageno) const
+	ULONG probationSize() const
+	{
+		return m_partition->cp_count / 4;
+	}
+
+	void setProbation(BufferDesc* bdb)
+	{
+		if (!(bdb->bdb_flags & BDB_lru_probation))
+		{
+			bdb->bdb_flags |= BDB_lru_probation;
+			m_probationCount++;
+		}
+	}
+
+	bool promote(const BufferDesc* bdb) const
 	{
-		return pageno.getPageNum() % m_count;
+		// page is not read yet, nothing to judge by
+		if (bdb->bdb_flags & BDB_read_pending)
+			return false;
+
+		switch (bdb->bdb_buffer->pag_type)
+		{
+		case pag_header:
+		case pag_pages:
+		case pag_transactions:
+		case pag_pointer:
+		case pag_root:
+		case pag_index:
+		case pag_ids:
+		case pag_scns:
+			return true;
+		}
+
+		// incarnation counter is common for all partitions, so compare it
+		// with the probation size of the whole cache
+		const BufferControl* const bcb = m_partition->cp_bcb;
+		return (bcb->bcb_page_incarnation - bdb->bdb_incarnation > bcb->bcb_count / 8);
 	}
 
-	MemoryPool& m_pool;
-	ULONG m_count;
-	chain_type* m_chains;
+	que m_probation;
+	ULONG m_probationCount;
 };
 
+
+PageReplacement* PageReplacement::create(MemoryPool& pool, CachePartition* partition, const char* name)
+{
+	if (name && NoCaseString(name) == PageReplacement2Q)
+		return FB_NEW_POOL(pool) TwoQueueReplacement(partition);
+
+	return FB_NEW_POOL(pool) LruReplacement(partition);
+}
+
+PageReplacement::Counters& PageReplacement::getCounters()
+{
+	unsigned cpu, node;
+	os_utils::getCurrentCpu(cpu, node);
+
+	return m_counters[cpu % COUNTER_SHARDS];
+}
+
+FB_UINT64 PageReplacement::getHits() const
+{
+	FB_UINT64 hits = 0;
+
+	for (const auto& counters : m_counters)
+		hits += counters.hits.load(std::memory_order_relaxed);
+
+	return hits;
+}
+
+FB_UINT64 PageReplacement::getMisses() const
+{
+	FB_UINT64 misses = 0;
+
+	for (const auto& counters : m_counters)
+		misses += counters.misses.load(std::memory_order_relaxed);
+
+	return misses;
+}
+
 }
 
 
@@ -351,14 +471,14 @@ void CCH_clean_page(thread_db* tdbb, PageNumber page)
 	}
 
 	{
-		Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
+		CachePartition* const partition = bdb->bdb_partition;
+		Sync lruSync(&partition->cp_syncLRU, "CCH_release");
 		lruSync.lock(SYNC_EXCLUSIVE);
 
 		if (bdb->bdb_flags & BDB_lru_chained)
-			requeueRecentlyUsed(bcb);
+			requeueRecentlyUsed(partition);
 
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+		partition->cp_replacement->released(bdb);
 	}
 
 	bdb->release(tdbb, true);
@@ -756,7 +876,7 @@ pag* CCH_fake(thread_db* tdbb, WIN* window, int wait)
 	fb_assert((bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) == 0);
 	fb_assert(bdb->bdb_page == window->win_page);
 
-	bdb->bdb_flags &= BDB_lru_chained;	// yes, clear all except BDB_lru_chained
+	bdb->bdb_flags &= BDB_lru_state;	// yes, clear all except LRU state
 	bdb->bdb_flags |= (BDB_writer | BDB_faked);
 	bdb->bdb_scan_count = 0;
 
@@ -825,7 +945,7 @@ pag* CCH_fetch(thread_db* tdbb, WIN* window, int lock_type, SCHAR page_type, int
 		break;
 	}
 
-	adjust_scan_count(window, lockState == lsLocked);
+	adjust_scan_count(tdbb, window, lockState == lsLocked);
 
 	// Validate the fetched page matches the expected type
 
@@ -1109,11 +1229,13 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 
 	removeDirty(bcb, bdb);
 
+	CachePartition* const partition = bdb->bdb_partition;
+
 	// remove from LRU list
 	{
-		SyncLockGuard lruSync(&bcb->bcb_syncLRU, SYNC_EXCLUSIVE, FB_FUNCTION);
-		requeueRecentlyUsed(bcb);
-		QUE_DELETE(bdb->bdb_in_use);
+		SyncLockGuard lruSync(&partition->cp_syncLRU, SYNC_EXCLUSIVE, FB_FUNCTION);
+		requeueRecentlyUsed(partition);
+		partition->cp_replacement->removed(bdb);
 	}
 
 	// remove from hash table and put into empty list
@@ -1121,16 +1243,16 @@ void CCH_forget_page(thread_db* tdbb, WIN* window)
 	{
 		SyncLockGuard bcbSync(&bcb->bcb_syncObject, SYNC_EXCLUSIVE, FB_FUNCTION);
 		bcb->bcb_hashTable->remove(bdb);
-		QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
-		bcb->bcb_inuse--;
+		QUE_INSERT(partition->cp_empty, bdb->bdb_que);
+		partition->cp_inuse--;
 	}
 #else
 	bcb->bcb_hashTable->remove(bdb);
 
 	{
-		SyncLockGuard syncEmpty(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
-		QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
-		bcb->bcb_inuse--;
+		SyncLockGuard syncEmpty(&partition->cp_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+		QUE_INSERT(partition->cp_empty, bdb->bdb_que);
+		partition->cp_inuse--;
 	}
 #endif
 
@@ -1165,6 +1287,14 @@ void CCH_fini(thread_db* tdbb)
 
 	delete bcb->bcb_hashTable;
 
+	for (auto partition : bcb->bcb_partitions)
+	{
+		delete partition->cp_replacement;
+		delete partition;
+	}
+
+	bcb->bcb_partitions.clear();
+
 	for (auto blk : bcb->bcb_bdbBlocks)
 	{
 		for (ULONG i = 0; i < blk.m_count; i++)
@@ -1541,7 +1671,7 @@ pag* CCH_handoff(thread_db*	tdbb, WIN* window, ULONG page, int lock, SCHAR page_
 			bdb->downgrade(SYNC_SHARED);
 	}
 
-	adjust_scan_count(window, must_read == lsLocked);
+	adjust_scan_count(tdbb, window, must_read == lsLocked);
 
 	// Validate the fetched page matches the expected type
 
@@ -1613,15 +1743,14 @@ void CCH_init(thread_db* tdbb, ULONG number)
 	bcb->bcb_flags = shared ? BCB_exclusive : 0;
 	//bcb->bcb_flags = BCB_exclusive;	// TODO detect real state using LM
 
-	QUE_INIT(bcb->bcb_in_use);
 	QUE_INIT(bcb->bcb_dirty);
 	bcb->bcb_dirty_count = 0;
-	QUE_INIT(bcb->bcb_empty);
+
+	init_partitions(tdbb, bcb, number);
 
 	// initialization of memory is system-specific
 
-	bcb->bcb_count = memory_init(tdbb, bcb, number);
-	bcb->bcb_free_minimum = (SSHORT) MIN(bcb->bcb_count / 4, 128);
+	allocate_buffers(tdbb, bcb, number);
 
 	if (bcb->bcb_count < MIN_PAGE_BUFFERS)
 		ERR_post(Arg::Gds(isc_cache_too_small));
@@ -1856,6 +1985,185 @@ void CCH_precedence(thread_db* tdbb, WIN* window, PageNumber page)
 }
 
 
+ULONG CCH_prefetch(thread_db* tdbb, USHORT pageSpaceId, const ULONG* pages, ULONG count)
+{
+/**************************************
+ *
+ *	C C H _ p r e f e t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read given pages into the page cache using a single batch
+ *	request to the physical I/O layer. Pages already cached, or
+ *	pages which can't be latched or locked immediately, are skipped.
+ *	Nothing guarantees the pages will stay in cache until fetched,
+ *	this is just a way to not wait for every page read separately.
+ *	Called by cache writer for pages queued by CCH_queue_prefetch().
+ *	Return the number of pages read from disk.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	// Don't let a single batch take over the significant part of the page cache
+
+	count = MIN(count, MIN(PREFETCH_BATCH_PAGES, bcb->bcb_count / 4));
+	if (count < 2)
+		return 0;
+
+	const auto pageSpace = dbb->dbb_page_manager.findPageSpace(pageSpaceId);
+	fb_assert(pageSpace);
+
+	// When the database is in backup mode the page could reside in the
+	// difference file, let CCH_fetch_page handle such cases
+
+	BackupManager::StateReadGuard stateGuard(tdbb);
+	if (!pageSpace->isTemporary() && dbb->dbb_backup_manager->getState() != Ods::hdr_nbak_normal)
+		return 0;
+
+	win_for_array windows[PREFETCH_BATCH_PAGES];
+	BufferDesc* bdbs[PREFETCH_BATCH_PAGES];
+	ULONG batch = 0;
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		WIN& window = windows[batch];
+		window.win_page = PageNumber(pageSpaceId, pages[i]);
+
+		switch (CCH_fetch_lock(tdbb, &window, LCK_read, LCK_NO_WAIT, pag_undefined))
+		{
+		case lsLocked:
+			bdbs[batch++] = window.win_bdb;
+			break;
+
+		case lsLockedHavePage:
+			CCH_RELEASE(tdbb, &window);
+			break;
+
+		default:
+			// somebody else works with the page, let it be
+			break;
+		}
+	}
+
+	if (!batch)
+		return 0;
+
+	// Pages were read into the buffers already, CryptoManager needs just to
+	// decrypt them. If it asks for the page again, read it the usual way.
+
+	class PrefetchIO : public CryptoManager::IOCallback
+	{
+	public:
+		PrefetchIO(jrd_file* f, BufferDesc* b)
+			: file(f), bdb(b), first(true)
+		{ }
+
+		bool callback(thread_db* tdbb, FbStatusVector* status, Ods::pag* page)
+		{
+			if (first && page == bdb->bdb_buffer)
+			{
+				first = false;
+				return true;
+			}
+
+			return PIO_read(tdbb, file, bdb, page, status);
+		}
+
+	private:
+		jrd_file* file;
+		BufferDesc* bdb;
+		bool first;
+	};
+
+	FbLocalStatus status;
+	const bool done = PIO_read_pages(tdbb, pageSpace->file, bdbs, batch, &status);
+
+	ULONG read = 0;
+	for (ULONG i = 0; i < batch; i++)
+	{
+		BufferDesc* const bdb = bdbs[i];
+		PrefetchIO io(pageSpace->file, bdb);
+
+		if (done && dbb->dbb_crypto_manager->read(tdbb, &status, bdb->bdb_buffer, &io))
+		{
+			bdb->bdb_incarnation = ++bcb->bcb_page_incarnation;
+			tdbb->bumpStats(PageStatType::READS, pageSpaceId);
+			tdbb->bumpStats(PageStatType::PREFETCHES, pageSpaceId);
+
+			bdb->bdb_flags &= ~(BDB_not_valid | BDB_read_pending);
+			bdb->bdb_flags |= BDB_prefetch;
+			read++;
+		}
+		else
+		{
+			// Leave the buffer marked as read pending, the page will be read
+			// (and the error, if any, reported) when it is fetched next time
+
+			PAGE_LOCK_RELEASE(tdbb, bcb, bdb->bdb_lock);
+		}
+
+		CCH_RELEASE(tdbb, &windows[i]);
+	}
+
+	return read;
+}
+
+
+ULONG CCH_queue_prefetch(thread_db* tdbb, USHORT pageSpaceId, const ULONG* pages, ULONG count)
+{
+/**************************************
+ *
+ *	C C H _ q u e u e _ p r e f e t c h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Ask cache writer to read given pages into the page cache,
+ *	so the caller doesn't wait for the reads while it holds
+ *	latches. Pages found in cache are not queued, pages not
+ *	fitting into the queue are dropped. Return the number of
+ *	pages queued, zero if there is no cache writer to read them.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	BufferControl* const bcb = dbb->dbb_bcb;
+
+	if (!(bcb->bcb_flags & BCB_cache_writer))
+		return 0;
+
+	HalfStaticArray<PageNumber, PREFETCH_BATCH_PAGES> missing;
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		const PageNumber page(pageSpaceId, pages[i]);
+		if (!bcb->bcb_hashTable->find(page))
+			missing.add(page);
+	}
+
+	if (missing.isEmpty())
+		return 0;
+
+	{	// scope
+		MutexLockGuard guard(bcb->bcb_prefetch_mutex, FB_FUNCTION);
+
+		const FB_SIZE_T room = PREFETCH_QUEUE_PAGES - bcb->bcb_prefetch_queue.getCount();
+		if (missing.getCount() > room)
+			missing.shrink(room);
+
+		bcb->bcb_prefetch_queue.add(missing.begin(), missing.getCount());
+	}
+
+	if (missing.hasData() && !(bcb->bcb_flags & BCB_writer_active))
+		bcb->bcb_writer_sem.release();
+
+	return missing.getCount();
+}
+
+
 #ifdef CACHE_READER
 void CCH_prefetch(thread_db* tdbb, SLONG* pages, SSHORT count)
 {
@@ -2126,17 +2434,17 @@ void CCH_release(thread_db* tdbb, WIN* window, const bool release_tail)
 				if (window->win_flags & WIN_garbage_collector)
 					bdb->bdb_flags &= ~BDB_garbage_collect;
 
-				{ // bcb_syncLRU scope
-					Sync lruSync(&bcb->bcb_syncLRU, "CCH_release");
+				{ // cp_syncLRU scope
+					CachePartition* const partition = bdb->bdb_partition;
+					Sync lruSync(&partition->cp_syncLRU, "CCH_release");
 					lruSync.lock(SYNC_EXCLUSIVE);
 
 					if (bdb->bdb_flags & BDB_lru_chained)
 					{
-						requeueRecentlyUsed(bcb);
+						requeueRecentlyUsed(partition);
 					}
 
-					QUE_DELETE(bdb->bdb_in_use);
-					QUE_APPEND(bcb->bcb_in_use, bdb->bdb_in_use);
+					partition->cp_replacement->released(bdb);
 				}
 
 				if ((bcb->bcb_flags & BCB_cache_writer) &&
@@ -2544,7 +2852,7 @@ bool CCH_write_all_shadows(thread_db* tdbb, Shadow* shadow, BufferDesc* bdb, Ods
 }
 
 
-static void adjust_scan_count(WIN* window, bool mustRead)
+static void adjust_scan_count(thread_db* tdbb, WIN* window, bool mustRead)
 {
 /**************************************
  *
@@ -2561,9 +2869,16 @@ static void adjust_scan_count(WIN* window, bool mustRead)
 	// Otherwise zero the buffer scan count to prevent the buffer
 	// from being queued to the LRU tail.
 
+	if (bdb->bdb_flags & BDB_prefetch)
+	{
+		bdb->bdb_flags &= ~BDB_prefetch;
+		tdbb->bumpStats(PageStatType::PREFETCH_HITS, bdb->bdb_page.getPageSpaceID());
+		mustRead = true;
+	}
+
 	if (window->win_flags & WIN_large_scan)
 	{
-		if (mustRead || (bdb->bdb_flags & BDB_prefetch) || bdb->bdb_scan_count < 0)
+		if (mustRead || bdb->bdb_scan_count < 0)
 			bdb->bdb_scan_count = window->win_scans;
 	}
 	else if (window->win_flags & WIN_garbage_collector)
@@ -3098,6 +3413,11 @@ void BufferControl::cache_writer(BufferControl* bcb)
 
 				if ((bcb->bcb_flags & BCB_free_pending) || dbb->dbb_flush_cycle)
 					JRD_reschedule(tdbb, true);
+				else if (read_queued_pages(tdbb, bcb))
+				{
+					attachment->mergeStats();
+					JRD_reschedule(tdbb, true);
+				}
 #ifdef CACHE_READER
 				else if (SBM_next(bcb->bcb_prefetch, &starting_page, RSE_get_forward))
 				{
@@ -3600,129 +3920,252 @@ static bool expand_buffers(thread_db* tdbb, ULONG number)
 	if ((tdbb->getAttachment()->att_flags & ATT_exclusive) || !(bcb->bcb_flags & BCB_exclusive))
 		bcb->bcb_hashTable->resize(number);
 
-	SyncLockGuard syncEmpty(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
-	ULONG allocated = memory_init(tdbb, bcb, number - bcb->bcb_count);
-
-	bcb->bcb_count += allocated;
-	bcb->bcb_free_minimum = (SSHORT) MIN(bcb->bcb_count / 4, 128);	// 25% clean page reserve
+	allocate_buffers(tdbb, bcb, number - bcb->bcb_count);
 
 	return true;
 }
 
 
-static BufferDesc* get_dirty_buffer(thread_db* tdbb)
+static ULONG allocate_buffers(thread_db* tdbb, BufferControl* bcb, ULONG number)
 {
-	// This code is only used by the background I/O threads:
-	// cache writer, cache reader and garbage collector.
+/**************************************
+ *
+ *	a l l o c a t e _ b u f f e r s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Allocate given number of buffers spreading them
+ *	evenly over the cache partitions.
+ *	Return number of buffers allocated.
+ *
+ **************************************/
+	const FB_SIZE_T count = bcb->bcb_partitions.getCount();
+	ULONG allocated = 0;
 
-	SET_TDBB(tdbb);
-	Database* dbb = tdbb->getDatabase();
-	BufferControl* bcb = dbb->dbb_bcb;
-	int walk = bcb->bcb_free_minimum;
+	for (FB_SIZE_T i = 0; i < count; i++)
+	{
+		CachePartition* const partition = bcb->bcb_partitions[i];
+		const ULONG share = number / count + (i < number % count ? 1 : 0);
+
+		if (!share)
+			continue;
+
+		SyncLockGuard syncEmpty(&partition->cp_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+		const ULONG buffers = memory_init(tdbb, bcb, partition, share);
+
+		partition->cp_count += buffers;
+		partition->cp_free_minimum = (SSHORT) MIN(partition->cp_count / 4, 128);	// 25% clean page reserve
+		allocated += buffers;
+	}
+
+	bcb->bcb_count += allocated;
+	return allocated;
+}
+
+
+static BufferDesc* find_dirty_buffer(CachePartition* partition, bool& complete)
+{
+	// Look for a dirty buffer to write among the least recently used
+	// buffers of given partition, clear complete if walk was interrupted
+	// by buffers not placed into LRU ques yet.
+
+	int walk = partition->cp_free_minimum;
 	int chained = walk;
 
-	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
+	Sync lruSync(&partition->cp_syncLRU, FB_FUNCTION);
 	lruSync.lock(SYNC_SHARED);
 
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use; que_inst = que_inst->que_backward)
+	que* ques[PageReplacement::MAX_QUES];
+	const unsigned queCount = partition->cp_replacement->getVictimQues(ques);
+
+	for (unsigned i = 0; i < queCount && walk && chained; i++)
 	{
-		BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
+		que* const lru = ques[i];
 
-		if (bdb->bdb_flags & BDB_lru_chained)
+		for (QUE que_inst = lru->que_backward; que_inst != lru; que_inst = que_inst->que_backward)
 		{
-			if (!--chained)
-				break;
-			continue;
-		}
+			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
-		if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
-			continue;
+			if (bdb->bdb_flags & BDB_lru_chained)
+			{
+				if (!--chained)
+					break;
+				continue;
+			}
 
-		if (bdb->bdb_flags & BDB_db_dirty)
-		{
-			//tdbb->bumpStats(PageStatType::FETCHES); shouldn't it be here?
-			return bdb;
-		}
+			if (bdb->bdb_use_count || (bdb->bdb_flags & BDB_free_pending))
+				continue;
 
-		if (!--walk)
-			break;
+			if (bdb->bdb_flags & BDB_db_dirty)
+			{
+				//tdbb->bumpStats(PageStatType::FETCHES); shouldn't it be here?
+				return bdb;
+			}
+
+			if (!--walk)
+				break;
+		}
 	}
 
 	if (!chained)
 	{
 		lruSync.unlock();
 		lruSync.lock(SYNC_EXCLUSIVE);
-		requeueRecentlyUsed(bcb);
+		requeueRecentlyUsed(partition);
+		complete = false;
 	}
-	else
+
+	return NULL;
+}
+
+
+static BufferDesc* get_dirty_buffer(thread_db* tdbb)
+{
+	// This code is only used by the background I/O threads:
+	// cache writer, cache reader and garbage collector.
+
+	SET_TDBB(tdbb);
+	Database* dbb = tdbb->getDatabase();
+	BufferControl* bcb = dbb->dbb_bcb;
+	bool complete = true;
+
+	for (auto partition : bcb->bcb_partitions)
+	{
+		if (BufferDesc* bdb = find_dirty_buffer(partition, complete))
+			return bdb;
+	}
+
+	if (complete)
 		bcb->bcb_flags &= ~BCB_free_pending;
 
 	return NULL;
 }
 
 
-static BufferDesc* get_oldest_buffer(thread_db* tdbb, BufferControl* bcb)
+static bool read_queued_pages(thread_db* tdbb, BufferControl* bcb)
+{
+/**************************************
+ *
+ *	r e a d _ q u e u e d _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read pages queued by CCH_queue_prefetch(). Used by cache
+ *	writer only. Return false if the queue was empty.
+ *
+ **************************************/
+	HalfStaticArray<PageNumber, PREFETCH_QUEUE_PAGES> queue;
+
+	{	// scope
+		MutexLockGuard guard(bcb->bcb_prefetch_mutex, FB_FUNCTION);
+
+		if (bcb->bcb_prefetch_queue.isEmpty())
+			return false;
+
+		queue.assign(bcb->bcb_prefetch_queue.begin(), bcb->bcb_prefetch_queue.getCount());
+		bcb->bcb_prefetch_queue.clear();
+	}
+
+	// Every queued request has pages of a single page space,
+	// send runs of such pages to CCH_prefetch() as a whole
+
+	ULONG pages[PREFETCH_BATCH_PAGES];
+
+	for (FB_SIZE_T i = 0; i < queue.getCount(); )
+	{
+		const USHORT pageSpaceId = queue[i].getPageSpaceID();
+		ULONG count = 0;
+
+		for (; i < queue.getCount() && count < PREFETCH_BATCH_PAGES &&
+			queue[i].getPageSpaceID() == pageSpaceId; i++)
+		{
+			pages[count++] = queue[i].getPageNum();
+		}
+
+		CCH_prefetch(tdbb, pageSpaceId, pages, count);
+	}
+
+	return true;
+}
+
+
+static BufferDesc* get_oldest_buffer(thread_db* tdbb, CachePartition* partition, bool& exhausted)
 {
 /**************************************
  * Function description:
- *       Get candidate for preemption
+ *       Get candidate for preemption in given cache partition
  *       Found page buffer must have SYNC_EXCLUSIVE lock.
+ *       Set exhausted if partition has no buffers to preempt,
+ *       the caller could find them in other partitions.
  **************************************/
 
-	int walk = bcb->bcb_free_minimum;
+	BufferControl* const bcb = partition->cp_bcb;
+	int walk = partition->cp_free_minimum;
 	BufferDesc* bdb = nullptr;
 
-	Sync lruSync(&bcb->bcb_syncLRU, FB_FUNCTION);
-	if (bcb->bcb_lru_chain.load() != NULL)
+	Sync lruSync(&partition->cp_syncLRU, FB_FUNCTION);
+	if (partition->cp_lru_chain.load() != NULL)
 	{
 		lruSync.lock(SYNC_EXCLUSIVE);
-		requeueRecentlyUsed(bcb);
+		requeueRecentlyUsed(partition);
 		lruSync.downgrade(SYNC_SHARED);
 	}
 	else
 		lruSync.lock(SYNC_SHARED);
 
-	for (QUE que_inst = bcb->bcb_in_use.que_backward;
-		 que_inst != &bcb->bcb_in_use;
-		 que_inst = que_inst->que_backward)
-	{
-		bdb = nullptr;
-
-		// get the oldest buffer as the least recently used -- note
-		// that since there are no empty buffers this queue cannot be empty
+	que* ques[PageReplacement::MAX_QUES];
+	const unsigned queCount = partition->cp_replacement->getVictimQues(ques);
 
-		if (bcb->bcb_in_use.que_forward == &bcb->bcb_in_use)
-			BUGCHECK(213);	// msg 213 insufficient cache size
+	// get the oldest buffer as the least recently used -- note
+	// that empty buffers of this partition could be taken by other
+	// pages, so these ques could be empty
 
-		BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
+	exhausted = true;
+	for (unsigned i = 0; i < queCount; i++)
+		exhausted = exhausted && QUE_EMPTY(*ques[i]);
 
-		if (oldest->bdb_flags & BDB_lru_chained)
-			continue;
+	if (exhausted)
+		return nullptr;
 
-		if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
-			continue;
+	for (unsigned i = 0; i < queCount && !bdb; i++)
+	{
+		que* const lru = ques[i];
 
-		/*if (!writeable(oldest))
+		for (QUE que_inst = lru->que_backward; que_inst != lru; que_inst = que_inst->que_backward)
 		{
-			oldest->release(tdbb, true);
-			continue;
-		}*/
+			bdb = nullptr;
 
-		bdb = oldest;
-		if (!(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
-			break;
+			BufferDesc* oldest = BLOCK(que_inst, BufferDesc, bdb_in_use);
 
-		if (!(bcb->bcb_flags & BCB_cache_writer))
-			break;
+			if (oldest->bdb_flags & BDB_lru_chained)
+				continue;
 
-		bcb->bcb_flags |= BCB_free_pending;
-		if (!(bcb->bcb_flags & BCB_writer_active))
-			bcb->bcb_writer_sem.release();
+			if (oldest->bdb_use_count || !oldest->addRefConditional(tdbb, SYNC_EXCLUSIVE))
+				continue;
 
-		bdb->release(tdbb, true);
-		bdb = nullptr;
-		--walk;
+			/*if (!writeable(oldest))
+			{
+				oldest->release(tdbb, true);
+				continue;
+			}*/
+
+			bdb = oldest;
+			if (!(bdb->bdb_flags & (BDB_dirty | BDB_db_dirty)) || !walk)
+				break;
+
+			if (!(bcb->bcb_flags & BCB_cache_writer))
+				break;
+
+			bcb->bcb_flags |= BCB_free_pending;
+			if (!(bcb->bcb_flags & BCB_writer_active))
+				bcb->bcb_writer_sem.release();
+
+			bdb->release(tdbb, true);
+			bdb = nullptr;
+			--walk;
+		}
 	}
 
 	lruSync.unlock();
@@ -3817,6 +4260,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				if (bdb->bdb_page == page)
 				{
 					recentlyUsed(bdb);
+					bdb->bdb_partition->cp_replacement->hit();
 					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
 					return bdb;
 				}
@@ -3860,6 +4304,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				if (bdb->bdb_page == page)
 				{
 					recentlyUsed(bdb);
+					bdb->bdb_partition->cp_replacement->hit();
 					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
 					cacheBuffer(att, bdb);
 					return bdb;
@@ -3871,40 +4316,67 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				continue;
 			}
 
-			// try empty list
-			if (QUE_NOT_EMPTY(bcb->bcb_empty))
+			// Look for a buffer starting from the partition the page should be
+			// placed into. Empty buffers of any partition are used before
+			// the oldest buffer is preempted.
+
+			const CachePartition* const home = get_partition(bcb, page);
+			const FB_SIZE_T count = bcb->bcb_partitions.getCount();
+
+			for (FB_SIZE_T i = 0; i < count && !bdb; i++)
 			{
-				SyncLockGuard bcbSync(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
-				if (QUE_NOT_EMPTY(bcb->bcb_empty))
+				CachePartition* const partition = bcb->bcb_partitions[(home->cp_number + i) % count];
+
+				// try empty list
+				if (QUE_NOT_EMPTY(partition->cp_empty))
 				{
-					QUE que_inst = bcb->bcb_empty.que_forward;
-					QUE_DELETE(*que_inst);
-					QUE_INIT(*que_inst);
-					bdb = BLOCK(que_inst, BufferDesc, bdb_que);
+					SyncLockGuard emptySync(&partition->cp_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+					if (QUE_NOT_EMPTY(partition->cp_empty))
+					{
+						QUE que_inst = partition->cp_empty.que_forward;
+						QUE_DELETE(*que_inst);
+						QUE_INIT(*que_inst);
+						bdb = BLOCK(que_inst, BufferDesc, bdb_que);
 
-					bcb->bcb_inuse++;
-					is_empty = true;
+						partition->cp_inuse++;
+						is_empty = true;
+					}
 				}
 			}
 
 			if (bdb)
 				bdb->addRef(tdbb, SYNC_EXCLUSIVE);
-			else
+
+			bool exhausted = true;
+
+			for (FB_SIZE_T i = 0; i < count && !bdb; i++)
 			{
-				bdb = get_oldest_buffer(tdbb, bcb);
-				if (!bdb)
-				{
-					Thread::yield();
-				}
-				else if (bdb->bdb_page == page)
+				CachePartition* const partition = bcb->bcb_partitions[(home->cp_number + i) % count];
+
+				bool empty;
+				bdb = get_oldest_buffer(tdbb, partition, empty);
+				exhausted = exhausted && empty;
+				if (bdb && bdb->bdb_page == page)
 				{
 					bdb->downgrade(syncType);
 					recentlyUsed(bdb);
+					partition->cp_replacement->hit();
 					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
 					cacheBuffer(att, bdb);
 					return bdb;
 				}
 			}
+
+			if (!bdb)
+			{
+				// Since there are no empty buffers, victim ques of
+				// all partitions together cannot be empty
+
+				if (exhausted)
+					BUGCHECK(213);	// msg 213 insufficient cache size
+
+				Thread::yield();
+			}
 		}
 
 		fb_assert(bdb->ourExclusiveLock());
@@ -3923,7 +4395,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 				if (!bdb2)
 				{
 					bdb->bdb_page = page;
-					bdb->bdb_flags &= BDB_lru_chained; // yes, clear all except BDB_lru_chained
+					bdb->bdb_flags &= BDB_lru_state; // yes, clear all except LRU state
 					bdb->bdb_flags |= BDB_read_pending;
 					bdb->bdb_scan_count = 0;
 					if (bdb->bdb_lock)
@@ -3933,17 +4405,19 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					bcbSync.unlock();
 #endif
 
-					if (!(bdb->bdb_flags & BDB_lru_chained))
+					CachePartition* const partition = bdb->bdb_partition;
+
+					Sync syncLRU(&partition->cp_syncLRU, FB_FUNCTION);
+					if (!(bdb->bdb_flags & BDB_lru_chained) && syncLRU.lockConditional(SYNC_EXCLUSIVE))
+						partition->cp_replacement->assigned(bdb);
+					else
 					{
-						Sync syncLRU(&bcb->bcb_syncLRU, FB_FUNCTION);
-						if (syncLRU.lockConditional(SYNC_EXCLUSIVE))
-						{
-							QUE_DELETE(bdb->bdb_in_use);
-							QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
-						}
-						else
-							recentlyUsed(bdb);
+						// let requeueRecentlyUsed() place the buffer
+						bdb->bdb_flags |= BDB_lru_new;
+						recentlyUsed(bdb);
 					}
+
+					partition->cp_replacement->miss();
 					tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
 					cacheBuffer(att, bdb);
 					return bdb;
@@ -3962,6 +4436,7 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 					continue;
 				}
 				recentlyUsed(bdb2);
+				bdb2->bdb_partition->cp_replacement->hit();
 				tdbb->bumpStats(PageStatType::FETCHES, pageSpaceId);
 				cacheBuffer(att, bdb2);
 			}
@@ -3971,9 +4446,11 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 			bdb->release(tdbb, true);
 			if (is_empty)
 			{
-				SyncLockGuard syncEmpty(&bcb->bcb_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
-				QUE_INSERT(bcb->bcb_empty, bdb->bdb_que);
-				bcb->bcb_inuse--;
+				CachePartition* const partition = bdb->bdb_partition;
+
+				SyncLockGuard syncEmpty(&partition->cp_syncEmpty, SYNC_EXCLUSIVE, FB_FUNCTION);
+				QUE_INSERT(partition->cp_empty, bdb->bdb_que);
+				partition->cp_inuse--;
 			}
 
 			if (!bdb2 && wait > 0)
@@ -3987,6 +4464,47 @@ static BufferDesc* get_buffer(thread_db* tdbb, const PageNumber page, SyncType s
 	fb_assert(false);
 }
 
+
+static CachePartition* get_partition(BufferControl* bcb, const PageNumber& page)
+{
+/**************************************
+ *
+ *	g e t _ p a r t i t i o n
+ *
+ **************************************
+ *
+ * Functional description
+ *	Choose the cache partition to read the page into.
+ *
+ **************************************/
+	const auto& partitions = bcb->bcb_partitions;
+	const unsigned count = partitions.getCount();
+
+	if (count == 1)
+		return partitions[0];
+
+	if (bcb->bcb_flags & BCB_place_by_hash)
+		return partitions[page.getPageNum() % count];
+
+	// Partitions are bound to NUMA nodes in round-robin manner, thus partitions
+	// of node N are N, N + nodes, N + 2 * nodes, etc. The one of them is chosen
+	// by the CPU number. If there is single node (emulation mode), all
+	// partitions are chosen by the CPU number.
+
+	unsigned cpu, node;
+	os_utils::getCurrentCpu(cpu, node);
+
+	const unsigned nodes = bcb->bcb_numa_nodes;
+	node %= nodes;
+
+	if (node >= count)
+		return partitions[node % count];
+
+	const unsigned nodePartitions = (count - node - 1) / nodes + 1;
+	return partitions[node + (cpu % nodePartitions) * nodes];
+}
+
+
 static ULONG get_prec_walk_mark(BufferControl* bcb)
 {
 /**************************************
@@ -4068,6 +4586,59 @@ static int get_related(BufferDesc* bdb, PagesArray &lowPages, int limit, const U
 }
 
 
+static void init_partitions(thread_db* tdbb, BufferControl* bcb, ULONG number)
+{
+/**************************************
+ *
+ *	i n i t _ p a r t i t i o n s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Split the cache into partitions according to configuration.
+ *	Only SuperServer cache may have more than one partition, and
+ *	every partition should get at least MIN_PAGE_BUFFERS buffers.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	const Database* const dbb = tdbb->getDatabase();
+	const Config* const config = dbb->dbb_config;
+
+	bcb->bcb_numa_nodes = MAX(os_utils::getNumaNodes(), 1);
+
+	ULONG count = 1;
+
+	if (bcb->bcb_flags & BCB_exclusive)
+	{
+		count = config->getPageCachePartitions();
+
+		if (!count)
+			count = bcb->bcb_numa_nodes;
+
+		count = MIN(count, MAX_CACHE_PARTITIONS);
+		count = MIN(count, MAX(number / MIN_PAGE_BUFFERS, 1));
+	}
+
+	if (NoCaseString(config->getPageCachePlacement()) == PageCachePlacementHash)
+		bcb->bcb_flags |= BCB_place_by_hash;
+
+	// Bind partitions to nodes if there is anything to bind
+	const bool bind = (count > 1 && bcb->bcb_numa_nodes > 1);
+
+	for (ULONG i = 0; i < count; i++)
+	{
+		const int node = bind ? (int) (i % bcb->bcb_numa_nodes) : -1;
+		CachePartition* const partition = FB_NEW_POOL(*bcb->bcb_bufferpool)
+			CachePartition(bcb, (USHORT) i, node);
+
+		bcb->bcb_partitions.add(partition);
+
+		partition->cp_replacement = PageReplacement::create(*bcb->bcb_bufferpool, partition,
+			config->getPageReplacementPolicy());
+	}
+}
+
+
 static LockState lock_buffer(thread_db* tdbb, BufferDesc* bdb, const SSHORT wait,
 	const SCHAR page_type)
 {
@@ -4219,7 +4790,7 @@ static LockState lock_buffer(thread_db* tdbb, BufferDesc* bdb, const SSHORT wait
 }
 
 
-static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
+static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, CachePartition* partition, ULONG number)
 {
 /**************************************
  *
@@ -4228,7 +4799,7 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
  **************************************
  *
  * Functional description
- *	Initialize memory for the cache.
+ *	Initialize memory for the cache partition.
  *	Return number of buffers allocated.
  *
  **************************************/
@@ -4284,6 +4855,10 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 			}
 			bcb->bcb_memory.push(memory);
 
+			// Place the memory at the partition's node before buffers are touched
+			if (partition->cp_node >= 0)
+				os_utils::bindToNumaNode(memory, memory_end - memory, partition->cp_node);
+
 			tail = (BufferDesc*) FB_ALIGN(memory, alignof(BufferDesc));
 
 			BufferControl::BDBBlock blk;
@@ -4305,7 +4880,7 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 			fb_assert(memory_end >= memory + page_size * to_alloc);
 		}
 
-		tail = ::new(tail) BufferDesc(bcb);
+		tail = ::new(tail) BufferDesc(bcb, partition);
 
 		if (!(bcb->bcb_flags & BCB_exclusive))
 		{
@@ -4318,7 +4893,7 @@ static ULONG memory_init(thread_db* tdbb, BufferControl* bcb, ULONG number)
 		tail->bdb_buffer = (pag*) memory;
 		memory += bcb->bcb_page_size;
 
-		QUE_INSERT(bcb->bcb_empty, tail->bdb_que);
+		QUE_INSERT(partition->cp_empty, tail->bdb_que);
 		tail++;
 
 		buffers++;				// Allocated buffers
@@ -5040,7 +5615,10 @@ static bool write_page(thread_db* tdbb, BufferDesc* bdb, FbStatusVector* const s
 		}
 
 		if (result)
+		{
 			bdb->bdb_flags &= ~BDB_db_dirty;
+			++bdb->bdb_partition->cp_writes;
+		}
 	}
 
 	if (!result)
@@ -5106,10 +5684,10 @@ void recentlyUsed(BufferDesc* bdb)
 	if (oldFlags & BDB_lru_chained)
 		return;
 
-	BufferControl* bcb = bdb->bdb_bcb;
+	CachePartition* const partition = bdb->bdb_partition;
 
 #ifdef DEV_BUILD
-	volatile BufferDesc* chain = bcb->bcb_lru_chain;
+	volatile BufferDesc* chain = partition->cp_lru_chain;
 	for (; chain; chain = chain->bdb_lru_chain)
 	{
 		if (chain == bdb)
@@ -5118,14 +5696,14 @@ void recentlyUsed(BufferDesc* bdb)
 #endif
 	for (;;)
 	{
-		bdb->bdb_lru_chain = bcb->bcb_lru_chain;
-		if (bcb->bcb_lru_chain.compare_exchange_strong(bdb->bdb_lru_chain, bdb))
+		bdb->bdb_lru_chain = partition->cp_lru_chain;
+		if (partition->cp_lru_chain.compare_exchange_strong(bdb->bdb_lru_chain, bdb))
 			break;
 	}
 }
 
 
-void requeueRecentlyUsed(BufferControl* bcb)
+void requeueRecentlyUsed(CachePartition* partition)
 {
 	BufferDesc* chain = NULL;
 
@@ -5133,8 +5711,8 @@ void requeueRecentlyUsed(BufferControl* bcb)
 
 	for (;;)
 	{
-		chain = bcb->bcb_lru_chain;
-		if (bcb->bcb_lru_chain.compare_exchange_strong(chain, NULL))
+		chain = partition->cp_lru_chain;
+		if (partition->cp_lru_chain.compare_exchange_strong(chain, NULL))
 			break;
 	}
 
@@ -5156,14 +5734,20 @@ void requeueRecentlyUsed(BufferControl* bcb)
 	while ((bdb = reversed) != NULL)
 	{
 		reversed = bdb->bdb_lru_chain;
-		QUE_DELETE(bdb->bdb_in_use);
-		QUE_INSERT(bcb->bcb_in_use, bdb->bdb_in_use);
+
+		if (bdb->bdb_flags & BDB_lru_new)
+		{
+			bdb->bdb_flags &= ~BDB_lru_new;
+			partition->cp_replacement->assigned(bdb);
+		}
+		else
+			partition->cp_replacement->referenced(bdb);
 
 		bdb->bdb_lru_chain = NULL;
 		bdb->bdb_flags &= ~BDB_lru_chained;
 	}
 
-	chain = bcb->bcb_lru_chain;
+	chain = partition->cp_lru_chain;
 }
 
 
@@ -5303,268 +5887,3 @@ void BufferDesc::unLockIO(thread_db* tdbb)
 	bdb_syncIO.unlock(NULL, SYNC_EXCLUSIVE);
 }
 
-
-namespace Jrd {
-
-/// class BCBHashTable
-
-void BCBHashTable::resize(ULONG count)
-{
-	const ULONG old_count = m_count;
-	chain_type* const old_chains = m_chains;
-
-	chain_type* new_chains = FB_NEW_POOL(m_pool) chain_type[count];
-	m_count = count;
-	m_chains = new_chains;
-
-#ifndef HASH_USE_CDS_LIST
-	// Initialize all new new_chains
-	for (chain_type* que = new_chains; que < new_chains + count; que++)
-		QUE_INIT(*que);
-#endif
-
-	if (!old_chains)
-		return;
-
-	const chain_type* const old_end = old_chains + old_count;
-
-	// Move any active buffers from old hash table to new
-	for (chain_type* old_tail = old_chains; old_tail < old_end; old_tail++)
-	{
-#ifndef HASH_USE_CDS_LIST
-		while (QUE_NOT_EMPTY(*old_tail))
-		{
-			QUE que_inst = old_tail->que_forward;
-			BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
-			QUE_DELETE(*que_inst);
-			QUE mod_que = &new_chains[hash(bdb->bdb_page)];
-			QUE_INSERT(*mod_que, *que_inst);
-		}
-#else
-		while (!old_tail->empty())
-		{
-			auto n = old_tail->begin();
-			old_tail->erase(n->first);				// bdb_page
-
-			chain_type* new_chain = &m_chains[hash(n->first)];
-			new_chain->insert(n->first, n->second);	// bdb_page, bdb
-		}
-#endif
-	}
-
-	delete[] old_chains;
-}
-
-void BCBHashTable::clear()
-{
-	if (!m_chains)
-		return;
-
-#ifdef HASH_USE_CDS_LIST
-	const chain_type* const end = m_chains + m_count;
-	for (chain_type* tail = m_chains; tail < end; tail++)
-		tail->clear();
-#endif
-
-	delete[] m_chains;
-	m_chains = nullptr;
-	m_count = 0;
-}
-
-inline BufferDesc* BCBHashTable::find(const PageNumber& page) const
-{
-	auto& list = m_chains[hash(page)];
-
-#ifndef HASH_USE_CDS_LIST
-	QUE que_inst = list.que_forward;
-	for (; que_inst != &list; que_inst = que_inst->que_forward)
-	{
-		BufferDesc* bdb = BLOCK(que_inst, BufferDesc, bdb_que);
-		if (bdb->bdb_page == page)
-			return bdb;
-	}
-
-#else // HASH_USE_CDS_LIST
-	auto ptr = list.get(page);
-	if (!ptr.empty())
-	{
-		fb_assert(ptr->second != nullptr);
-#ifdef DEV_BUILD
-		// Original libcds have no update(key, value), use this code with it,
-		// see also comment in get_buffer()
-		while (ptr->second == nullptr)
-			cds::backoff::pause();
-#endif
-		if (ptr->second->bdb_page == page)
-			return ptr->second;
-	}
-#endif
-
-	return nullptr;
-}
-
-inline BufferDesc* BCBHashTable::emplace(BufferDesc* bdb, const PageNumber& page, bool remove)
-{
-#ifndef HASH_USE_CDS_LIST
-	// bcb_syncObject should be locked in EX mode
-
-	BufferDesc* bdb2 = find(page);
-	if (!bdb2)
-	{
-		if (remove)
-			QUE_DELETE(bdb->bdb_que);
-
-		que& mod_que = m_chains[hash(page)];
-		QUE_INSERT(mod_que, bdb->bdb_que);
-	}
-	return bdb2;
-#else // HASH_USE_CDS_LIST
-
-	BufferDesc* bdb2 = nullptr;
-	BdbList& list = m_chains[hash(page)];
-
-/*
-	// Original libcds have no update(key, value), use this code with it
-
-	auto ret = list.update(page, [bdb, &bdb2](bool bNew, BdbList::value_type& val)
-		{
-			if (bNew)
-				val.second = bdb;
-			else
-				while (!(bdb2 = val.second))
-					cds::backoff::pause();
-		},
-		true);
-*/
-
-	auto ret = list.update(page, bdb, [&bdb2](bool bNew, BdbList::value_type& val)
-		{
-			// someone might have put a page buffer in the chain concurrently, so
-			// we store it for the further investigation
-			if (!bNew)
-				bdb2 = val.second;
-		},
-		true);
-	fb_assert(ret.first);
-
-	// if we have inserted the page buffer that we found (empty or oldest)
-	if (bdb2 == nullptr)
-	{
-		fb_assert(ret.second);
-#ifdef DEV_BUILD
-		auto p1 = list.get(page);
-		fb_assert(!p1.empty() && p1->first == page && p1->second == bdb);
-#endif
-
-		if (remove)
-		{
-			// remove the page buffer from old hash slot
-			const PageNumber oldPage = bdb->bdb_page;
-			BdbList& oldList = m_chains[hash(oldPage)];
-
-#ifdef DEV_BUILD
-			p1 = oldList.get(oldPage);
-			fb_assert(!p1.empty() && p1->first == oldPage && p1->second == bdb);
-#endif
-
-			const bool ok = oldList.erase(oldPage);
-			fb_assert(ok);
-
-#ifdef DEV_BUILD
-			p1 = oldList.get(oldPage);
-			fb_assert(p1.empty() || p1->second != bdb);
-#endif
-		}
-
-#ifdef DEV_BUILD
-		p1 = list.get(page);
-		fb_assert(!p1.empty() && p1->first == page && p1->second == bdb);
-#endif
-	}
-	return bdb2;
-#endif
-}
-
-
-void BCBHashTable::remove(BufferDesc* bdb)
-{
-#ifndef HASH_USE_CDS_LIST
-	QUE_DELETE(bdb->bdb_que);
-#else
-	BdbList& list = m_chains[hash(bdb->bdb_page)];
-
-#ifdef DEV_BUILD
-	auto p = list.get(bdb->bdb_page);
-	fb_assert(!p.empty() && p->first == bdb->bdb_page && p->second == bdb);
-#endif
-
-	list.erase(bdb->bdb_page);
-#endif
-}
-
-
-}; // namespace Jrd
-
-
-#ifdef HASH_USE_CDS_LIST
-
-///	 class ListNodeAllocator<T>
-
-class InitPool
-{
-public:
-	explicit InitPool(MemoryPool&)
-		: m_pool(InitCDS::createPool()),
-		  m_stats(m_pool->getStatsGroup())
-	{ }
-
-	~InitPool()
-	{
-		// m_pool will be deleted by InitCDS dtor after cds termination
-		// some memory could still be not freed until that moment
-
-#ifdef DEBUG_CDS_MEMORY
-		char str[256];
-		snprintf(str, sizeof(str),
-			"CCH list's common pool stats:\n"
-			"  usage         = %llu\n"
-			"  mapping       = %llu\n"
-			"  max usage     = %llu\n"
-			"  max mapping   = %llu\n"
-			"\n",
-			m_stats.getCurrentUsage(),
-			m_stats.getCurrentMapping(),
-			m_stats.getMaximumUsage(),
-			m_stats.getMaximumMapping()
-		);
-		gds__log(str);
-#endif
-	}
-
-	void* alloc(size_t size)
-	{
-		return m_pool->allocate(size ALLOC_ARGS);
-	}
-
-private:
-	MemoryPool* m_pool;
-	MemoryStats& m_stats;
-};
-
-static InitInstance<InitPool> initPool;
-
-
-template <typename T>
-T* ListNodeAllocator<T>::allocate(std::size_t n)
-{
-	return static_cast<T*>(initPool().alloc(n * sizeof(T)));
-}
-
-template <typename T>
-void ListNodeAllocator<T>::deallocate(T* p, std::size_t /* n */)
-{
-	// It uses the correct pool stored within memory block itself
-	MemoryPool::globalFree(p);
-}
-
-#endif // HASH_USE_CDS_LIST
@@ -39,6 +39,8 @@
 #include "../jrd/lls.h"
 #include "../jrd/pag.h"
 
+#include <atomic>
+
 //#define CCH_DEBUG
 
 #ifdef CCH_DEBUG
@@ -63,6 +65,8 @@ struct que;
 class BufferDesc;
 class Database;
 class BCBHashTable;
+class PageReplacement;
+class CachePartition;
 
 // Page buffer cache size constraints.
 
@@ -73,6 +77,8 @@ inline constexpr ULONG MAX_PAGE_BUFFERS = 131072;
 inline constexpr ULONG MAX_PAGE_BUFFERS = MAX_SLONG - 1;
 #endif
 
+inline constexpr ULONG MAX_CACHE_PARTITIONS = 64;
+
 // BufferControl -- Buffer control block -- one per system
 
 class BufferControl : public pool_alloc<type_bcb>
@@ -82,22 +88,21 @@ class BufferControl : public pool_alloc<type_bcb>
 		  bcb_memory_stats(&parentStats),
 		  bcb_memory(p),
 		  bcb_writer_fini(p, cache_writer, THREAD_medium),
+		  bcb_prefetch_queue(p),
+		  bcb_partitions(p),
 		  bcb_bdbBlocks(p)
 	{
 		bcb_database = NULL;
-		QUE_INIT(bcb_in_use);
 		QUE_INIT(bcb_pending);
-		QUE_INIT(bcb_empty);
 		QUE_INIT(bcb_dirty);
 		bcb_dirty_count = 0;
 		bcb_free = NULL;
 		bcb_flags = 0;
-		bcb_free_minimum = 0;
 		bcb_count = 0;
-		bcb_inuse = 0;
 		bcb_prec_walk_mark = 0;
 		bcb_page_size = 0;
 		bcb_page_incarnation = 0;
+		bcb_numa_nodes = 1;
 		bcb_hashTable = nullptr;
 #ifdef SUPERSERVER_V2
 		bcb_prefetch = NULL;
@@ -115,32 +120,22 @@ public:
 	Firebird::MemoryStats bcb_memory_stats;
 
 	UCharStack	bcb_memory;			// Large block partitioned into buffers
-	que			bcb_in_use;			// Que of buffers in use, main LRU que
 	que			bcb_pending;		// Que of buffers which are going to be freed and reassigned
-	que			bcb_empty;			// Que of empty buffers
-
-	// Recently used buffer put there without locking common LRU que (bcb_in_use).
-	// When bcb_syncLRU is locked this chain is merged into bcb_in_use. See also
-	// requeueRecentlyUsed() and recentlyUsed()
-	std::atomic<BufferDesc*>	bcb_lru_chain;
 
 	que			bcb_dirty;			// que of dirty buffers
 	SLONG		bcb_dirty_count;	// count of pages in dirty page btree
 
 	Precedence*	bcb_free;			// Free precedence blocks
 	Firebird::AtomicCounter	bcb_flags;	// see below
-	SSHORT		bcb_free_minimum;	// Threshold to activate cache writer
 	ULONG		bcb_count;			// Number of buffers allocated
-	ULONG		bcb_inuse;			// Number of buffers in use
 	ULONG		bcb_prec_walk_mark;	// mark value used in precedence graph walk
 	ULONG		bcb_page_size;		// Database page size in bytes
 	ULONG		bcb_page_incarnation;	// Cache page incarnation counter
+	unsigned	bcb_numa_nodes;		// Number of NUMA nodes of the host
 
 	Firebird::SyncObject	bcb_syncObject;
 	Firebird::SyncObject	bcb_syncDirtyBdbs;
-	Firebird::SyncObject	bcb_syncEmpty;
 	Firebird::SyncObject	bcb_syncPrecedence;
-	Firebird::SyncObject	bcb_syncLRU;
 
 	// If we make bcb_flags atomic this mutex will become unneeded: XCHG of bcb_flags is enough
 	Firebird::Mutex			bcb_threadStartup;
@@ -151,6 +146,9 @@ public:
 	Firebird::Semaphore bcb_writer_sem;		// Wake up cache writer
 	Firebird::Semaphore bcb_writer_init;	// Cache writer initialization
 	BcbThreadSync bcb_writer_fini;			// Cache writer finalization
+
+	Firebird::Mutex	bcb_prefetch_mutex;
+	Firebird::Array<PageNumber> bcb_prefetch_queue;	// Pages to be read ahead by cache writer
 #ifdef SUPERSERVER_V2
 	static void cache_reader(BufferControl* bcb);
 	// the code in cch.cpp is not tested for semaphore instead event !!!
@@ -164,6 +162,7 @@ public:
 	void exceptionHandler(const Firebird::Exception& ex, BcbThreadSync::ThreadRoutine* routine);
 
 	BCBHashTable* bcb_hashTable;
+	Firebird::Array<CachePartition*>	bcb_partitions;	// buffers with their own LRU ques, at least one
 
 	// block of allocated BufferDesc's
 	struct BDBBlock
@@ -184,6 +183,53 @@ inline constexpr int BCB_reader_active	= 32;	// cache reader not blocked on even
 #endif
 inline constexpr int BCB_free_pending	= 64;	// request cache writer to free pages
 inline constexpr int BCB_exclusive		= 128;	// there is only BCB in whole system
+inline constexpr int BCB_place_by_hash	= 256;	// partition for a page is chosen by page number
+
+
+// CachePartition -- part of the page buffers with their own empty and LRU ques.
+// SuperServer may split the cache into partitions bound to NUMA nodes, so the
+// buffers are allocated in node local memory and threads of different nodes
+// don't contend for the same LRU lock. Otherwise the cache has one partition.
+
+class CachePartition
+{
+public:
+	CachePartition(BufferControl* bcb, USHORT number, int node)
+		: cp_bcb(bcb),
+		  cp_number(number),
+		  cp_node(node)
+	{
+		QUE_INIT(cp_in_use);
+		QUE_INIT(cp_empty);
+		cp_lru_chain = nullptr;
+		cp_replacement = nullptr;
+		cp_free_minimum = 0;
+		cp_count = 0;
+		cp_inuse = 0;
+	}
+
+	BufferControl* const	cp_bcb;
+	const USHORT			cp_number;		// Partition number
+	const int				cp_node;		// NUMA node memory is bound to, -1 if none
+
+	que			cp_in_use;			// Que of buffers in use, main LRU que
+	que			cp_empty;			// Que of empty buffers
+
+	// Recently used buffer put there without locking common LRU que (cp_in_use).
+	// When cp_syncLRU is locked this chain is merged into cp_in_use. See also
+	// requeueRecentlyUsed() and recentlyUsed()
+	std::atomic<BufferDesc*>	cp_lru_chain;
+
+	PageReplacement*	cp_replacement;	// page replacement policy, manages LRU ques
+
+	SSHORT		cp_free_minimum;	// Threshold to activate cache writer
+	ULONG		cp_count;			// Number of buffers allocated
+	ULONG		cp_inuse;			// Number of buffers in use
+	Firebird::AtomicCounter	cp_writes;	// Number of pages written from partition buffers
+
+	Firebird::SyncObject	cp_syncEmpty;
+	Firebird::SyncObject	cp_syncLRU;
+};
 
 
 // BufferDesc -- Buffer descriptor block
@@ -191,8 +237,9 @@ inline constexpr int BCB_exclusive		= 128;	// there is only BCB in whole system
 class BufferDesc : public pool_alloc<type_bdb>
 {
 public:
-	explicit BufferDesc(BufferControl* bcb)
+	explicit BufferDesc(BufferControl* bcb, CachePartition* partition = nullptr)
 		: bdb_bcb(bcb),
+		  bdb_partition(partition),
 		  bdb_page(0, 0)
 	{
 		bdb_lock = NULL;
@@ -213,6 +260,7 @@ public:
 		bdb_scan_count = 0;
 		bdb_difference_page = 0;
 		bdb_prec_walk_mark = 0;
+		bdb_hash_key = ~FB_UINT64(0);
 	}
 
 	bool addRef(thread_db* tdbb, Firebird::SyncType syncType, int wait = 1);
@@ -239,14 +287,16 @@ public:
 	}
 
 	BufferControl*	bdb_bcb;
+	CachePartition*	bdb_partition;		// partition of cache buffer belongs to
 	Firebird::SyncObject	bdb_syncPage;
 	Lock*		bdb_lock;				// Lock block for buffer
-	que			bdb_que;				// Either mod que in hash table or bcb_empty que if never used
+	que			bdb_que;				// Either mod que in hash table or cp_empty que if never used
 	que			bdb_in_use;				// queue of buffers in use
 	que			bdb_dirty;				// dirty pages LRU queue
 	BufferDesc*	bdb_lru_chain;			// pending LRU chain
 	Ods::pag*	bdb_buffer;				// Actual buffer
 	PageNumber	bdb_page;				// Database page number in buffer
+	std::atomic<FB_UINT64> bdb_hash_key;	// bdb_page as put into hash table, see BCBHashTable
 	ULONG		bdb_incarnation;
 	ULONG		bdb_transactions;		// vector of dirty flags to reduce commit overhead
 	TraNumber	bdb_mark_transaction;	// hi-water mark transaction to defer header page I/O
@@ -291,12 +341,83 @@ inline constexpr int BDB_prefetch			= 0x4000;	// page has been prefetched but no
 inline constexpr int BDB_no_blocking_ast	= 0x8000;	// No blocking AST registered with page lock
 inline constexpr int BDB_lru_chained		= 0x10000;	// buffer is in pending LRU chain
 inline constexpr int BDB_nbak_state_lock	= 0x20000;	// nbak state lock should be released after buffer is written
+inline constexpr int BDB_lru_new			= 0x40000;	// buffer got new page and is not placed into LRU ques yet
+inline constexpr int BDB_lru_probation		= 0x80000;	// buffer is in probation que of 2Q policy
+
+// buffer state in LRU ques, kept when buffer gets new page
+inline constexpr int BDB_lru_state = BDB_lru_chained | BDB_lru_new | BDB_lru_probation;
 
 // bdb_ast_flags
 
 inline constexpr int BDB_blocking 			= 0x01;		// a blocking ast was sent while page locked
 
 
+// Page replacement policy. Places buffers into LRU ques and tells in what order
+// these ques should be scanned (from the tail) for a buffer to reuse. All
+// methods except hit() and miss() are called with cp_syncLRU of the partition
+// locked exclusive. Hits and misses are counted in per-CPU shards to not make
+// every page fetch write the same cache line, they are summed when read.
+
+class PageReplacement
+{
+public:
+	static PageReplacement* create(Firebird::MemoryPool& pool, CachePartition* partition, const char* name);
+
+	explicit PageReplacement(CachePartition* partition)
+		: m_partition(partition)
+	{}
+
+	virtual ~PageReplacement()
+	{}
+
+	virtual const char* getName() const = 0;
+
+	// buffer got new page
+	virtual void assigned(BufferDesc* bdb) = 0;
+	// page is referenced again
+	virtual void referenced(BufferDesc* bdb) = 0;
+	// page is not expected to be referenced soon (large scan is done with it)
+	virtual void released(BufferDesc* bdb) = 0;
+	// buffer is removed from LRU ques
+	virtual void removed(BufferDesc* bdb) = 0;
+	// put ques to look for a victim into given array, return number of ques
+	virtual unsigned getVictimQues(que** ques) = 0;
+
+	static const unsigned MAX_QUES = 2;
+
+	void hit()
+	{
+		getCounters().hits.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	void miss()
+	{
+		getCounters().misses.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	FB_UINT64 getHits() const;
+	FB_UINT64 getMisses() const;
+
+protected:
+	CachePartition* const m_partition;
+
+private:
+	static const unsigned COUNTER_SHARDS = 16;
+
+	// Shard occupies whole cache line
+	struct Counters
+	{
+		std::atomic<FB_UINT64> hits = 0;
+		std::atomic<FB_UINT64> misses = 0;
+		char padding[64 - 2 * sizeof(std::atomic<FB_UINT64>)];
+	};
+
+	Counters& getCounters();
+
+	Counters m_counters[COUNTER_SHARDS];
+};
+
+
 // PRE -- Precedence block
 
 class Precedence : public pool_alloc<type_pre>
@@ -347,6 +468,12 @@ enum LATCH
 };
 
 
+// maximum number of pages read by single CCH_prefetch() call
+inline constexpr ULONG PREFETCH_BATCH_PAGES = 64;
+
+// maximum number of pages waiting for cache writer to read them ahead
+inline constexpr ULONG PREFETCH_QUEUE_PAGES = 4 * PREFETCH_BATCH_PAGES;
+
 
 #ifdef SUPERSERVER_V2
 #include "../jrd/os/pio.h"
@@ -45,7 +45,8 @@ Jrd::DeferredWork* DFW_post_work_arg(Jrd::jrd_tra*, Jrd::DeferredWork*, const ds
 	USHORT);
 Jrd::DeferredWork* DFW_post_work_arg(Jrd::jrd_tra*, Jrd::DeferredWork*, const dsc* nameDesc, const dsc* schemaDesc,
 	USHORT, Jrd::dfw_t);
-void DFW_update_index(const Jrd::QualifiedName&, USHORT, const Jrd::SelectivityList&, Jrd::jrd_tra*);
+void DFW_update_index(const Jrd::QualifiedName&, const Jrd::jrd_rel*, USHORT, const Jrd::SelectivityList&,
+	Jrd::jrd_tra*, const Jrd::IndexHistogram* = nullptr);
 void DFW_reset_icu(Jrd::thread_db*);
 
 #endif // JRD_DFW_PROTO_H
@@ -242,6 +242,7 @@ enum drq_type_t
 	drq_e_pub_tab_all,		// erase relation from all publication
 	drq_l_rel_con,			// lookup relation constraint
 	drq_l_rel_fld_name,		// lookup relation field name
+	drq_m_rfr_hist,			// modify relation field histogram
 
 	drq_MAX
 };
@@ -239,3 +239,6 @@
 	FIELD(fld_text_max		, nam_text_max		, dtype_varying, MAX_VARY_COLUMN_SIZE / METADATA_BYTES_PER_CHAR * METADATA_BYTES_PER_CHAR, dsc_text_type_metadata, NULL, true, ODS_14_0)
 
 	FIELD(fld_tab_type		, nam_mon_tab_type	, dtype_varying	, 32						, dsc_text_type_ascii		, NULL		, true		, ODS_14_0)
+	FIELD(fld_page_repl		, nam_mon_page_repl	, dtype_varying	, 32						, dsc_text_type_ascii		, NULL		, true		, ODS_14_0)
+	FIELD(fld_histogram		, nam_histogram		, dtype_blob	, BLOB_SIZE					, isc_blob_untyped			, NULL		, true		, ODS_14_0)
+	FIELD(fld_gen_cache		, nam_gen_cache		, dtype_long	, sizeof(SLONG)				, 0							, NULL		, true		, ODS_14_0)
@@ -42,6 +42,7 @@ inline constexpr USHORT FILE_backing_up		= 64;
 // flags for RDB$RELATIONS
 
 inline constexpr USHORT REL_sql			= 0x0001;
+inline constexpr USHORT REL_encoding	= 0x0002;		// records use column-aware encoding
 
 // flags for RDB$TRIGGERS
 
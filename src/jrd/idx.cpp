@@ -37,6 +37,8 @@
 #include "../jrd/req.h"
 #include "../jrd/ods.h"
 #include "../jrd/btr.h"
+#include "../jrd/IndexHistogram.h"
+#include "../jrd/IndexBulkInsert.h"
 #include "../jrd/sort.h"
 #include "../jrd/lls.h"
 #include "../jrd/tra.h"
@@ -50,6 +52,7 @@
 #include "../jrd/btr_proto.h"
 #include "../jrd/cch_proto.h"
 #include "../jrd/cmp_proto.h"
+#include "../jrd/dfw_proto.h"
 #include "../jrd/dpm_proto.h"
 #include "../jrd/err_proto.h"
 #include "../jrd/evl_proto.h"
@@ -77,8 +80,10 @@ static bool cmpRecordKeys(thread_db*, Record*, jrd_rel*, index_desc*, Record*, j
 static bool duplicate_key(const UCHAR*, const UCHAR*, void*);
 static PageNumber get_root_page(thread_db*, jrd_rel*);
 static int index_block_flush(void*);
+static int index_histogram_flush(void*);
 static idx_e insert_key(thread_db*, jrd_rel*, Record*, jrd_tra*, WIN *, index_insertion*, IndexErrorContext&);
 static void release_index_block(thread_db*, IndexBlock*);
+static void release_index_histogram(thread_db*, IndexBlock*);
 static void signal_index_deletion(thread_db*, jrd_rel*, USHORT);
 
 
@@ -1017,6 +1022,14 @@ IndexBlock* IDX_create_index_block(thread_db* tdbb, jrd_rel* relation, USHORT id
 			Lock(tdbb, sizeof(SLONG), LCK_expression, index_block, index_block_flush);
 		index_block->idb_lock = lock;
 		lock->setKey((relation->rel_id << 16) | index_block->idb_id);
+
+		// histogram has its own lock, so updating it doesn't
+		// make everybody recompile the index expression
+
+		lock = FB_NEW_RPT(*relation->rel_pool, 0)
+			Lock(tdbb, sizeof(SLONG), LCK_idx_histogram, index_block, index_histogram_flush);
+		index_block->idb_histogram_lock = lock;
+		lock->setKey((relation->rel_id << 16) | index_block->idb_id);
 	}
 
 	return index_block;
@@ -1164,6 +1177,10 @@ void IDX_garbage_collect(thread_db* tdbb, record_param* rpb, RecordStack& going,
 	insertion.iib_relation = rpb->rpb_relation;
 	insertion.iib_btr_level = 0;
 
+	// Keys to be removed could still wait for insertion
+
+	IndexBulkInsert::flush(tdbb, rpb->rpb_relation);
+
 	WIN window(get_root_page(tdbb, rpb->rpb_relation));
 
 	index_root_page* root = (index_root_page*) CCH_FETCH(tdbb, &window, LCK_read, pag_root);
@@ -1501,7 +1518,45 @@ void IDX_modify_flag_uk_modified(thread_db* tdbb,
 }
 
 
-void IDX_statistics(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity)
+void IDX_reset_histogram(thread_db* tdbb, jrd_rel* relation, USHORT id)
+{
+/**************************************
+ *
+ *	I D X _ r e s e t _ h i s t o g r a m
+ *
+ **************************************
+ *
+ * Functional description
+ *	Histogram of the index was updated and committed,
+ *	force all attachments to forget the cached one.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+
+	// Own histogram goes first, so our lock doesn't conflict with the exclusive one
+
+	for (IndexBlock* index_block = relation->rel_index_blocks; index_block;
+		index_block = index_block->idb_next)
+	{
+		if (index_block->idb_id == id)
+		{
+			release_index_histogram(tdbb, index_block);
+			break;
+		}
+	}
+
+	Lock temp(tdbb, sizeof(SLONG), LCK_idx_histogram);
+	temp.setKey((relation->rel_id << 16) | id);
+
+	if (LCK_lock(tdbb, &temp, LCK_EX, LCK_WAIT))
+		LCK_release(tdbb, &temp);
+	else
+		fb_utils::init_status(tdbb->tdbb_status_vector);
+}
+
+
+void IDX_statistics(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityList& selectivity,
+	IndexHistogram* histogram)
 {
 /**************************************
  *
@@ -1511,13 +1566,157 @@ void IDX_statistics(thread_db* tdbb, jrd_rel* relation, USHORT id, SelectivityLi
  *
  * Functional description
  *	Scan index pages recomputing
- *	selectivity.
+ *	selectivity and, optionally,
+ *	the histogram of index keys.
  *
  **************************************/
 
 	SET_TDBB(tdbb);
 
-	BTR_selectivity(tdbb, relation, id, selectivity);
+	IndexBulkInsert::flush(tdbb, relation, id);
+
+	BTR_selectivity(tdbb, relation, id, selectivity, histogram);
+}
+
+
+void IDX_sample_columns(thread_db* tdbb, jrd_rel* relation, jrd_tra* transaction,
+	ColumnHistograms& histograms)
+{
+/**************************************
+ *
+ *	I D X _ s a m p l e _ c o l u m n s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Build histograms of the relation columns
+ *	from a sample of records. Data pages are
+ *	picked evenly through the relation, their
+ *	records are reservoir sampled.
+ *
+ **************************************/
+	SET_TDBB(tdbb);
+	Database* const dbb = tdbb->getDatabase();
+	MemoryPool& pool = *tdbb->getDefaultPool();
+
+	const ULONG MAX_SAMPLE_PAGES = 300;
+	const FB_SIZE_T MAX_SAMPLE_RECORDS = 30000;
+
+	MET_scan_relation(tdbb, relation);
+
+	const Format* const format = MET_current(tdbb, relation);
+	const vec<jrd_fld*>* const fields = relation->rel_fields;
+
+	// Column values are turned into the keys of a single segment index on the column
+
+	struct Column
+	{
+		index_desc idx;
+		IndexHistogram* histogram;
+	};
+
+	HalfStaticArray<Column, 16> columns;
+
+	for (USHORT id = 0; id < format->fmt_count; id++)
+	{
+		const dsc& desc = format->fmt_desc[id];
+		const jrd_fld* const field = (fields && id < fields->count()) ? (*fields)[id] : nullptr;
+
+		// Skip dropped and computed fields, blobs and arrays cannot be keys
+
+		if (!field || field->fld_computation || !desc.dsc_dtype || DTYPE_IS_BLOB(desc.dsc_dtype))
+			continue;
+
+		Column column;
+		MOVE_CLEAR(&column.idx, sizeof(index_desc));
+		column.idx.idx_id = idx_invalid;
+		column.idx.idx_count = 1;
+		column.idx.idx_rpt[0].idx_field = id;
+		column.idx.idx_rpt[0].idx_itype =
+			DFW_assign_index_type(tdbb, relation->rel_name, desc.dsc_dtype, desc.getTextType());
+
+		RefPtr<IndexHistogram> histogram(FB_NEW_POOL(pool) IndexHistogram(pool));
+		histogram->setKeyType(column.idx.idx_rpt[0].idx_itype);
+		histograms.add(id, 0, histogram);
+
+		column.histogram = histogram;
+		columns.add(column);
+	}
+
+	if (columns.isEmpty())
+		return;
+
+	const ULONG dataPages = DPM_data_pages(tdbb, relation);
+	const ULONG sequences = DPM_pointer_pages(tdbb, relation) * dbb->dbb_dp_per_pp;
+
+	if (!dataPages)
+		return;
+
+	// Random start within the step, so repeated runs look at different pages
+
+	Attachment* const attachment = tdbb->getAttachment();
+	const ULONG step = MAX(sequences / MAX_SAMPLE_PAGES, 1);
+
+	ULONG first;
+	attachment->att_random_generator.getBytes(&first, sizeof(first));
+	first %= step;
+
+	record_param rpb;
+	rpb.rpb_relation = relation;
+
+	FB_UINT64 recordCount = 0;
+	ULONG pageCount = 0;
+
+	for (ULONG sequence = first; sequence < sequences; sequence += step)
+	{
+		rpb.rpb_number.setValue(((SINT64) sequence * dbb->dbb_max_records) - 1);
+
+		bool found = false;
+
+		// Empty and missing data pages return nothing
+
+		while (VIO_next_record(tdbb, &rpb, transaction, &pool, DPM_next_data_page))
+		{
+			found = true;
+
+			// Every record seen so far has the same chance to stay in the sample
+
+			FB_UINT64 position = recordCount++;
+
+			if (position >= MAX_SAMPLE_RECORDS)
+			{
+				FB_UINT64 random;
+				attachment->att_random_generator.getBytes(&random, sizeof(random));
+				position = random % recordCount;
+
+				if (position >= MAX_SAMPLE_RECORDS)
+					continue;
+			}
+
+			for (auto& column : columns)
+			{
+				IndexKey key(tdbb, relation, &column.idx);
+
+				// Too long keys are not sampled, they're rare enough to not matter
+				if (key.compose(rpb.rpb_record) == idx_e_ok)
+					column.histogram->addSample((FB_SIZE_T) position, key->key_data, key->key_length);
+			}
+		}
+
+		if (found)
+			pageCount++;
+
+		JRD_reschedule(tdbb);
+	}
+
+	delete rpb.rpb_record;
+
+	// Records of the sampled pages stand for all the data pages
+
+	const FB_UINT64 totalCount = pageCount ? recordCount * dataPages / pageCount : 0;
+
+	for (auto& column : columns)
+		column.histogram->finishSample(MAX(totalCount, recordCount));
 }
 
 
@@ -1550,6 +1749,9 @@ void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 	RelationPages* relPages = rpb->rpb_relation->getPages(tdbb);
 	WIN window(relPages->rel_pg_space_id, -1);
 
+	// Large loads collect keys of non-unique indices to insert them later in index order
+	IndexBulkInsert* const bulkInsert = IndexBulkInsert::start(tdbb, transaction, rpb->rpb_relation);
+
 	while (BTR_next_index(tdbb, rpb->rpb_relation, transaction, &idx, &window))
 	{
 		IndexErrorContext context(rpb->rpb_relation, &idx);
@@ -1583,6 +1785,19 @@ void IDX_store(thread_db* tdbb, record_param* rpb, jrd_tra* transaction)
 
 		insertion.iib_key = key;
 
+		// Keys of foreign key indices are checked by partners of the master record,
+		// so they can't be deferred
+
+		if (bulkInsert && !(idx.idx_flags & (idx_unique | idx_primary | idx_foreign)))
+		{
+			CCH_RELEASE(tdbb, &window);
+
+			if (bulkInsert->add(tdbb, rpb->rpb_relation, &idx, key, rpb->rpb_number))
+				continue;
+
+			CCH_FETCH(tdbb, &window, LCK_read, pag_root);
+		}
+
 		if ( (error_code = insert_key(tdbb, rpb->rpb_relation, rpb->rpb_record, transaction,
 									  &window, &insertion, context)) )
 		{
@@ -2086,6 +2301,37 @@ static int index_block_flush(void* ast_object)
 }
 
 
+static int index_histogram_flush(void* ast_object)
+{
+/**************************************
+ *
+ *	i n d e x _ h i s t o g r a m _ f l u s h
+ *
+ **************************************
+ *
+ * Functional description
+ *	Histogram of the index was updated,
+ *	forget the cached one.
+ *
+ **************************************/
+	IndexBlock* const index_block = static_cast<IndexBlock*>(ast_object);
+
+	try
+	{
+		Lock* const lock = index_block->idb_histogram_lock;
+		Database* const dbb = lock->lck_dbb;
+
+		AsyncContextHolder tdbb(dbb, FB_FUNCTION, lock);
+
+		release_index_histogram(tdbb, index_block);
+	}
+	catch (const Firebird::Exception&)
+	{} // no-op
+
+	return 0;
+}
+
+
 static idx_e insert_key(thread_db* tdbb,
 						jrd_rel* relation,
 						Record* record,
@@ -2171,11 +2417,38 @@ static void release_index_block(thread_db* tdbb, IndexBlock* index_block)
 	}
 	index_block->idb_condition = nullptr;
 
+	release_index_histogram(tdbb, index_block);
+
 	if (index_block->idb_lock)
 		LCK_release(tdbb, index_block->idb_lock);
 }
 
 
+static void release_index_histogram(thread_db* tdbb, IndexBlock* index_block)
+{
+/**************************************
+ *
+ *	r e l e a s e _ i n d e x _ h i s t o g r a m
+ *
+ **************************************
+ *
+ * Functional description
+ *	Release the cached histogram of index keys.
+ *	Statements being compiled may still hold it.
+ *
+ **************************************/
+	if (index_block->idb_histogram)
+	{
+		index_block->idb_histogram->release();
+		index_block->idb_histogram = nullptr;
+	}
+	index_block->idb_histogram_loaded = false;
+
+	if (index_block->idb_histogram_lock)
+		LCK_release(tdbb, index_block->idb_histogram_lock);
+}
+
+
 static void signal_index_deletion(thread_db* tdbb, jrd_rel* relation, USHORT id)
 {
 /**************************************
@@ -37,6 +37,7 @@ namespace Jrd
 	struct index_desc;
 	class CompilerScratch;
 	class thread_db;
+	class ColumnHistograms;
 }
 
 void IDX_check_access(Jrd::thread_db*, Jrd::CompilerScratch*, Jrd::jrd_rel*, Jrd::jrd_rel*);
@@ -50,7 +51,10 @@ void IDX_erase(Jrd::thread_db*, Jrd::record_param*, Jrd::jrd_tra*);
 void IDX_garbage_collect(Jrd::thread_db*, Jrd::record_param*, Jrd::RecordStack&, Jrd::RecordStack&);
 void IDX_modify(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*, Jrd::jrd_tra*);
 void IDX_modify_check_constraints(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*, Jrd::jrd_tra*);
-void IDX_statistics(Jrd::thread_db*, Jrd::jrd_rel*, USHORT, Jrd::SelectivityList&);
+void IDX_reset_histogram(Jrd::thread_db*, Jrd::jrd_rel*, USHORT);
+void IDX_sample_columns(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::jrd_tra*, Jrd::ColumnHistograms&);
+void IDX_statistics(Jrd::thread_db*, Jrd::jrd_rel*, USHORT, Jrd::SelectivityList&,
+	Jrd::IndexHistogram* = nullptr);
 void IDX_store(Jrd::thread_db*, Jrd::record_param*, Jrd::jrd_tra*);
 void IDX_modify_flag_uk_modified(Jrd::thread_db*, Jrd::record_param*, Jrd::record_param*, Jrd::jrd_tra*);
 
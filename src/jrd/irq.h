@@ -179,6 +179,8 @@ enum irq_type_t
 	irq_func_param_dep,		// check function parameter dependency
 	irq_l_pub_tab_state,	// lookup publication state for a table
 	irq_l_index_cnstrt,     // lookup index for constraint
+	irq_l_index_hist,		// lookup index histogram
+	irq_l_column_hist,		// lookup column histograms
 
 	irq_MAX
 };
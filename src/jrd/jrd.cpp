@@ -8638,6 +8638,7 @@ static void purge_attachment(thread_db* tdbb, StableAttachmentPart* sAtt, unsign
 	}
 
 	attachment->releaseProfilerManager(tdbb);
+	attachment->releaseSortCoordinator(tdbb);
 
 	// stop crypt thread using this attachment
 	dbb->dbb_crypto_manager->stopThreadUsing(tdbb, attachment);
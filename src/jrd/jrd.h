@@ -123,6 +123,7 @@ class jrd_rel;
 class ExternalFile;
 class ViewContext;
 class IndexBlock;
+class IndexHistogram;
 class IndexLock;
 class ArrayField;
 struct sort_context;
@@ -307,7 +308,10 @@ public:
 	dsc			idb_expression_desc;		// descriptor for expression result
 	BoolExprNode* idb_condition;			// node tree for index condition
 	Statement* idb_condition_statement;		// statement for index condition evaluation
+	IndexHistogram* idb_histogram;			// distribution of leading segment keys (referenced)
+	bool		idb_histogram_loaded;		// histogram was looked up (it may be missing)
 	Lock*		idb_lock;					// lock to synchronize changes to index
+	Lock*		idb_histogram_lock;			// lock to discard histogram when it's updated
 	USHORT		idb_id;
 };
 
@@ -643,6 +647,13 @@ public:
 		// We don't bump counters for dbbStat here, they're merged from attStats on demand
 	}
 
+	void bumpStats(const TempStatType type, SINT64 delta = 1)
+	{
+		reqStat->bumpValue(type, delta);
+		traStat->bumpValue(type, delta);
+		attStat->bumpValue(type, delta);
+	}
+
 	ISC_STATUS getCancelState(ISC_STATUS* secondary = NULL);
 	void checkCancelState();
 	void reschedule();
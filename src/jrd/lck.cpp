@@ -604,6 +604,8 @@ static lck_owner_t get_owner_type(enum lck_t lock_type)
 	case LCK_repl_tables:
 	case LCK_dsql_statement_cache:
 	case LCK_profiler_listener:
+	case LCK_gen_cache:
+	case LCK_idx_histogram:
 		owner_type = LCK_OWNER_attachment;
 		break;
 
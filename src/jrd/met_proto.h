@@ -51,6 +51,7 @@ namespace Jrd
 	struct FieldInfo;
 	class ExceptionItem;
 	class LocalTemporaryTable;
+	class ColumnHistograms;
 
 	// index status
 	enum IndexStatus
@@ -108,13 +109,17 @@ void		MET_lookup_cnstrt_for_trigger(Jrd::thread_db*, Jrd::MetaName&, Jrd::Qualif
 void		MET_lookup_exception(Jrd::thread_db*, SLONG, /* OUT */ Jrd::QualifiedName&, /* OUT */ Firebird::string*);
 int			MET_lookup_field(Jrd::thread_db*, Jrd::jrd_rel*, const Jrd::MetaName&);
 Jrd::BlobFilter*	MET_lookup_filter(Jrd::thread_db*, SSHORT, SSHORT);
-bool		MET_load_generator(Jrd::thread_db*, Jrd::GeneratorItem&, bool* sysGen = 0, SLONG* step = 0);
+bool		MET_load_generator(Jrd::thread_db*, Jrd::GeneratorItem&, bool* sysGen = 0, SLONG* step = 0,
+	SLONG* cacheSize = 0);
 SLONG		MET_lookup_generator(Jrd::thread_db*, const Jrd::QualifiedName&, bool* sysGen = 0, SLONG* step = 0);
 bool		MET_lookup_generator_id(Jrd::thread_db*, SLONG, Jrd::QualifiedName&, bool* sysGen = 0);
 void		MET_update_generator_increment(Jrd::thread_db* tdbb, SLONG gen_id, SLONG step);
 void		MET_lookup_index(Jrd::thread_db*, Jrd::QualifiedName&, const Jrd::QualifiedName&, USHORT);
 void		MET_lookup_index_condition(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::index_desc*);
 void		MET_lookup_index_expression(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::index_desc*);
+void		MET_lookup_index_histogram(Jrd::thread_db*, Jrd::jrd_rel*, Jrd::index_desc*);
+Jrd::ColumnHistograms*	MET_lookup_column_histograms(Jrd::thread_db*, Jrd::jrd_rel*);
+void		MET_reset_column_histograms(Jrd::thread_db*, Jrd::jrd_rel*);
 bool		MET_lookup_index_expr_cond_blr(Jrd::thread_db* tdbb, const Jrd::QualifiedName& index_name,
 	Jrd::bid& expr_blob_id, Jrd::bid& cond_blob_id);
 SLONG		MET_lookup_index_name(Jrd::thread_db*, const Jrd::QualifiedName&, SLONG*, Jrd::IndexStatus* status);
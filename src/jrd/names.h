@@ -306,6 +306,9 @@ NAME("MON$EXPLAINED_PLAN", nam_mon_expl_plan)
 NAME("MON$FORCED_WRITES", nam_mon_forced_writes)
 NAME("MON$FRAGMENT_READS", nam_mon_fragment_reads)
 NAME("MON$GARBAGE_COLLECTION", nam_mon_gc)
+NAME("MON$HASH_PARTITIONS", nam_mon_hash_partitions)
+NAME("MON$HASH_SPILLS", nam_mon_hash_spills)
+NAME("MON$HASH_SPILL_BYTES", nam_mon_hash_spill_bytes)
 NAME("MON$IO_STATS", nam_mon_io_stats)
 NAME("MON$ISOLATION_MODE", nam_mon_iso_mode)
 NAME("MON$LOCK_TIMEOUT", nam_mon_lock_timeout)
@@ -331,6 +334,8 @@ NAME("MON$PACKAGE_NAME", nam_mon_pkg_name)
 NAME("MON$PAGE_BUFFERS", nam_mon_page_bufs)
 NAME("MON$PAGE_FETCHES", nam_mon_page_fetches)
 NAME("MON$PAGE_MARKS", nam_mon_page_marks)
+NAME("MON$PAGE_PREFETCHES", nam_mon_page_prefetches)
+NAME("MON$PAGE_PREFETCH_HITS", nam_mon_page_prefetch_hits)
 NAME("MON$PAGE_READS", nam_mon_page_reads)
 NAME("MON$PAGE_WRITES", nam_mon_page_writes)
 NAME("MON$PAGES", nam_mon_pages)
@@ -505,3 +510,19 @@ NAME("MON$FIELD_PRECISION", nam_mon_f_precision)
 NAME("MON$FIELD_SUB_TYPE", nam_mon_f_sub_type)
 NAME("MON$CHAR_LENGTH", nam_mon_char_length)
 NAME("MON$COLLATION_ID", nam_mon_collate_id)
+
+NAME("MON$PAGE_REPLACEMENT", nam_mon_page_repl)
+NAME("MON$PAGE_CACHE_HITS", nam_mon_cache_hits)
+NAME("MON$PAGE_CACHE_MISSES", nam_mon_cache_misses)
+NAME("MON$PAGE_CACHE_PARTITIONS", nam_mon_cache_partitions)
+NAME("MON$PARTITION_ID", nam_mon_partition_id)
+NAME("MON$NUMA_NODE", nam_mon_numa_node)
+
+NAME("RDB$HISTOGRAM", nam_histogram)
+
+NAME("RDB$GENERATOR_CACHE", nam_gen_cache)
+NAME("MON$SEQUENCE_CACHES", nam_mon_seq_caches)
+NAME("MON$SEQUENCE_NAME", nam_mon_seq_name)
+NAME("MON$CACHE_SIZE", nam_mon_cache_size)
+NAME("MON$NEXT_VALUE", nam_mon_next_value)
+NAME("MON$LAST_VALUE", nam_mon_last_value)
@@ -242,6 +242,15 @@ inline constexpr bool pag_crypt_page[pag_max + 1] = {false, false, false,
 // pag_flags for any page type
 
 inline constexpr UCHAR crypted_page	= 0x80;		// Page on disk is encrypted (in memory cache it always isn't)
+inline constexpr UCHAR compressed_page	= 0x40;		// Page on disk is compressed (in memory cache it always isn't)
+
+// Compressed data or blob page keeps its header, except for pag_reserved that contains
+// the length of the rest of the page compressed in LZ4 block format. The page tail
+// is zeroed and is released to the file system, if it supports sparse files.
+// Compressed pages are never encrypted. They are written only after hdr_compressed_pages
+// is set in the database header.
+
+inline constexpr ULONG COMPRESSED_PAGE_BLOCK = 4096;	// unit of the page tail released to the file system
 
 // Basic page header
 
@@ -249,7 +258,7 @@ struct pag
 {
 	UCHAR pag_type;
 	UCHAR pag_flags;
-	USHORT pag_reserved;		// not used but anyway present because of alignment rules
+	USHORT pag_reserved;		// compressed length of compressed_page, otherwise not used
 	ULONG pag_generation;
 	ULONG pag_scn;
 	ULONG pag_pageno;			// for validation
@@ -369,6 +378,7 @@ inline constexpr UCHAR dpg_large		= 0x04;		// Large object is on page
 inline constexpr UCHAR dpg_swept		= 0x08;		// Sweep has nothing to do on this page
 inline constexpr UCHAR dpg_secondary	= 0x10;		// Primary record versions not stored on this page
 													// Set in dpm.epp's extend_relation() but never tested.
+inline constexpr UCHAR dpg_all_visible	= 0x20;		// Records on this page are visible to all transactions
 
 
 // Index root page
@@ -599,6 +609,11 @@ inline constexpr USHORT hdr_no_reserve			= 0x8;		// 8	don't reserve space for ve
 inline constexpr USHORT hdr_SQL_dialect_3		= 0x10;		// 16	database SQL dialect 3
 inline constexpr USHORT hdr_read_only			= 0x20;		// 32	Database is ReadOnly. If not set, DB is RW
 inline constexpr USHORT hdr_encrypted			= 0x40;		// 64	Database is encrypted
+inline constexpr USHORT hdr_compressed_pages	= 0x80;		// 128	Pages could be stored compressed on disk
+
+// Database is refused if any other flag is set in its header
+inline constexpr USHORT hdr_known_flags = hdr_active_shadow | hdr_force_write | hdr_crypt_process |
+	hdr_no_reserve | hdr_SQL_dialect_3 | hdr_read_only | hdr_encrypted | hdr_compressed_pages;
 
 // Values for backup mode
 inline constexpr UCHAR hdr_nbak_normal			= 0;			// Normal mode. Changes are simply written to main files
@@ -717,6 +732,11 @@ inline constexpr UCHAR ppg_dp_large			= 0x02;		// Large object is on data page
 inline constexpr UCHAR ppg_dp_swept			= 0x04;		// Sweep has nothing to do on data page
 inline constexpr UCHAR ppg_dp_secondary		= 0x08;		// Primary record versions not stored on data page
 inline constexpr UCHAR ppg_dp_empty			= 0x10;		// Data page is empty
+inline constexpr UCHAR ppg_dp_all_visible	= 0x20;		// Records on data page are visible to all transactions
+
+// All visible flags are set by sweep together with swept ones, when every record on the data
+// page is also created by a transaction older than the oldest snapshot. Any modification of
+// the page clears both. Records of such pages are counted without checking their versions.
 
 inline constexpr UCHAR PPG_DP_ALL_BITS	= (1 << PPG_DP_BITS_NUM) - 1;
 
@@ -887,6 +907,7 @@ inline constexpr USHORT rhd_gc_active		= 256;		// garbage collecting dead record
 inline constexpr USHORT rhd_uk_modified		= 512;		// record key field values are changed
 inline constexpr USHORT rhd_long_tranum		= 1024;		// transaction number is 64-bit
 inline constexpr USHORT rhd_not_packed		= 2048;		// record (or delta) is stored "as is"
+inline constexpr USHORT rhd_encoded			= 4096;		// record uses column-aware encoding
 
 
 // This (not exact) copy of class DSC is used to store descriptors on disk.
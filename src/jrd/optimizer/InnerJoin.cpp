@@ -228,15 +228,25 @@ void InnerJoin::estimateCost(unsigned position,
 		//  - probing the hash table and copying the matched rows
 
 		const auto hashCardinality = stream->baseSelectivity * streamCardinality;
-		const auto hashCost = stream->baseCost +
+		const auto hashBuildCost = stream->baseCost +
 			// hashing cost
-			hashCardinality * (COST_FACTOR_MEMCOPY + COST_FACTOR_HASHING) +
-			// probing + copying cost
-			cardinality * (COST_FACTOR_HASHING + currentCardinality * COST_FACTOR_MEMCOPY);
+			hashCardinality * (COST_FACTOR_MEMCOPY + COST_FACTOR_HASHING);
+		// probing + copying cost (per prior row)
+		const auto hashProbeCost = COST_FACTOR_HASHING + currentCardinality * COST_FACTOR_MEMCOPY;
+		const auto hashCost = hashBuildCost + cardinality * hashProbeCost;
 
-		if (hashCost <= loopCost && hashCardinality <= HashJoin::maxCapacity())
+		// If the nested loop is cheaper, it may still switch to hashing at runtime
+		// (see AdaptiveJoin), provided that the prior streams return more rows
+		// than estimated. Hashing becomes cheaper past the break-even point,
+		// it exists if a single loop iteration costs more than a single probe.
+
+		const bool preferHash = (hashCost <= loopCost);
+		const bool adaptive = (!preferHash && candidate->cost > hashProbeCost);
+
+		if ((preferHash || adaptive) && hashCardinality <= HashJoin::maxCapacity())
 		{
-			auto& equiMatches = joinedStreams[position].equiMatches;
+			auto& equiMatches = adaptive ?
+				joinedStreams[position].adaptiveMatches : joinedStreams[position].equiMatches;
 			fb_assert(!equiMatches.hasData());
 
 			// Scan the matches for possible equi-join conditions
@@ -266,9 +276,18 @@ void InnerJoin::estimateCost(unsigned position,
 				}
 			}
 
-			// Adjust the actual cost value, if hash joining is both possible and preferrable
+			// Adjust the actual cost value, if hash joining is both possible and preferrable.
+			// Otherwise remember the break-even point for the adaptive join.
 			if (equiMatches.hasData())
-				cost = hashCost;
+			{
+				if (adaptive)
+				{
+					joinedStreams[position].adaptiveCardinality =
+						hashBuildCost / (candidate->cost - hashProbeCost);
+				}
+				else
+					cost = hashCost;
+			}
 		}
 	}
 
@@ -506,6 +525,8 @@ River* InnerJoin::formRiver()
 	if (bestCount != innerStreams.getCount())
 		sortPtr = nullptr;
 
+	const auto adaptiveFactor = tdbb->getDatabase()->dbb_config->getAdaptiveJoinFactor();
+
 	RecordSource* rsb;
 	StreamList streams;
 	HalfStaticArray<RecordSource*, OPT_STATIC_ITEMS> rsbs;
@@ -588,6 +609,100 @@ River* InnerJoin::formRiver()
 			// Clear priorly processed rsb's, as they're already incorporated into a hash join
 			rsbs.clear();
 		}
+		else if (rsbs.hasData() && // this is not the first stream
+			stream.adaptiveMatches.hasData() && adaptiveFactor && !plan &&
+			!optimizer->favorFirstRows() && !sortUtilized)
+		{
+			// The nested loop join was estimated to be cheaper, but the stream could be
+			// hash-joined to the prior ones as well. Prepare both retrievals and let the
+			// adaptive join switch to hashing if the prior streams return too many rows.
+
+			fb_assert(streams.hasData());
+
+			HalfStaticArray<unsigned, OPT_STATIC_ITEMS> loopFlags, hashFlags;
+
+			for (auto iter = optimizer->getConjuncts(); iter.hasData(); ++iter)
+				loopFlags.add(iter.getFlags());
+
+			RecordSource* hashRsb;
+
+			{	// scope
+				// Deactivate priorly joined streams
+				StreamStateHolder stateHolder(csb, streams);
+				stateHolder.deactivate();
+
+				// Create an independent retrieval
+				hashRsb = optimizer->generateRetrieval(stream.number, sortPtr, false, false);
+			}
+
+			// Start the nested loop retrieval from the same state of conjuncts
+
+			unsigned pos = 0;
+			for (auto iter = optimizer->getConjuncts(); iter.hasData(); ++iter, pos++)
+			{
+				hashFlags.add(iter.getFlags());
+				iter.setFlags(loopFlags[pos]);
+			}
+
+			rsb = optimizer->generateRetrieval(stream.number, sortPtr, false, false);
+
+			// Conjuncts used by the nested loop retrieval but not by the independent one
+			// must be applied to the hash join result
+
+			BoolExprNode* hashBoolean = nullptr;
+
+			pos = 0;
+			for (auto iter = optimizer->getConjuncts(); iter.hasData(); ++iter, pos++)
+			{
+				if ((iter & Optimizer::CONJUNCT_USED) && !(hashFlags[pos] & Optimizer::CONJUNCT_USED))
+				{
+					hashBoolean = hashBoolean ?
+						FB_NEW_POOL(getPool()) BinaryBoolNode(getPool(), blr_and, hashBoolean, *iter) :
+						*iter;
+				}
+			}
+
+			// Create a nested loop join from the priorly processed streams
+			const auto priorRsb = (rsbs.getCount() == 1) ? rsbs[0] :
+				FB_NEW_POOL(getPool()) NestedLoopJoin(csb, JoinType::INNER, rsbs.getCount(), rsbs.begin());
+
+			NestValueArray* keys[] = {
+				FB_NEW_POOL(getPool()) NestValueArray(getPool()),
+				FB_NEW_POOL(getPool()) NestValueArray(getPool())
+			};
+
+			for (const auto match : stream.adaptiveMatches)
+			{
+				NestConst<ValueExprNode> node1;
+				NestConst<ValueExprNode> node2;
+
+				if (!optimizer->getEquiJoinKeys(match, &node1, &node2))
+					fb_assert(false);
+
+				if (!node2->containsStream(stream.number))
+				{
+					fb_assert(node1->containsStream(stream.number));
+
+					// Swap the sides
+					std::swap(node1, node2);
+				}
+
+				keys[0]->add(node1);
+				keys[1]->add(node2);
+			}
+
+			// Switch to hashing when the prior streams return much more rows than estimated
+			// and enough of them to make hashing cheaper
+			const auto threshold = MAX(priorRsb->getCardinality() * adaptiveFactor,
+									   stream.adaptiveCardinality);
+
+			rsb = FB_NEW_POOL(getPool())
+				AdaptiveJoin(tdbb, csb, priorRsb, rsb, hashRsb, keys, hashBoolean,
+							 stream.selectivity, threshold);
+
+			// Clear priorly processed rsb's, as they're already incorporated into an adaptive join
+			rsbs.clear();
+		}
 		else
 		{
 			rsb = optimizer->generateRetrieval(stream.number, sortPtr, false, false);
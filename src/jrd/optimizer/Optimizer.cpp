@@ -66,6 +66,7 @@
 #include "../jrd/met_proto.h"
 #include "../jrd/mov_proto.h"
 #include "../jrd/par_proto.h"
+#include "../common/utils_proto.h"
 #include "../yvalve/gds_proto.h"
 #include "../jrd/DataTypeUtil.h"
 #include "../jrd/KeywordsTable.h"
@@ -85,6 +86,7 @@
 #include "../dsql/ExprNodes.h"
 #include "../dsql/StmtNodes.h"
 #include "../jrd/ConfigTable.h"
+#include "../jrd/IndexHistogram.h"
 
 #include "../jrd/optimizer/Optimizer.h"
 
@@ -599,7 +601,9 @@ Optimizer::Optimizer(thread_db* aTdbb, CompilerScratch* aCsb, RseNode* aRse,
 	  bedStreams(getPool()),
 	  keyStreams(getPool()),
 	  outerStreams(getPool()),
-	  conjuncts(getPool())
+	  conjuncts(getPool()),
+	  histograms(getPool()),
+	  columnHistograms(getPool())
 {
     // Ignore optimization for first rows in impossible cases
 	if (firstRows)
@@ -630,7 +634,9 @@ Optimizer::Optimizer(thread_db* aTdbb, CompilerScratch* aCsb, RseNode* aRse,
 	  bedStreams(getPool()),
 	  keyStreams(getPool()),
 	  outerStreams(getPool()),
-	  conjuncts(getPool())
+	  conjuncts(getPool()),
+	  histograms(getPool()),
+	  columnHistograms(getPool())
 {
 	for (BoolExprNodeStack::const_iterator iter(stack); iter.hasData(); ++iter)
 	{
@@ -666,6 +672,16 @@ Optimizer::~Optimizer()
 		csb->csb_rpt[compileStream].csb_idx = nullptr;
 	}
 
+	// Index descriptions pointing to histograms are gone, so don't need them anymore
+	for (const auto histogram : histograms)
+		histogram->release();
+
+	for (const auto streamHistograms : columnHistograms)
+	{
+		if (streamHistograms)
+			streamHistograms->release();
+	}
+
 	if (debugFile)
 		fclose(debugFile);
 }
@@ -1293,12 +1309,44 @@ void Optimizer::compileRelation(StreamType stream)
 			}
 		}
 
+		// Histograms of index keys are collected by SET STATISTICS for user relations only
+
+		if (!relation->isSystem() && !relation->isTemporary() && !relation->isLTT())
+		{
+			for (auto& idx : idxList)
+			{
+				// Keep the histogram referenced while optimizing,
+				// the index block may forget it meanwhile
+				MET_lookup_index_histogram(tdbb, relation, &idx);
+
+				if (idx.idx_histogram)
+					histograms.add(idx.idx_histogram);
+			}
+		}
+
 		if (idxList.hasData())
 			tail->csb_idx = FB_NEW_POOL(getPool()) IndexDescList(getPool(), idxList);
 
 		if (tail->csb_plan)
 			markIndices(tail, relation->rel_id);
 	}
+
+	// Histograms of column values are collected by SET STATISTICS TABLE, also for user relations only
+
+	if (conjuncts.hasData() && !relation->rel_file && !relation->isVirtual() &&
+		!relation->isSystem() && !relation->isTemporary() && !relation->isLTT())
+	{
+		if (const auto streamHistograms = MET_lookup_column_histograms(tdbb, relation))
+		{
+			if (stream >= columnHistograms.getCount())
+				columnHistograms.grow(stream + 1);
+
+			if (columnHistograms[stream])
+				columnHistograms[stream]->release();
+
+			columnHistograms[stream] = streamHistograms;
+		}
+	}
 }
 
 
@@ -3029,7 +3077,7 @@ RecordSource* Optimizer::generateRetrieval(StreamType stream,
 				}
 
 				if (!(iter & (CONJUNCT_MATCHED | CONJUNCT_JOINED)))
-					filterSelectivity *= getSelectivity(*iter);
+					filterSelectivity *= getSelectivity(*iter, stream);
 			}
 		}
 	}
@@ -3213,6 +3261,217 @@ bool Optimizer::getEquiJoinKeys(NestConst<ValueExprNode>& node1,
 	return true;
 }
 
+//
+// Estimate selectivity of the boolean restricting the stream. Comparisons of the stream
+// fields with literals use the histograms of column values, if they were collected.
+//
+
+double Optimizer::getSelectivity(const BoolExprNode* node, StreamType stream) const
+{
+	double selectivity;
+
+	if (getHistogramSelectivity(node, stream, selectivity))
+		return selectivity;
+
+	return getSelectivity(node);
+}
+
+
+//
+// Estimate selectivity of the stream field compared with literals using the histogram
+// of the column values. Return false if there's no histogram or the boolean doesn't fit.
+//
+
+bool Optimizer::getHistogramSelectivity(const BoolExprNode* node, StreamType stream,
+										double& selectivity) const
+{
+	if (stream >= columnHistograms.getCount() || !columnHistograms[stream])
+		return false;
+
+	const ValueExprNode* field = nullptr;
+	const ValueExprNode* value1 = nullptr;
+	const ValueExprNode* value2 = nullptr;
+	const ValueListNode* list = nullptr;
+	UCHAR blrOp = blr_eql;
+
+	if (const auto listNode = nodeAs<InListBoolNode>(node))
+	{
+		field = listNode->arg;
+		list = listNode->list;
+	}
+	else if (const auto cmpNode = nodeAs<ComparativeBoolNode>(node))
+	{
+		blrOp = cmpNode->blrOp;
+
+		switch (blrOp)
+		{
+			case blr_eql:
+			case blr_equiv:
+			case blr_gtr:
+			case blr_geq:
+			case blr_lss:
+			case blr_leq:
+				field = cmpNode->arg1;
+				value1 = cmpNode->arg2;
+
+				// Literal may go first, then the comparison is mirrored
+
+				if (!nodeIs<FieldNode>(field))
+				{
+					std::swap(field, value1);
+
+					switch (blrOp)
+					{
+						case blr_gtr:
+							blrOp = blr_lss;
+							break;
+						case blr_geq:
+							blrOp = blr_leq;
+							break;
+						case blr_lss:
+							blrOp = blr_gtr;
+							break;
+						case blr_leq:
+							blrOp = blr_geq;
+							break;
+					}
+				}
+				break;
+
+			case blr_between:
+				field = cmpNode->arg1;
+				value1 = cmpNode->arg2;
+				value2 = cmpNode->arg3;
+				break;
+
+			default:
+				return false;
+		}
+	}
+	else
+		return false;
+
+	const auto fieldNode = nodeAs<FieldNode>(field);
+
+	if (!fieldNode || fieldNode->fieldStream != stream)
+		return false;
+
+	SSHORT scale = 0;
+	const auto histogram = columnHistograms[stream]->get(fieldNode->fieldId, scale);
+
+	if (!histogram)
+		return false;
+
+	// The histogram was built of the keys of a single segment index on the column
+
+	index_desc idx;
+	MOVE_CLEAR(&idx, sizeof(index_desc));
+	idx.idx_id = idx_invalid;
+	idx.idx_count = 1;
+	idx.idx_rpt[0].idx_field = fieldNode->fieldId;
+	idx.idx_rpt[0].idx_itype = histogram->getKeyType();
+
+	temporary_key lower, upper;
+
+	if (list)
+	{
+		double total = 0;
+
+		for (const auto item : list->items)
+		{
+			if (!makeHistogramKey(&idx, item, scale, lower))
+				return false;
+
+			total += histogram->getEqualSelectivity(lower.key_data, lower.key_length);
+		}
+
+		selectivity = MIN(total, MAXIMUM_SELECTIVITY);
+		return true;
+	}
+
+	switch (blrOp)
+	{
+		case blr_eql:
+		case blr_equiv:
+			if (!makeHistogramKey(&idx, value1, scale, lower))
+				return false;
+
+			selectivity = histogram->getEqualSelectivity(lower.key_data, lower.key_length);
+			return true;
+
+		case blr_gtr:
+		case blr_geq:
+			if (!makeHistogramKey(&idx, value1, scale, lower))
+				return false;
+
+			selectivity = histogram->getRangeSelectivity(lower.key_data, lower.key_length,
+				(blrOp == blr_gtr), nullptr, 0, false);
+			return true;
+
+		case blr_lss:
+		case blr_leq:
+			if (!makeHistogramKey(&idx, value1, scale, upper))
+				return false;
+
+			selectivity = histogram->getRangeSelectivity(nullptr, 0, false,
+				upper.key_data, upper.key_length, (blrOp == blr_lss));
+			return true;
+
+		case blr_between:
+			if (!makeHistogramKey(&idx, value1, scale, lower) ||
+				!makeHistogramKey(&idx, value2, scale, upper))
+			{
+				return false;
+			}
+
+			selectivity = histogram->getRangeSelectivity(lower.key_data, lower.key_length, false,
+				upper.key_data, upper.key_length, false);
+			return true;
+	}
+
+	return false;
+}
+
+
+//
+// Make the leading segment key for the literal value, as it's stored in the histogram
+//
+
+bool Optimizer::makeHistogramKey(const index_desc* idx, const ValueExprNode* value, SSHORT scale,
+								 temporary_key& key) const
+{
+	if (!nodeIs<LiteralNode>(value))
+		return false;
+
+	const USHORT keyType = (idx->idx_flags & idx_unique) ? INTL_KEY_UNIQUE : INTL_KEY_SORT;
+
+	try
+	{
+		if (BTR_make_key(tdbb, 1, &value, &scale, idx, &key, keyType, nullptr) != idx_e_ok)
+			return false;
+	}
+	catch (const status_exception& ex)
+	{
+		// Value cannot be converted into the key, let it fail at execution if the index is used.
+		// Anything else (cancellation, I/O errors etc) is not ours to swallow.
+		const ISC_STATUS* const status = ex.value();
+
+		if (!(fb_utils::containsErrorCode(status, isc_convert_error) ||
+			fb_utils::containsErrorCode(status, isc_arith_except) ||
+			fb_utils::containsErrorCode(status, isc_decfloat_invalid_operation)))
+		{
+			throw;
+		}
+
+		return false;
+	}
+
+	key.key_length = IndexHistogram::getLeadingLength(key.key_data, key.key_length,
+		idx->idx_count, (idx->idx_flags & idx_descending));
+
+	return true;
+}
+
 
 //
 // Compose a table name (including alias, if specified) for the given stream
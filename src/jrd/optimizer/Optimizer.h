@@ -75,6 +75,8 @@ inline constexpr double DEFAULT_INDEX_COST = 3.0;
 
 struct index_desc;
 class jrd_rel;
+class IndexHistogram;
+class ColumnHistograms;
 class IndexTableScan;
 class ComparativeBoolNode;
 class InversionNode;
@@ -306,6 +308,11 @@ public:
 			return iter->flags;
 		}
 
+		void setFlags(unsigned flags) noexcept
+		{
+			iter->flags = flags;
+		}
+
 		void rewind() noexcept
 		{
 			iter = begin;
@@ -435,6 +442,10 @@ public:
 		return MIN(selectivity, MAXIMUM_SELECTIVITY / 2);
 	}
 
+	double getSelectivity(const BoolExprNode* node, StreamType stream) const;
+	bool makeHistogramKey(const index_desc* idx, const ValueExprNode* value, SSHORT scale,
+		temporary_key& key) const;
+
 	static void adjustSelectivity(double& selectivity, double factor) noexcept
 	{
 		selectivity = MIN(selectivity * factor, MAXIMUM_SELECTIVITY);
@@ -586,6 +597,8 @@ private:
 	bool getEquiJoinKeys(NestConst<ValueExprNode>& node1,
 						 NestConst<ValueExprNode>& node2,
 						 bool needCast);
+	bool getHistogramSelectivity(const BoolExprNode* node, StreamType stream,
+								 double& selectivity) const;
 	BoolExprNode* makeInferenceNode(BoolExprNode* boolean,
 									ValueExprNode* arg1,
 									ValueExprNode* arg2);
@@ -609,6 +622,8 @@ private:
 
 	StreamList compileStreams, bedStreams, keyStreams, outerStreams;
 	ConjunctList conjuncts;
+	Firebird::HalfStaticArray<const IndexHistogram*, OPT_STATIC_ITEMS> histograms;	// referenced by us
+	Firebird::HalfStaticArray<const ColumnHistograms*, OPT_STATIC_ITEMS> columnHistograms;	// per stream, referenced by us
 };
 
 
@@ -745,6 +760,8 @@ protected:
 	InversionNode* composeInversion(InversionNode* node1, InversionNode* node2,
 		InversionNode::Type node_type) const;
 	const Firebird::string& getAlias();
+	bool getHistogramSelectivity(const index_desc* idx, const IndexScratchSegment& segment,
+		double& selectivity) const;
 	void getInversionCandidates(InversionCandidateList& inversions,
 		IndexScratchList& indexScratches, unsigned scope) const;
 	InversionNode* makeIndexScanNode(IndexScratch* indexScratch) const;
@@ -902,11 +919,16 @@ class InnerJoin final : private Firebird::PermanentStorage
 			number = num;
 			selectivity = 0.0;
 			equiMatches.clear();
+			adaptiveMatches.clear();
+			adaptiveCardinality = 0.0;
 		}
 
 		StreamType number;			// stream in position of join order
 		double selectivity = 0.0;	// position selectivity
 		Firebird::Vector<BoolExprNode*, MAX_EQUI_MATCHES> equiMatches;
+		// equi-join conditions allowing the nested loop to switch to hashing at runtime
+		Firebird::Vector<BoolExprNode*, MAX_EQUI_MATCHES> adaptiveMatches;
+		double adaptiveCardinality = 0.0;	// prior rows to make hashing cheaper
 	};
 
 	typedef Firebird::HalfStaticArray<JoinedStreamInfo, OPT_STATIC_ITEMS> JoinedStreamList;
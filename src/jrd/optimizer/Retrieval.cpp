@@ -30,6 +30,7 @@
 #include "../jrd/btr.h"
 #include "../jrd/intl.h"
 #include "../jrd/Collation.h"
+#include "../jrd/IndexHistogram.h"
 #include "../jrd/ods.h"
 #include "../jrd/RecordSourceNodes.h"
 #include "../jrd/recsrc/RecordSource.h"
@@ -337,7 +338,7 @@ InversionCandidate* Retrieval::getInversion()
 			else if (iter->computable(csb, stream, true) &&
 				iter->containsStream(stream))
 			{
-				selectivity *= Optimizer::getSelectivity(*iter);
+				selectivity *= optimizer->getSelectivity(*iter, stream);
 			}
 
 			if (iter->computable(csb, INVALID_STREAM, false) &&
@@ -965,6 +966,7 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 			bool unique = false;
 			unsigned listCount = 0;
 			auto maxSelectivity = scratch.selectivity;
+			double skewFactor = 1;
 
 			for (unsigned j = 0; j < scratch.segments.getCount(); j++)
 			{
@@ -1003,12 +1005,38 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 
 				auto selectivity = idx->idx_rpt[j].idx_selectivity;
 				const auto useDefaultSelectivity = (selectivity <= 0);
+				double rangeSelectivity = 0;
 
 				// When the index selectivity is zero then the statement is prepared
 				// on an empty table or the statistics aren't updated. So assume every
 				// match to represent 1/10 of the maximum selectivity.
 				if (useDefaultSelectivity)
 					selectivity = MAX(scratch.selectivity * DEFAULT_SELECTIVITY, minSelectivity);
+				else if (j == 0)
+				{
+					// Values of the leading segment are not distributed uniformly as
+					// the selectivity assumes, so look them up in the histogram. Skew
+					// of the equality match is propagated to the next segments.
+					double estimation;
+					if (getHistogramSelectivity(idx, segment, estimation))
+					{
+						estimation = MAX(estimation, minSelectivity);
+
+						if (scanType == segmentScanBetween ||
+							scanType == segmentScanLess ||
+							scanType == segmentScanGreater)
+						{
+							rangeSelectivity = estimation;
+						}
+						else
+						{
+							skewFactor = estimation / selectivity;
+							selectivity = estimation;
+						}
+					}
+				}
+				else
+					selectivity = MIN(selectivity * skewFactor, scratch.selectivity);
 
 				if (scanType == segmentScanList)
 				{
@@ -1109,9 +1137,15 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 
 						// Adjust the compound selectivity using the reduce factor.
 						// It should be better than the previous segment but worse
-						// than a full match.
-						const double diffSelectivity = scratch.selectivity - selectivity;
-						selectivity += (diffSelectivity * factor);
+						// than a full match. Histogram of the leading segment keys
+						// provides the real estimation, if available.
+						if (rangeSelectivity > 0)
+							selectivity = rangeSelectivity;
+						else
+						{
+							const double diffSelectivity = scratch.selectivity - selectivity;
+							selectivity += (diffSelectivity * factor);
+						}
 						fb_assert(selectivity <= scratch.selectivity);
 						scratch.selectivity = selectivity;
 
@@ -1193,6 +1227,78 @@ void Retrieval::getInversionCandidates(InversionCandidateList& inversions,
 }
 
 
+//
+// Estimate the selectivity of the leading index segment using the histogram of index keys
+//
+
+bool Retrieval::getHistogramSelectivity(const index_desc* idx, const IndexScratchSegment& segment,
+										double& selectivity) const
+{
+	const auto histogram = idx->idx_histogram;
+
+	if (!histogram)
+		return false;
+
+	temporary_key lower, upper;
+
+	switch (segment.scanType)
+	{
+		case segmentScanEqual:
+		case segmentScanEquivalent:
+			if (!optimizer->makeHistogramKey(idx, segment.lowerValue, segment.scale, lower))
+				return false;
+
+			selectivity = histogram->getEqualSelectivity(lower.key_data, lower.key_length);
+			return true;
+
+		case segmentScanList:
+		{
+			// Average per value, it's multiplied by the list items count later
+
+			double total = 0;
+			for (const auto value : *segment.valueList)
+			{
+				if (!optimizer->makeHistogramKey(idx, value, segment.scale, lower))
+					return false;
+
+				total += histogram->getEqualSelectivity(lower.key_data, lower.key_length);
+			}
+
+			selectivity = total / segment.valueList->getCount();
+			return true;
+		}
+
+		case segmentScanBetween:
+		case segmentScanLess:
+		case segmentScanGreater:
+		{
+			const bool hasLower = (segment.scanType != segmentScanLess);
+			const bool hasUpper = (segment.scanType != segmentScanGreater);
+
+			if ((hasLower && !optimizer->makeHistogramKey(idx, segment.lowerValue, segment.scale, lower)) ||
+				(hasUpper && !optimizer->makeHistogramKey(idx, segment.upperValue, segment.scale, upper)))
+			{
+				return false;
+			}
+
+			// Keys of the descending index go backwards, while the exclusion
+			// flags are already set for the keys rather than for the values
+
+			const bool descending = (idx->idx_flags & idx_descending);
+			const auto first = descending ? (hasUpper ? &upper : nullptr) : (hasLower ? &lower : nullptr);
+			const auto last = descending ? (hasLower ? &lower : nullptr) : (hasUpper ? &upper : nullptr);
+
+			selectivity = histogram->getRangeSelectivity(
+				first ? first->key_data : nullptr, first ? first->key_length : 0, segment.excludeLower,
+				last ? last->key_data : nullptr, last ? last->key_length : 0, segment.excludeUpper);
+			return true;
+		}
+
+		default:
+			return false;
+	}
+}
+
 //
 // Search a dbkey (possibly a concatenated one) for a dbkey for specified stream
 //
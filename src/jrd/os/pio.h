@@ -38,11 +38,15 @@ namespace Jrd {
 
 #ifdef UNIX
 
+class IoRing;
+
 class jrd_file : public pool_alloc_rpt<SCHAR, type_fil>
 {
 public:
 	int fil_desc;
 	Firebird::Mutex fil_mutex;
+	Firebird::Mutex fil_ring_mutex;	// serializes use of fil_ring
+	IoRing* fil_ring;				// asynchronous I/O ring for batch reads, created on demand
 	USHORT fil_flags;
 	SCHAR fil_string[1];		// Expanded file name
 };
@@ -79,6 +83,7 @@ inline constexpr USHORT FIL_readonly		= 4;	// file opened in readonly mode
 inline constexpr USHORT FIL_sh_write		= 8;	// file opened in shared write mode
 inline constexpr USHORT FIL_no_fast_extend	= 16;	// file not supports fast extending
 inline constexpr USHORT FIL_raw_device		= 32;	// file is raw device
+inline constexpr USHORT FIL_no_punch_hole	= 64;	// file not supports releasing space of compressed pages
 
 // Physical IO trace events
 
@@ -50,6 +50,7 @@ USHORT	PIO_init_data(Jrd::thread_db* tdbb, Jrd::jrd_file* file, Jrd::FbStatusVec
 Jrd::jrd_file*	PIO_open(Jrd::thread_db*, const Firebird::PathName&,
 						 const Firebird::PathName&);
 bool	PIO_read(Jrd::thread_db*, Jrd::jrd_file*, Jrd::BufferDesc*, Ods::pag*, Jrd::FbStatusVector*);
+bool	PIO_read_pages(Jrd::thread_db*, Jrd::jrd_file*, Jrd::BufferDesc* const*, ULONG, Jrd::FbStatusVector*);
 
 #ifdef SUPERSERVER_V2
 bool	PIO_read_ahead(Jrd::thread_db*, SLONG, SCHAR*, SLONG,
@@ -48,6 +48,13 @@
 #ifdef HAVE_LINUX_FALLOC_H
 #include <linux/falloc.h>
 #endif
+#ifdef HAVE_LINUX_IO_URING_H
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <atomic>
+#endif
 
 #ifdef SUPPORT_RAW_DEVICES
 #include <sys/ioctl.h>
@@ -75,6 +82,7 @@
 #include "../jrd/ods_proto.h"
 #include "../jrd/os/pio_proto.h"
 #include "../common/classes/init.h"
+#include "../common/classes/auto.h"
 #include "../common/os/os_utils.h"
 
 using namespace Jrd;
@@ -132,6 +140,8 @@ using namespace Firebird;
 
 static const mode_t MASK = 0660;
 
+static bool read_page(jrd_file*, BufferDesc*, Ods::pag*, SLONG, FbStatusVector*);
+static void release_page_tail(jrd_file*, FB_UINT64, const Ods::pag*, SLONG);
 static bool seek_file(jrd_file*, BufferDesc*, FB_UINT64*, FbStatusVector*);
 static jrd_file* setup_file(Database*, const PathName&, int, USHORT);
 static void lockDatabaseFile(int& desc, const bool shareMode, const bool temporary,
@@ -149,6 +159,64 @@ static int  raw_devices_unlink_database (const PathName&);
 static int	openFile(const Firebird::PathName&, const bool, const bool, const bool);
 static void	maybeCloseFile(int&);
 
+#ifdef HAVE_LINUX_IO_URING_H
+
+namespace Jrd {
+
+// Minimal io_uring wrapper used to read a batch of pages with a single system
+// call instead of a pread() per page. liburing is not required: the rings are
+// set up and driven using raw system calls. The ring is not thread-safe, its
+// users are serialized by jrd_file::fil_ring_mutex.
+
+class IoRing
+{
+public:
+	static constexpr unsigned MAX_ENTRIES = 64;
+
+	~IoRing();
+
+	static IoRing* create(MemoryPool& pool);
+
+	unsigned getEntries() const
+	{
+		return m_entries;
+	}
+
+	bool read(int desc, unsigned count, Ods::pag* const* buffers, const FB_UINT64* offsets,
+		unsigned size, int* results);
+
+private:
+	IoRing() = default;
+
+	int m_ringDesc = -1;
+	unsigned m_entries = 0;
+
+	void* m_sqRing = MAP_FAILED;
+	size_t m_sqRingSize = 0;
+	void* m_cqRing = MAP_FAILED;
+	size_t m_cqRingSize = 0;
+	io_uring_sqe* m_sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+	size_t m_sqesSize = 0;
+
+	unsigned* m_sqHead = nullptr;
+	unsigned* m_sqTail = nullptr;
+	unsigned* m_sqArray = nullptr;
+	unsigned m_sqMask = 0;
+
+	unsigned* m_cqHead = nullptr;
+	unsigned* m_cqTail = nullptr;
+	io_uring_cqe* m_cqes = nullptr;
+	unsigned m_cqMask = 0;
+};
+
+} // namespace Jrd
+
+// Set when the kernel (or its security policy) doesn't allow to use io_uring,
+// then there is no reason to try it again for every file.
+static std::atomic<bool> ioRingUnsupported(false);
+
+#endif // HAVE_LINUX_IO_URING_H
+
 
 void PIO_close(jrd_file* file)
 {
@@ -165,6 +233,14 @@ void PIO_close(jrd_file* file)
  *
  **************************************/
 
+#ifdef HAVE_LINUX_IO_URING_H
+	{	// scope
+		MutexLockGuard guard(file->fil_ring_mutex, FB_FUNCTION);
+		delete file->fil_ring;
+		file->fil_ring = NULL;
+	}
+#endif
+
 	if (file->fil_desc && file->fil_desc != -1)
 	{
 		close(file->fil_desc);
@@ -763,10 +839,6 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
  *	Read a data page.  Oh wow.
  *
  **************************************/
-	int i;
-	SINT64 bytes;
-	FB_UINT64 offset;
-
 	if (file->fil_desc == -1)
 		return unix_error("read", file, isc_io_read_err, status_vector);
 
@@ -774,32 +846,93 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 
 	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
 
+	return read_page(file, bdb, page, dbb->dbb_page_size, status_vector);
+}
+
+
+bool PIO_read_pages(thread_db* tdbb, jrd_file* file, BufferDesc* const* bdbs, ULONG count,
+					FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a batch of data pages into the buffers of given
+ *	buffer descriptors. When possible, all the reads are
+ *	submitted to the kernel at once using io_uring. Pages
+ *	the ring failed to read completely, as well as all pages
+ *	when the ring is not available or busy with another
+ *	thread, are read one by one.
+ *
+ **************************************/
+	if (file->fil_desc == -1)
+		return unix_error("read", file, isc_io_read_err, status_vector);
+
+	Database* const dbb = tdbb->getDatabase();
 	const SLONG size = dbb->dbb_page_size;
 
-	for (i = 0; i < IO_RETRY; i++)
+	HalfStaticArray<int, 64> results;
+	results.resize(count);
+	memset(results.begin(), 0, count * sizeof(int));
+
+	EngineCheckout cout(tdbb, FB_FUNCTION, EngineCheckout::UNNECESSARY);
+
+#ifdef HAVE_LINUX_IO_URING_H
+	if (count > 1 && !ioRingUnsupported && file->fil_ring_mutex.tryEnter(FB_FUNCTION))
 	{
-		if (!seek_file(file, bdb, &offset, status_vector))
-			return false;
+		Cleanup leaveRing([file] { file->fil_ring_mutex.leave(); });
 
-		if ((bytes = os_utils::pread(file->fil_desc, page, size, LSEEK_OFFSET_CAST offset)) == size)
+		if (!file->fil_ring)
 		{
-			// os_utils::posix_fadvise(file->desc, offset, size, POSIX_FADV_NOREUSE);
-			return true;
+			file->fil_ring = IoRing::create(*dbb->dbb_permanent);
+			if (!file->fil_ring)
+				ioRingUnsupported = true;
 		}
 
-		// pread() returned error
-		if (bytes < 0 && !SYSCALL_INTERRUPTED(errno))
-			return unix_error("read", file, isc_io_read_err, status_vector);
+		HalfStaticArray<FB_UINT64, IoRing::MAX_ENTRIES> offsets;
+		HalfStaticArray<Ods::pag*, IoRing::MAX_ENTRIES> buffers;
 
-		// pread() returned not enough bytes
-		if (bytes >= 0)
+		for (ULONG done = 0; file->fil_ring && done < count; )
 		{
-			if (!block_size_error(file, offset + bytes, status_vector))
-				return false;
+			const unsigned batch = MIN(count - done, file->fil_ring->getEntries());
+
+			offsets.resize(batch);
+			buffers.resize(batch);
+
+			for (unsigned i = 0; i < batch; i++)
+			{
+				if (!seek_file(file, bdbs[done + i], &offsets[i], status_vector))
+					return false;
+
+				buffers[i] = bdbs[done + i]->bdb_buffer;
+			}
+
+			if (!file->fil_ring->read(file->fil_desc, batch, buffers.begin(), offsets.begin(),
+					size, results.begin() + done))
+			{
+				// Something is wrong with the ring itself, don't use it anymore.
+				// Pages not read yet are handled by the blocking code below.
+
+				delete file->fil_ring;
+				file->fil_ring = NULL;
+				ioRingUnsupported = true;
+			}
+
+			done += batch;
 		}
 	}
+#endif
 
-	return unix_error("read_retry", file, isc_io_read_err, status_vector);
+	for (ULONG i = 0; i < count; i++)
+	{
+		if (results[i] != size && !read_page(file, bdbs[i], bdbs[i]->bdb_buffer, size, status_vector))
+			return false;
+	}
+
+	return true;
 }
 
 
@@ -836,6 +969,10 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 		if ((bytes = os_utils::pwrite(file->fil_desc, page, size, LSEEK_OFFSET_CAST offset)) == size)
 		{
 			// os_utils::posix_fadvise(file->desc, offset, size, POSIX_FADV_DONTNEED);
+
+			if (page->pag_flags & Ods::compressed_page)
+				release_page_tail(file, offset, page, size);
+
 			return true;
 		}
 
@@ -847,6 +984,84 @@ bool PIO_write(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+static void release_page_tail(jrd_file* file, FB_UINT64 offset, const Ods::pag* page, SLONG size)
+{
+/**************************************
+ *
+ *	r e l e a s e _ p a g e _ t a i l
+ *
+ **************************************
+ *
+ * Functional description
+ *	Compressed page was written as a whole, with zeroed
+ *	tail. Release the tail to the file system, so it
+ *	takes no disk space and isn't read from disk.
+ *	Errors are ignored, the page is written anyway.
+ *
+ **************************************/
+#if defined(HAVE_LINUX_FALLOC_H) && defined(HAVE_FALLOCATE) && defined(FALLOC_FL_PUNCH_HOLE)
+	if (file->fil_flags & (FIL_no_punch_hole | FIL_raw_device))
+		return;
+
+	const SLONG used = FB_ALIGN(sizeof(Ods::pag) + page->pag_reserved, Ods::COMPRESSED_PAGE_BLOCK);
+
+	if (used >= size)
+		return;
+
+	if (fallocate(file->fil_desc, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+			LSEEK_OFFSET_CAST (offset + used), size - used))
+	{
+		if (errno == EOPNOTSUPP || errno == ENOSYS)
+			file->fil_flags |= FIL_no_punch_hole;
+	}
+#endif
+}
+
+
+static bool read_page(jrd_file* file, BufferDesc* bdb, Ods::pag* page, SLONG size,
+					  FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	r e a d _ p a g e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a page using blocking pread(), retrying
+ *	interrupted and incomplete reads.
+ *
+ **************************************/
+	SINT64 bytes;
+	FB_UINT64 offset;
+
+	for (int i = 0; i < IO_RETRY; i++)
+	{
+		if (!seek_file(file, bdb, &offset, status_vector))
+			return false;
+
+		if ((bytes = os_utils::pread(file->fil_desc, page, size, LSEEK_OFFSET_CAST offset)) == size)
+		{
+			// os_utils::posix_fadvise(file->desc, offset, size, POSIX_FADV_NOREUSE);
+			return true;
+		}
+
+		// pread() returned error
+		if (bytes < 0 && !SYSCALL_INTERRUPTED(errno))
+			return unix_error("read", file, isc_io_read_err, status_vector);
+
+		// pread() returned not enough bytes
+		if (bytes >= 0)
+		{
+			if (!block_size_error(file, offset + bytes, status_vector))
+				return false;
+		}
+	}
+
+	return unix_error("read_retry", file, isc_io_read_err, status_vector);
+}
+
+
 static bool seek_file(jrd_file* file, BufferDesc* bdb, FB_UINT64* offset,
 					  FbStatusVector* status_vector)
 {
@@ -951,6 +1166,7 @@ static jrd_file* setup_file(Database* dbb, const PathName& file_name, int desc,
 	{
 		file = FB_NEW_RPT(*dbb->dbb_permanent, file_name.length() + 1) jrd_file();
 		file->fil_desc = desc;
+		file->fil_ring = NULL;
 		file->fil_flags = flags;
 		strcpy(file->fil_string, file_name.c_str());
 	}
@@ -1064,6 +1280,195 @@ static bool block_size_error(const jrd_file* file, off_t offset, FbStatusVector*
 }
 
 
+#ifdef HAVE_LINUX_IO_URING_H
+
+IoRing* IoRing::create(MemoryPool& pool)
+{
+/**************************************
+ *
+ *	I o R i n g : : c r e a t e
+ *
+ **************************************
+ *
+ * Functional description
+ *	Set up a new ring and map its queues into our
+ *	address space. Return NULL if io_uring can't be used.
+ *
+ **************************************/
+	io_uring_params params;
+	memset(&params, 0, sizeof(params));
+
+	const int desc = syscall(__NR_io_uring_setup, MAX_ENTRIES, &params);
+	if (desc < 0)
+	{
+		gds__log("io_uring is not available (errno %d), pages are read one by one", errno);
+		return NULL;
+	}
+
+	AutoPtr<IoRing> ring(FB_NEW_POOL(pool) IoRing);
+	ring->m_ringDesc = desc;
+	ring->m_entries = params.sq_entries;
+
+	ring->m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring->m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+	// Since Linux 5.4 both queues are mapped at once
+	const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP);
+	if (singleMap)
+	{
+		ring->m_sqRingSize = MAX(ring->m_sqRingSize, ring->m_cqRingSize);
+		ring->m_cqRingSize = 0;
+	}
+
+	ring->m_sqRing = mmap(NULL, ring->m_sqRingSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, desc, IORING_OFF_SQ_RING);
+
+	if (ring->m_sqRing == MAP_FAILED)
+		return NULL;
+
+	if (singleMap)
+		ring->m_cqRing = ring->m_sqRing;
+	else
+	{
+		ring->m_cqRing = mmap(NULL, ring->m_cqRingSize, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, desc, IORING_OFF_CQ_RING);
+
+		if (ring->m_cqRing == MAP_FAILED)
+			return NULL;
+	}
+
+	ring->m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+	ring->m_sqes = static_cast<io_uring_sqe*>(mmap(NULL, ring->m_sqesSize, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, desc, IORING_OFF_SQES));
+
+	if (ring->m_sqes == MAP_FAILED)
+		return NULL;
+
+	UCHAR* const sq = static_cast<UCHAR*>(ring->m_sqRing);
+	ring->m_sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+	ring->m_sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+	ring->m_sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+	ring->m_sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+
+	UCHAR* const cq = static_cast<UCHAR*>(ring->m_cqRing);
+	ring->m_cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+	ring->m_cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+	ring->m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+	ring->m_cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+
+	return ring.release();
+}
+
+
+IoRing::~IoRing()
+{
+	if (m_sqes != MAP_FAILED)
+		munmap(m_sqes, m_sqesSize);
+
+	if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+		munmap(m_cqRing, m_cqRingSize);
+
+	if (m_sqRing != MAP_FAILED)
+		munmap(m_sqRing, m_sqRingSize);
+
+	if (m_ringDesc >= 0)
+		close(m_ringDesc);
+}
+
+
+bool IoRing::read(int desc, unsigned count, Ods::pag* const* buffers, const FB_UINT64* offsets,
+	unsigned size, int* results)
+{
+/**************************************
+ *
+ *	I o R i n g : : r e a d
+ *
+ **************************************
+ *
+ * Functional description
+ *	Submit reads of count pages and wait for all of them.
+ *	On return results[i] contains the number of bytes read
+ *	or a negated error code. Return false if the ring itself
+ *	failed and should not be used anymore.
+ *
+ **************************************/
+	fb_assert(count <= m_entries);
+
+	iovec iov[MAX_ENTRIES];
+
+	// There is a single submitter and all requests are completed before return,
+	// thus submission queue is always empty here and its tail is owned by us.
+
+	unsigned tail = *m_sqTail;
+	for (unsigned i = 0; i < count; i++, tail++)
+	{
+		iov[i].iov_base = buffers[i];
+		iov[i].iov_len = size;
+
+		const unsigned index = tail & m_sqMask;
+		io_uring_sqe* const sqe = &m_sqes[index];
+
+		memset(sqe, 0, sizeof(io_uring_sqe));
+		sqe->opcode = IORING_OP_READV;
+		sqe->fd = desc;
+		sqe->off = offsets[i];
+		sqe->addr = reinterpret_cast<FB_UINT64>(&iov[i]);
+		sqe->len = 1;
+		sqe->user_data = i;
+
+		m_sqArray[index] = index;
+		results[i] = 0;
+	}
+
+	std::atomic_ref<unsigned>(*m_sqTail).store(tail, std::memory_order_release);
+
+	unsigned submitted = 0, completed = 0, expected = count;
+	bool failed = false;
+
+	while (completed < expected)
+	{
+		const int rc = syscall(__NR_io_uring_enter, m_ringDesc, expected - submitted,
+			expected - completed, IORING_ENTER_GETEVENTS, NULL, 0);
+
+		if (rc < 0)
+		{
+			if (SYSCALL_INTERRUPTED(errno) || errno == EAGAIN || errno == EBUSY)
+				continue;
+
+			// Forget requests not accepted by kernel, results of them stay zero.
+			// Requests in flight still own their buffers, keep waiting for them.
+
+			const unsigned head = std::atomic_ref<unsigned>(*m_sqHead).load(std::memory_order_acquire);
+			std::atomic_ref<unsigned>(*m_sqTail).store(head, std::memory_order_release);
+
+			expected = submitted;
+			failed = true;
+			continue;
+		}
+
+		submitted += rc;
+
+		unsigned head = *m_cqHead;
+		const unsigned cqTail = std::atomic_ref<unsigned>(*m_cqTail).load(std::memory_order_acquire);
+
+		for (; head != cqTail; head++)
+		{
+			const io_uring_cqe* const cqe = &m_cqes[head & m_cqMask];
+			fb_assert(cqe->user_data < count);
+
+			results[cqe->user_data] = cqe->res;
+			completed++;
+		}
+
+		std::atomic_ref<unsigned>(*m_cqHead).store(head, std::memory_order_release);
+	}
+
+	return !failed;
+}
+
+#endif // HAVE_LINUX_IO_URING_H
+
+
 #if !(defined HAVE_PREAD && defined HAVE_PWRITE)
 
 /* pread() and pwrite() behave like read() and write() except that they
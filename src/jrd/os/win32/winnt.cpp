@@ -572,6 +572,30 @@ bool PIO_read(thread_db* tdbb, jrd_file* file, BufferDesc* bdb, Ods::pag* page,
 }
 
 
+bool PIO_read_pages(thread_db* tdbb, jrd_file* file, BufferDesc* const* bdbs, ULONG count,
+					FbStatusVector* status_vector)
+{
+/**************************************
+ *
+ *	P I O _ r e a d _ p a g e s
+ *
+ **************************************
+ *
+ * Functional description
+ *	Read a batch of data pages into the buffers of given
+ *	buffer descriptors. Pages are read one by one for now.
+ *
+ **************************************/
+	for (ULONG i = 0; i < count; i++)
+	{
+		if (!PIO_read(tdbb, file, bdbs[i], bdbs[i]->bdb_buffer, status_vector))
+			return false;
+	}
+
+	return true;
+}
+
+
 #ifdef SUPERSERVER_V2
 bool PIO_read_ahead(thread_db*	tdbb,
 				   SLONG	start_page,
@@ -808,6 +808,12 @@ void PAG_format_header(thread_db* tdbb)
 	if (dbb->dbb_flags & DBB_force_write)
 		header->hdr_flags |= hdr_force_write;
 
+	if (dbb->dbb_config->getPageCompression())
+	{
+		header->hdr_flags |= hdr_compressed_pages;
+		dbb->dbb_flags |= DBB_compressed_pages;
+	}
+
 	dbb->dbb_ods_version = header->hdr_ods_version & ~ODS_FIREBIRD_FLAG;
 	dbb->dbb_minor_version = header->hdr_ods_minor;
 
@@ -944,6 +950,8 @@ void PAG_header(thread_db* tdbb, bool info, const TriState newForceWrite)
 	pag* page = CCH_FETCH(tdbb, &window, LCK_read, pag_header);
 	header_page* header = (header_page*) page;
 
+	bool markCompressed = false;
+
 	try {
 
 	const TraNumber next_transaction = header->hdr_next_transaction;
@@ -1030,6 +1038,13 @@ void PAG_header(thread_db* tdbb, bool info, const TriState newForceWrite)
 	if (header->hdr_flags & hdr_no_reserve)
 		dbb->dbb_flags |= DBB_no_reserve;
 
+	// Pages are written compressed only after the header says so, thus engines
+	// that cannot read them refuse the database instead of reading garbage
+	if (header->hdr_flags & hdr_compressed_pages)
+		dbb->dbb_flags |= DBB_compressed_pages;
+	else if (!info && !readOnly && dbb->dbb_config->getPageCompression())
+		markCompressed = true;
+
 	const auto shutMode = (shut_mode_t) header->hdr_shutdown_mode;
 	dbb->dbb_shutdown_mode.store(shutMode, std::memory_order_relaxed);
 
@@ -1070,6 +1085,18 @@ void PAG_header(thread_db* tdbb, bool info, const TriState newForceWrite)
 	}
 
 	CCH_RELEASE(tdbb, &window);
+
+	if (markCompressed)
+	{
+		// The flag is never reset, as compressed pages may stay in the database
+		// after PageCompression is turned off
+		window.win_page = HEADER_PAGE_NUMBER;
+		header = (header_page*) CCH_FETCH(tdbb, &window, LCK_write, pag_header);
+		CCH_MARK_MUST_WRITE(tdbb, &window);
+		header->hdr_flags |= hdr_compressed_pages;
+		dbb->dbb_flags |= DBB_compressed_pages;
+		CCH_RELEASE(tdbb, &window);
+	}
 }
 
 
@@ -1148,6 +1175,10 @@ void PAG_header_init(thread_db* tdbb)
 	if (!DbImplementation(header).compatible(DbImplementation::current))
 		ERR_post(Arg::Gds(isc_bad_db_format) << Arg::Str(attachment->att_filename));
 
+	// Flags unknown to this engine may describe a page format it cannot read
+	if (header->hdr_flags & ~hdr_known_flags)
+		ERR_post(Arg::Gds(isc_bad_db_format) << Arg::Str(attachment->att_filename));
+
 	if (header->hdr_page_size < MIN_PAGE_SIZE || header->hdr_page_size > MAX_PAGE_SIZE)
 		ERR_post(Arg::Gds(isc_bad_db_format) << Arg::Str(attachment->att_filename));
 
@@ -66,6 +66,8 @@ inline constexpr USHORT TRANS_PAGE_SPACE	= 255;
 inline constexpr USHORT TEMP_PAGE_SPACE	= 256;
 
 inline constexpr USHORT PAGES_IN_EXTENT	= 8;
+// Max number of consecutive pages allocated at once for a relation or an index
+inline constexpr USHORT MAX_EXTENT_PAGES	= 64;
 
 class jrd_file;
 class Database;
@@ -92,18 +92,6 @@ inline bool QUE_EMPTY(const que& aque)
 #define QUE_LOOPA(que, node) {\
 	for (node = (que)->que_forward; node != que; node = (node)->que_forward)
 
-// CVC: Not sure how to make these two inline since cch.h includes this file but
-// we would need to include here cch.h to get the BufferControl definition.
-
-#define QUE_MOST_RECENTLY_USED(in_use_que) {\
-	QUE_DELETE (in_use_que);\
-	QUE_INSERT (bcb->bcb_in_use, in_use_que);}
-
-#define QUE_LEAST_RECENTLY_USED(in_use_que) {\
-	QUE_DELETE (in_use_que);\
-	QUE_APPEND (bcb->bcb_in_use, in_use_que);}
-
-
 // Self-relative queue BASE should be defined in the source which includes this
 #define SRQ_PTR SLONG
 
@@ -0,0 +1,269 @@
+/*
+ * The contents of this file are subject to the Interbase Public
+ * License Version 1.0 (the "License"); you may not use this file
+ * except in compliance with the License. You may obtain a copy
+ * of the License at http://www.Inprise.com/IPL.html
+ *
+ * Software distributed under the License is distributed on an
+ * "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express
+ * or implied. See the License for the specific language governing
+ * rights and limitations under the License.
+ *
+ * The Original Code was created by Inprise Corporation
+ * and its predecessors. Portions created by Inprise Corporation are
+ * Copyright (C) Inprise Corporation.
+ *
+ * All Rights Reserved.
+ * Contributor(s): ______________________________________.
+ */
+
+#include "firebird.h"
+#include "../jrd/jrd.h"
+#include "../jrd/req.h"
+#include "../jrd/cmp_proto.h"
+#include "../jrd/optimizer/Optimizer.h"
+
+#include "RecordSource.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+// ----------------------------------------------
+// Data access: adaptive (nested loop/hash) join
+// ----------------------------------------------
+
+// The outer stream as seen by the hash join after the switch. It's already open and
+// positioned at the record that has not been joined yet, so the first fetch returns
+// that record and the next ones are passed to the outer stream. Reopening (e.g. when
+// the hash join gets partitioned before returning anything) starts from that record again.
+
+class AdaptiveJoin::OuterStream final : public RecordSource
+{
+public:
+	OuterStream(CompilerScratch* csb, RecordSource* outer)
+		: RecordSource(csb), m_outer(outer)
+	{
+		m_impure = csb->allocImpure<Impure>();
+		m_cardinality = outer->getCardinality();
+	}
+
+	void close(thread_db* tdbb) const override
+	{
+		Request* const request = tdbb->getRequest();
+		Impure* const impure = request->getImpure<Impure>(m_impure);
+
+		impure->irsb_flags &= ~irsb_open;
+	}
+
+	bool refetchRecord(thread_db* tdbb) const override
+	{
+		return m_outer->refetchRecord(tdbb);
+	}
+
+	WriteLockResult lockRecord(thread_db* tdbb) const override
+	{
+		return m_outer->lockRecord(tdbb);
+	}
+
+	void markRecursive() override
+	{
+		m_recursive = true;
+	}
+
+	void invalidateRecords(Request* request) const override
+	{
+		m_outer->invalidateRecords(request);
+	}
+
+	void findUsedStreams(StreamList& streams, bool expandAll) const override
+	{
+		m_outer->findUsedStreams(streams, expandAll);
+	}
+
+	bool isDependent(const StreamList& streams) const override
+	{
+		return m_outer->isDependent(streams);
+	}
+
+	void nullRecords(thread_db* tdbb) const override
+	{
+		m_outer->nullRecords(tdbb);
+	}
+
+	void getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const override
+	{
+		m_outer->getLegacyPlan(tdbb, plan, level);
+	}
+
+protected:
+	void internalGetPlan(thread_db* /*tdbb*/, PlanEntry& planEntry, unsigned /*level*/, bool /*recurse*/) const override
+	{
+		planEntry.className = "AdaptiveJoinOuterStream";
+
+		planEntry.lines.add().text = "Outer Stream (continued)";
+		printOptInfo(planEntry.lines);
+	}
+
+	void internalOpen(thread_db* tdbb) const override
+	{
+		Request* const request = tdbb->getRequest();
+		Impure* const impure = request->getImpure<Impure>(m_impure);
+
+		impure->irsb_flags = irsb_open | irsb_first;
+	}
+
+	bool internalGetRecord(thread_db* tdbb) const override
+	{
+		Request* const request = tdbb->getRequest();
+		Impure* const impure = request->getImpure<Impure>(m_impure);
+
+		if (!(impure->irsb_flags & irsb_open))
+			return false;
+
+		if (impure->irsb_flags & irsb_first)
+		{
+			impure->irsb_flags &= ~irsb_first;
+			return true;
+		}
+
+		return m_outer->getRecord(tdbb);
+	}
+
+private:
+	RecordSource* const m_outer;
+};
+
+
+AdaptiveJoin::AdaptiveJoin(thread_db* tdbb, CompilerScratch* csb,
+						   RecordSource* outer, RecordSource* loopInner, RecordSource* hashInner,
+						   NestValueArray* const* keys, BoolExprNode* hashBoolean,
+						   double selectivity, double threshold)
+	: Join(csb, 3, JoinType::INNER),
+	  m_outer(outer), m_loopInner(loopInner), m_threshold(threshold)
+{
+	fb_assert(outer && loopInner && hashInner);
+
+	m_impure = csb->allocImpure<Impure>();
+
+	m_cardinality = outer->getCardinality() * loopInner->getCardinality();
+
+	RecordSource* const hashArgs[] = {
+		FB_NEW_POOL(csb->csb_pool) OuterStream(csb, outer),
+		hashInner
+	};
+
+	m_hashJoin = FB_NEW_POOL(csb->csb_pool)
+		HashJoin(tdbb, csb, JoinType::INNER, 2, hashArgs, keys, selectivity);
+
+	// Re-check the join conditions that are applied by the nested loop retrieval,
+	// as the hash join compares the key hashes only
+
+	if (hashBoolean)
+	{
+		m_hashJoin = FB_NEW_POOL(csb->csb_pool)
+			FilteredStream(csb, m_hashJoin, hashBoolean, MAXIMUM_SELECTIVITY);
+	}
+
+	m_args.add(m_outer);
+	m_args.add(m_loopInner);
+	m_args.add(m_hashJoin);
+}
+
+void AdaptiveJoin::internalOpen(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	impure->irsb_flags = irsb_open | irsb_mustread;
+	impure->irsb_outer_rows = 0;
+
+	m_outer->open(tdbb);
+}
+
+void AdaptiveJoin::close(thread_db* tdbb) const
+{
+	Request* const request = tdbb->getRequest();
+
+	invalidateRecords(request);
+
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (impure->irsb_flags & irsb_open)
+	{
+		impure->irsb_flags &= ~irsb_open;
+
+		Join::close(tdbb);
+	}
+}
+
+bool AdaptiveJoin::internalGetRecord(thread_db* tdbb) const
+{
+	JRD_reschedule(tdbb);
+
+	Request* const request = tdbb->getRequest();
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open))
+		return false;
+
+	if (impure->irsb_flags & irsb_hashed)
+		return m_hashJoin->getRecord(tdbb);
+
+	while (true)
+	{
+		if (impure->irsb_flags & irsb_mustread)
+		{
+			if (!m_outer->getRecord(tdbb))
+				return false;
+
+			if (++impure->irsb_outer_rows > m_threshold)
+			{
+				// The outer stream is much larger than estimated, so stop looking up
+				// the inner stream per every outer row and hash it instead.
+				// The current outer row is the first one to be hash-joined.
+
+				impure->irsb_flags |= irsb_hashed;
+
+				m_hashJoin->open(tdbb);
+				return m_hashJoin->getRecord(tdbb);
+			}
+
+			impure->irsb_flags &= ~irsb_mustread;
+			m_loopInner->open(tdbb);
+		}
+
+		if (m_loopInner->getRecord(tdbb))
+			return true;
+
+		m_loopInner->close(tdbb);
+		impure->irsb_flags |= irsb_mustread;
+	}
+}
+
+void AdaptiveJoin::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
+{
+	// The plan is reported as it was compiled, i.e. as a nested loop
+
+	level++;
+	plan += "JOIN (";
+	m_outer->getLegacyPlan(tdbb, plan, level);
+	plan += ", ";
+	m_loopInner->getLegacyPlan(tdbb, plan, level);
+	plan += ")";
+}
+
+void AdaptiveJoin::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const
+{
+	planEntry.className = "AdaptiveJoin";
+
+	planEntry.lines.add().text = "Adaptive Join " + printType();
+
+	string extras;
+	extras.printf(" (switch from nested loop to hash join after %" UQUADFORMAT" outer rows)",
+				  (FB_UINT64) m_threshold);
+
+	planEntry.lines.back().text += extras;
+	printOptInfo(planEntry.lines);
+
+	Join::internalGetPlan(tdbb, planEntry, level, recurse);
+}
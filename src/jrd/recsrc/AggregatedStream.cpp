@@ -20,6 +20,7 @@
 #include "firebird.h"
 #include "../jrd/jrd.h"
 #include "../dsql/Nodes.h"
+#include "../dsql/AggNodes.h"
 #include "../dsql/ExprNodes.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/evl_proto.h"
@@ -379,6 +380,25 @@ AggregatedStream::AggregatedStream(thread_db* tdbb, CompilerScratch* csb, Stream
 	: BaseAggWinStream(tdbb, csb, stream, group, map, !group, next)
 {
 	fb_assert(map);
+
+	// A single group containing nothing but COUNT(*) may be evaluated
+	// by the underlying stream without fetching its records
+
+	if (!group)
+	{
+		m_countOnly = true;
+
+		for (const auto source : map->sourceList)
+		{
+			const auto countNode = nodeAs<CountAggNode>(source);
+
+			if (countNode ? (countNode->arg || countNode->distinct) : !nodeIs<LiteralNode>(source))
+			{
+				m_countOnly = false;
+				break;
+			}
+		}
+	}
 }
 
 void AggregatedStream::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
@@ -414,6 +434,20 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 		return false;
 	}
 
+	if (m_countOnly && impure->state == STATE_GROUPING)
+	{
+		SINT64 count;
+
+		if (m_next->countRecords(tdbb, count))
+		{
+			impure->state = STATE_EOF;
+			assignCount(tdbb, request, count);
+
+			rpb->rpb_number.setValid(true);
+			return true;
+		}
+	}
+
 	if (!evaluateGroup(tdbb))
 	{
 		rpb->rpb_number.setValid(false);
@@ -423,3 +457,28 @@ bool AggregatedStream::internalGetRecord(thread_db* tdbb) const
 	rpb->rpb_number.setValid(true);
 	return true;
 }
+
+void AggregatedStream::assignCount(thread_db* tdbb, Request* request, SINT64 count) const
+{
+	aggInit(tdbb, request, m_groupMap);
+
+	dsc desc;
+	desc.makeInt64(0, &count);
+
+	const NestConst<ValueExprNode>* const sourceEnd = m_groupMap->sourceList.end();
+
+	for (const NestConst<ValueExprNode>* source = m_groupMap->sourceList.begin(),
+			*target = m_groupMap->targetList.begin();
+		 source != sourceEnd;
+		 ++source, ++target)
+	{
+		if (nodeIs<CountAggNode>(*source))
+		{
+			const FieldNode* field = nodeAs<FieldNode>(*target);
+			Record* record = request->req_rpb[field->fieldStream].rpb_record;
+
+			MOV_move(tdbb, &desc, EVL_assign_to(tdbb, *target));
+			record->clearNull(field->fieldId);
+		}
+	}
+}
@@ -24,14 +24,354 @@
 #include "../jrd/dpm_proto.h"
 #include "../jrd/evl_proto.h"
 #include "../jrd/vio_proto.h"
+#include "../jrd/met_proto.h"
 #include "../jrd/rlck_proto.h"
+#include "../jrd/tra_proto.h"
 #include "../jrd/Attachment.h"
+#include "../jrd/WorkerAttachment.h"
+#include "../common/Task.h"
 
 #include "RecordSource.h"
 
 using namespace Firebird;
 using namespace Jrd;
 
+namespace
+{
+	// Counts the records of data pages with sequences [first, last). Records of the pages
+	// marked all visible by sweep are counted without fetching their versions.
+
+	SINT64 countPages(thread_db* tdbb, record_param* rpb, jrd_tra* transaction,
+					  ULONG first, ULONG last, const volatile bool* stop = nullptr)
+	{
+		Database* const dbb = tdbb->getDatabase();
+		SINT64 count = 0;
+
+		for (ULONG sequence = first; sequence < last && !(stop && *stop); sequence++)
+		{
+			ULONG visible;
+
+			if (DPM_count_visible(tdbb, rpb, sequence, visible))
+			{
+				tdbb->bumpStats(RecordStatType::SEQ_READS, rpb->rpb_relation->rel_id, visible);
+				count += visible;
+
+				JRD_reschedule(tdbb);
+				continue;
+			}
+
+			rpb->rpb_number.setValue((SINT64) sequence * dbb->dbb_max_records - 1);
+
+			while (VIO_next_record(tdbb, rpb, transaction, tdbb->getDefaultPool(), DPM_next_data_page))
+			{
+				count++;
+
+				JRD_reschedule(tdbb);
+			}
+		}
+
+		return count;
+	}
+
+	// Counts the records of a relation visible to the given snapshot.
+	// Every work item handles one pointer page at a time, using its own
+	// worker attachment and read-only transaction started at the snapshot.
+
+	class CountTask : public Task
+	{
+	public:
+		CountTask(thread_db* tdbb, MemoryPool* pool, const jrd_rel* relation,
+				  CommitNumber snapshot, ULONG countPP, bool largeScan)
+			: Task(),
+			  m_pool(pool),
+			  m_dbb(tdbb->getDatabase()),
+			  m_relId(relation->rel_id),
+			  m_relName(*pool, relation->rel_name.toQuotedString()),
+			  m_largeScan(largeScan),
+			  m_items(*m_pool),
+			  m_stop(false),
+			  m_countPP(countPP),
+			  m_nextPP(0)
+		{
+			Attachment* const att = tdbb->getAttachment();
+
+			UCHAR* p = m_tpb;
+			*p++ = isc_tpb_version1;
+			*p++ = isc_tpb_read;
+			*p++ = isc_tpb_concurrency;
+			*p++ = isc_tpb_at_snapshot_number;
+			*p++ = sizeof(CommitNumber);
+
+			for (unsigned i = 0; i < sizeof(CommitNumber); i++)
+				*p++ = (UCHAR) (snapshot >> (i * 8));
+
+			fb_assert(p - m_tpb == sizeof(m_tpb));
+
+			for (int i = 0; i < att->att_parallel_workers; i++)
+				m_items.add(FB_NEW_POOL(*m_pool) Item(this));
+
+			m_items[0]->m_ownAttach = false;
+			m_items[0]->m_attStable = att->getStable();
+		}
+
+		virtual ~CountTask()
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				delete *p;
+		}
+
+		class Item : public Task::WorkItem
+		{
+		public:
+			Item(CountTask* task) : Task::WorkItem(task),
+				m_inuse(false),
+				m_ownAttach(true),
+				m_tra(NULL),
+				m_ppSequence(0),
+				m_count(0)
+			{}
+
+			virtual ~Item()
+			{
+				if (!m_attStable)
+					return;
+
+				Attachment* att = NULL;
+				{
+					AttSyncLockGuard guard(*m_attStable->getSync(), FB_FUNCTION);
+					att = m_attStable->getHandle();
+					if (!att)
+						return;
+					fb_assert(att->att_use_count > 0 || !m_ownAttach);
+				}
+
+				// The transaction is started by the item even in the main attachment
+
+				FbLocalStatus status;
+				if (m_tra)
+				{
+					BackgroundContextHolder tdbb(att->att_database, att, &status, FB_FUNCTION);
+					TRA_commit(tdbb, m_tra, false);
+				}
+
+				if (m_ownAttach)
+					WorkerAttachment::releaseAttachment(&status, m_attStable);
+			}
+
+			CountTask* getTask() const
+			{
+				return reinterpret_cast<CountTask*> (m_task);
+			}
+
+			bool init(thread_db* tdbb)
+			{
+				FbStatusVector* status = tdbb->tdbb_status_vector;
+				Attachment* att = NULL;
+
+				if (m_ownAttach && !m_attStable.hasData())
+					m_attStable = WorkerAttachment::getAttachment(status, getTask()->m_dbb);
+
+				if (m_attStable)
+					att = m_attStable->getHandle();
+
+				if (!att)
+				{
+					if (!status->hasData())
+						Arg::Gds(isc_bad_db_handle).copyTo(status);
+
+					return false;
+				}
+
+				tdbb->setDatabase(att->att_database);
+				tdbb->setAttachment(att);
+
+				if (!m_tra)
+				{
+					try
+					{
+						WorkerContextHolder holder(tdbb, FB_FUNCTION);
+						m_tra = TRA_start(tdbb, sizeof(getTask()->m_tpb), getTask()->m_tpb);
+					}
+					catch (const Exception& ex)
+					{
+						ex.stuffException(tdbb->tdbb_status_vector);
+						return false;
+					}
+				}
+
+				tdbb->setTransaction(m_tra);
+
+				return true;
+			}
+
+			bool m_inuse;
+			bool m_ownAttach;
+			RefPtr<StableAttachmentPart> m_attStable;
+			jrd_tra* m_tra;
+			ULONG m_ppSequence;
+			SINT64 m_count;
+		};
+
+		bool handler(WorkItem& _item) override;
+		bool getWorkItem(WorkItem** pItem) override;
+
+		bool getResult(IStatus* status) override
+		{
+			if (status)
+			{
+				status->init();
+				status->setErrors(m_status.getErrors());
+			}
+
+			return m_status.isSuccess();
+		}
+
+		int getMaxWorkers() override
+		{
+			return MIN(m_items.getCount(), m_countPP);
+		}
+
+		SINT64 getCount() const
+		{
+			SINT64 count = 0;
+
+			for (const auto item : m_items)
+				count += item->m_count;
+
+			return count;
+		}
+
+	private:
+		void setError(IStatus* status, bool stopTask)
+		{
+			const bool copyStatus = (m_status.isSuccess() && status && status->getState() == IStatus::STATE_ERRORS);
+			if (!copyStatus && (!stopTask || m_stop))
+				return;
+
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+			if (m_status.isSuccess() && copyStatus)
+				m_status.save(status);
+			if (stopTask)
+				m_stop = true;
+		}
+
+		MemoryPool* m_pool;
+		Database* m_dbb;
+		const USHORT m_relId;
+		const string m_relName;
+		const bool m_largeScan;
+		UCHAR m_tpb[5 + sizeof(CommitNumber)];
+
+		Mutex m_mutex;
+		HalfStaticArray<Item*, 8> m_items;
+		StatusHolder m_status;
+
+		volatile bool m_stop;
+		const ULONG m_countPP;
+		ULONG m_nextPP;
+	};
+
+	bool CountTask::handler(WorkItem& _item)
+	{
+		Item* item = reinterpret_cast<Item*>(&_item);
+
+		ThreadContextHolder tdbb(NULL);
+
+		if (!item->init(tdbb))
+		{
+			setError(tdbb->tdbb_status_vector, true);
+			return false;
+		}
+
+		WorkerContextHolder holder(tdbb, FB_FUNCTION);
+
+		record_param rpb;
+		jrd_rel* relation = NULL;
+
+		try
+		{
+			Database* const dbb = tdbb->getDatabase();
+
+			relation = MET_lookup_relation_id(tdbb, m_relId, false);
+
+			if (!relation)
+				(Arg::Gds(isc_relnotdef) << m_relName).raise();
+
+			if (!relation->getPages(tdbb)->rel_pages)
+			{
+				relation = NULL;
+				return true;
+			}
+
+			rpb.rpb_relation = relation;
+			rpb.rpb_record = NULL;
+			rpb.rpb_stream_flags = RPB_s_no_data;
+			rpb.rpb_ra_window = RPB_read_ahead_window;
+
+			if (m_largeScan)
+			{
+				rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+				rpb.rpb_org_scans = relation->rel_scan_count++;
+			}
+
+			const ULONG first = item->m_ppSequence * dbb->dbb_dp_per_pp;
+
+			item->m_count += countPages(tdbb, &rpb, item->m_tra,
+				first, first + dbb->dbb_dp_per_pp, &m_stop);
+
+			delete rpb.rpb_record;
+
+			if (m_largeScan && relation->rel_scan_count)
+				--relation->rel_scan_count;
+
+			return !m_stop;
+		}
+		catch (const Exception& ex)
+		{
+			ex.stuffException(tdbb->tdbb_status_vector);
+
+			delete rpb.rpb_record;
+
+			if (relation && m_largeScan && relation->rel_scan_count)
+				--relation->rel_scan_count;
+		}
+
+		setError(tdbb->tdbb_status_vector, true);
+		return false;
+	}
+
+	bool CountTask::getWorkItem(WorkItem** pItem)
+	{
+		Item* item = reinterpret_cast<Item*> (*pItem);
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (m_stop)
+			return false;
+
+		if (item == NULL)
+		{
+			for (Item** p = m_items.begin(); p < m_items.end(); p++)
+				if (!(*p)->m_inuse)
+				{
+					(*p)->m_inuse = true;
+					*pItem = item = *p;
+					break;
+				}
+		}
+
+		if (!item)
+			return false;
+
+		item->m_inuse = (m_nextPP < m_countPP);
+
+		if (item->m_inuse)
+			item->m_ppSequence = m_nextPP++;
+
+		return item->m_inuse;
+	}
+}
+
 // -------------------------------------------
 // Data access: sequential complete table scan
 // -------------------------------------------
@@ -61,6 +401,8 @@ void FullTableScan::internalOpen(thread_db* tdbb) const
 
 	record_param* const rpb = &request->req_rpb[m_stream];
 	rpb->getWindow(tdbb).win_flags = 0;
+	rpb->rpb_ra_sequence = 0;
+	rpb->rpb_ra_window = RPB_read_ahead_window;
 
 	// Unless this is the only attachment, limit the cache flushing
 	// effect of large sequential scans on the page working sets of
@@ -158,6 +500,111 @@ bool FullTableScan::internalGetRecord(thread_db* tdbb) const
 	return false;
 }
 
+bool FullTableScan::countRecords(thread_db* tdbb, SINT64& count) const
+{
+	Database* const dbb = tdbb->getDatabase();
+	Attachment* const attachment = tdbb->getAttachment();
+	Request* const request = tdbb->getRequest();
+	jrd_tra* const transaction = request->req_transaction;
+	Impure* const impure = request->getImpure<Impure>(m_impure);
+
+	if (!(impure->irsb_flags & irsb_open) || m_dbkeyRanges.hasData())
+		return false;
+
+	const ULONG countPP = DPM_pointer_pages(tdbb, m_relation);
+	const bool largeScan = (request->req_rpb[m_stream].getWindow(tdbb).win_flags & WIN_large_scan);
+
+	if (attachment->att_parallel_workers <= 1 || m_relation->isTemporary() || countPP < 2)
+		return countSerial(tdbb, countPP, largeScan, count);
+
+	// Classic in single-user shutdown mode can't create additional worker attachments
+	if (dbb->isShutdown(shut_mode_single) && !(dbb->dbb_flags & DBB_shared))
+		return countSerial(tdbb, countPP, largeScan, count);
+
+	// Workers can see neither own changes of the transaction nor its undo log,
+	// so it should not have written anything yet
+
+	if (transaction->tra_flags & (TRA_system | TRA_write) || transaction->tra_commit_sub_trans)
+		return countSerial(tdbb, countPP, largeScan, count);
+
+	// Workers read at the snapshot the records would be fetched with
+
+	CommitNumber snapshot = 0;
+
+	if (!(transaction->tra_flags & TRA_read_committed))
+		snapshot = transaction->tra_snapshot_number;
+	else if (transaction->tra_flags & TRA_read_consistency)
+	{
+		const Request* const snapshotRequest = request->req_snapshot.m_owner;
+
+		if (snapshotRequest && !(snapshotRequest->req_flags & req_update_conflict))
+			snapshot = snapshotRequest->req_snapshot.m_number;
+	}
+
+	if (!snapshot)
+		return countSerial(tdbb, countPP, largeScan, count);
+
+	{
+		EngineCheckout cout(tdbb, FB_FUNCTION);
+
+		Coordinator coord(dbb->dbb_permanent);
+		CountTask task(tdbb, dbb->dbb_permanent, m_relation, snapshot, countPP, largeScan);
+
+		FbLocalStatus localStatus;
+		localStatus->init();
+
+		coord.runSync(&task);
+
+		if (!task.getResult(&localStatus))
+			localStatus.raise();
+
+		count = task.getCount();
+	}
+
+	return true;
+}
+
+bool FullTableScan::countSerial(thread_db* tdbb, ULONG countPP, bool largeScan, SINT64& count) const
+{
+	Database* const dbb = tdbb->getDatabase();
+	Request* const request = tdbb->getRequest();
+
+	// The stream's own record is not touched, it's left positioned at BOF
+
+	record_param rpb;
+	rpb.rpb_relation = m_relation;
+	rpb.rpb_record = NULL;
+	rpb.rpb_stream_flags = RPB_s_no_data;
+	rpb.rpb_ra_window = RPB_read_ahead_window;
+
+	if (largeScan)
+	{
+		rpb.getWindow(tdbb).win_flags = WIN_large_scan;
+		rpb.rpb_org_scans = m_relation->rel_scan_count++;
+	}
+
+	try
+	{
+		count = countPages(tdbb, &rpb, request->req_transaction, 0, countPP * dbb->dbb_dp_per_pp);
+	}
+	catch (const Exception&)
+	{
+		delete rpb.rpb_record;
+
+		if (largeScan && m_relation->rel_scan_count)
+			--m_relation->rel_scan_count;
+
+		throw;
+	}
+
+	delete rpb.rpb_record;
+
+	if (largeScan && m_relation->rel_scan_count)
+		--m_relation->rel_scan_count;
+
+	return true;
+}
+
 void FullTableScan::getLegacyPlan(thread_db* tdbb, string& plan, unsigned level) const
 {
 	if (!level)
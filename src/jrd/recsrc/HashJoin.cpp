@@ -23,8 +23,10 @@
 #include "firebird.h"
 #include "../common/classes/Aligner.h"
 #include "../common/classes/Hash.h"
+#include "../common/Task.h"
 #include "../jrd/jrd.h"
 #include "../jrd/req.h"
+#include "../jrd/HashSpillFile.h"
 #include "../jrd/intl.h"
 #include "../jrd/cmp_proto.h"
 #include "../jrd/evl_proto.h"
@@ -46,6 +48,24 @@ using namespace Jrd;
 // NS: FIXME - Why use static hash table here??? Hash table shall support dynamic resizing
 static constexpr ULONG HASH_SIZE = 1009;
 static constexpr ULONG BUCKET_PREALLOCATE_SIZE = 32;	// 256 bytes per bucket
+static constexpr ULONG HASH_ENTRY_SIZE = sizeof(ULONG) * 2;	// hash + position
+static constexpr ULONG PARALLEL_SORT_ENTRIES = 50000;	// minimum entries per sorting thread
+
+namespace
+{
+	// Estimate the number of partitions required to keep every partition
+	// within the given memory limit, rounded up to the power of two
+
+	ULONG estimatePartitions(double size, FB_UINT64 limit)
+	{
+		ULONG count = 2;
+
+		while (count < HashSpillFile::MAX_PARTITIONS && size > (double) count * limit)
+			count *= 2;
+
+		return count;
+	}
+}
 
 unsigned HashJoin::maxCapacity() noexcept
 {
@@ -104,6 +124,12 @@ class HashJoin::HashTable final : public PermanentStorage
 			m_collisions.add(Entry(hash, position));
 		}
 
+		void spill(HashSpillFile* file, ULONG stream) const
+		{
+			for (const auto& collision : m_collisions)
+				file->put(stream, collision.hash, collision.position);
+		}
+
 		bool locate(ULONG hash)
 		{
 			if (m_collisions.find(hash, m_iterator))
@@ -135,10 +161,108 @@ class HashJoin::HashTable final : public PermanentStorage
 		FB_SIZE_T m_iterator;
 	};
 
+	// Sorts the collision lists using parallel workers. Every work item
+	// handles a contiguous range of the hash table slots.
+
+	class SortTask final : public Task
+	{
+		static constexpr ULONG SLOTS_PER_ITEM = 64;
+
+	public:
+		SortTask(MemoryPool& pool, HashTable* table, int workers)
+			: m_table(table), m_items(pool), m_nextSlot(0)
+		{
+			for (int i = 0; i < workers; i++)
+				m_items.add(FB_NEW_POOL(pool) Item(this));
+		}
+
+		~SortTask()
+		{
+			for (auto item : m_items)
+				delete item;
+		}
+
+		bool handler(WorkItem& workItem) override
+		{
+			const auto item = reinterpret_cast<Item*>(&workItem);
+
+			for (ULONG i = item->m_firstSlot; i < item->m_lastSlot; i++)
+			{
+				if (const auto collisions = m_table->m_collisions[i])
+					collisions->sort();
+			}
+
+			return true;
+		}
+
+		bool getWorkItem(WorkItem** pItem) override
+		{
+			auto item = reinterpret_cast<Item*>(*pItem);
+
+			MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+			if (!item)
+			{
+				for (auto freeItem : m_items)
+				{
+					if (!freeItem->m_inuse)
+					{
+						freeItem->m_inuse = true;
+						*pItem = item = freeItem;
+						break;
+					}
+				}
+			}
+
+			if (!item)
+				return false;
+
+			const ULONG slotCount = m_table->m_streamCount * m_table->m_tableSize;
+
+			item->m_inuse = (m_nextSlot < slotCount);
+
+			if (item->m_inuse)
+			{
+				item->m_firstSlot = m_nextSlot;
+				item->m_lastSlot = m_nextSlot = MIN(m_nextSlot + SLOTS_PER_ITEM, slotCount);
+			}
+
+			return item->m_inuse;
+		}
+
+		bool getResult(IStatus* /*status*/) override
+		{
+			return true;
+		}
+
+		int getMaxWorkers() override
+		{
+			return (int) m_items.getCount();
+		}
+
+	private:
+		class Item : public Task::WorkItem
+		{
+		public:
+			explicit Item(SortTask* task)
+				: Task::WorkItem(task)
+			{}
+
+			bool m_inuse = false;
+			ULONG m_firstSlot = 0;
+			ULONG m_lastSlot = 0;
+		};
+
+		HashTable* const m_table;
+		HalfStaticArray<Item*, 8> m_items;
+		Mutex m_mutex;
+		ULONG m_nextSlot;
+	};
+
 public:
 	HashTable(MemoryPool& pool, ULONG streamCount, ULONG tableSize = HASH_SIZE)
 		: PermanentStorage(pool), m_streamCount(streamCount),
-		  m_tableSize(tableSize), m_slot(0)
+		  m_tableSize(tableSize), m_slot(0), m_count(0)
 	{
 		m_collisions = FB_NEW_POOL(pool) CollisionList*[streamCount * tableSize];
 		memset(m_collisions, 0, streamCount * tableSize * sizeof(CollisionList*));
@@ -168,6 +292,7 @@ public:
 		}
 
 		collisions->add(hash, position);
+		m_count++;
 	}
 
 	bool setup(ULONG hash)
@@ -205,12 +330,45 @@ public:
 		return collisions->iterate(hash, position);
 	}
 
-	void sort()
+	void spill(HashSpillFile* file) const
 	{
-		for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+		for (ULONG i = 0; i < m_streamCount; i++)
+		{
+			for (ULONG j = 0; j < m_tableSize; j++)
+			{
+				if (const auto collisions = m_collisions[i * m_tableSize + j])
+					collisions->spill(file, i);
+			}
+		}
+	}
+
+	void sort(thread_db* tdbb)
+	{
+		// Smaller tables are sorted faster than the threads are woken up,
+		// so every thread should get enough entries
+
+		const auto attachment = tdbb->getAttachment();
+		const int workers = (int) MIN((FB_UINT64) attachment->att_parallel_workers,
+			m_count / PARALLEL_SORT_ENTRIES);
+
+		bool sorted = false;
+
+		if (workers > 1)
+		{
+			// Sorting does not access the engine, so the workers
+			// do not need their own attachments, only threads
+
+			SortTask task(*tdbb->getDefaultPool(), this, workers);
+			sorted = attachment->runSortTask(&task);
+		}
+
+		if (!sorted)
 		{
-			if (const auto collisions = m_collisions[i])
-				collisions->sort();
+			for (ULONG i = 0; i < m_streamCount * m_tableSize; i++)
+			{
+				if (const auto collisions = m_collisions[i])
+					collisions->sort();
+			}
 		}
 
 #ifdef PRINT_HASH_TABLE
@@ -246,6 +404,7 @@ private:
 	const ULONG m_tableSize;
 	CollisionList** m_collisions;
 	ULONG m_slot;
+	FB_UINT64 m_count;
 };
 
 
@@ -276,7 +435,14 @@ void HashJoin::init(thread_db* tdbb, CompilerScratch* csb, FB_SIZE_T count,
 {
 	m_impure = csb->allocImpure<Impure>();
 
+	// Inner rows and their hash table entries beyond the memory limit
+	// cause the join to be partitioned
+
+	m_memoryLimit = tdbb->getDatabase()->dbb_config->getHashJoinMemoryLimit();
+
 	m_leader.source = args[0];
+	m_leaderBuffer = m_memoryLimit ?
+		FB_NEW_POOL(csb->csb_pool) BufferedStream(csb, m_leader.source) : nullptr;
 	m_leader.keys = keys[0];
 	const FB_SIZE_T leaderKeyCount = m_leader.keys->getCount();
 	m_leader.keyLengths = FB_NEW_POOL(csb->csb_pool) ULONG[leaderKeyCount];
@@ -371,6 +537,14 @@ void HashJoin::internalOpen(thread_db* tdbb) const
 	delete impure->irsb_hash_table;
 	impure->irsb_hash_table = nullptr;
 
+	if (impure->irsb_spill_file)
+	{
+		m_leaderBuffer->close(tdbb);
+
+		delete impure->irsb_spill_file;
+		impure->irsb_spill_file = nullptr;
+	}
+
 	delete[] impure->irsb_leader_buffer;
 	impure->irsb_leader_buffer = nullptr;
 
@@ -388,11 +562,17 @@ void HashJoin::close(thread_db* tdbb) const
 	{
 		impure->irsb_flags &= ~irsb_open;
 
+		if (m_leaderBuffer)
+			m_leaderBuffer->close(tdbb);
+
 		Join::close(tdbb);
 
 		delete impure->irsb_hash_table;
 		impure->irsb_hash_table = nullptr;
 
+		delete impure->irsb_spill_file;
+		impure->irsb_spill_file = nullptr;
+
 		delete[] impure->irsb_leader_buffer;
 		impure->irsb_leader_buffer = nullptr;
 	}
@@ -416,7 +596,7 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 		{
 			// Fetch the record from the leading stream
 
-			if (!m_leader.source->getRecord(tdbb))
+			if (!fetchLeader(tdbb, request, impure))
 				return false;
 
 			if (m_boolean && m_boolean->execute(tdbb, request) != TriState(true))
@@ -427,43 +607,15 @@ bool HashJoin::internalGetRecord(thread_db* tdbb) const
 				return true;
 			}
 
-			// We have something to join with, so ensure the hash table is initialized
+			// Compute and hash the comparison keys, unless they were already hashed
+			// while partitioning the leading stream
 
-			if (!impure->irsb_hash_table && !impure->irsb_leader_buffer)
+			if (!impure->irsb_spill_file)
 			{
-				auto& pool = *tdbb->getDefaultPool();
-				const auto argCount = m_subs.getCount();
-
-				impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
-				impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
-
-				UCharBuffer buffer(pool);
-
-				for (FB_SIZE_T i = 0; i < argCount; i++)
-				{
-					// Read and cache the inner streams. While doing that,
-					// hash the join condition values and populate hash tables.
-
-					m_subs[i].buffer->open(tdbb);
-
-					ULONG counter = 0;
-					const auto keyBuffer = buffer.getBuffer(m_subs[i].totalKeyLength, false);
-
-					while (m_subs[i].buffer->getRecord(tdbb))
-					{
-						const auto hash = computeHash(tdbb, request, m_subs[i], keyBuffer);
-						impure->irsb_hash_table->put(i, hash, counter++);
-					}
-				}
-
-				impure->irsb_hash_table->sort();
+				impure->irsb_leader_hash =
+					computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
 			}
 
-			// Compute and hash the comparison keys
-
-			impure->irsb_leader_hash =
-				computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
-
 			// Ensure the every inner stream having matches for this hash slot.
 			// Setup the hash table for the iteration through collisions.
 
@@ -553,6 +705,16 @@ void HashJoin::internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned l
 
 	planEntry.lines.back().text += extras;
 
+	const auto hashedSize = getHashedSize();
+
+	if (m_memoryLimit && hashedSize > m_memoryLimit)
+	{
+		extras.printf(" (partitioned: %" ULONGFORMAT" partitions estimated)",
+					  estimatePartitions(hashedSize, m_memoryLimit));
+
+		planEntry.lines.back().text += extras;
+	}
+
 	printOptInfo(planEntry.lines);
 
 	Join::internalGetPlan(tdbb, planEntry, level, recurse);
@@ -637,6 +799,178 @@ ULONG HashJoin::computeHash(thread_db* tdbb,
 	return InternalHash::hash(sub.totalKeyLength, keyBuffer);
 }
 
+bool HashJoin::fetchLeader(thread_db* tdbb, Request* request, Impure* impure) const
+{
+	if (!impure->irsb_spill_file)
+	{
+		if (!m_leader.source->getRecord(tdbb))
+			return false;
+
+		// We have something to join with, so ensure the hash table is initialized
+
+		if (impure->irsb_hash_table)
+			return true;
+
+		buildHashTable(tdbb, request, impure);
+
+		if (!impure->irsb_spill_file)
+			return true;
+	}
+
+	// The join is partitioned, so return the leading records of the current partition
+	// from the buffer. Switch to the next partition when the current one is exhausted.
+
+	HashSpillFile* const spill = impure->irsb_spill_file;
+	ULONG position;
+
+	while (!spill->next(impure->irsb_leader_hash, position))
+	{
+		if (++impure->irsb_partition >= spill->getPartitionCount())
+			return false;
+
+		loadPartition(tdbb, impure);
+	}
+
+	m_leaderBuffer->locate(tdbb, position);
+	return m_leaderBuffer->getRecord(tdbb);
+}
+
+void HashJoin::buildHashTable(thread_db* tdbb, Request* request, Impure* impure) const
+{
+	auto& pool = *tdbb->getDefaultPool();
+	const auto argCount = m_subs.getCount();
+
+	impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
+	impure->irsb_leader_buffer = FB_NEW_POOL(pool) UCHAR[m_leader.totalKeyLength];
+
+	UCharBuffer buffer(pool);
+	FB_UINT64 memoryUsed = 0, innerBytes = 0;
+
+	for (FB_SIZE_T i = 0; i < argCount; i++)
+	{
+		// Read and cache the inner streams. While doing that,
+		// hash the join condition values and populate hash tables.
+
+		m_subs[i].buffer->open(tdbb);
+
+		ULONG counter = 0;
+		const auto keyBuffer = buffer.getBuffer(m_subs[i].totalKeyLength, false);
+		const ULONG recordLength = m_subs[i].buffer->getRecordLength();
+
+		while (m_subs[i].buffer->getRecord(tdbb))
+		{
+			const auto hash = computeHash(tdbb, request, m_subs[i], keyBuffer);
+
+			if (impure->irsb_spill_file)
+			{
+				impure->irsb_spill_file->put(i, hash, counter++);
+				continue;
+			}
+
+			impure->irsb_hash_table->put(i, hash, counter++);
+
+			memoryUsed += HASH_ENTRY_SIZE + recordLength;
+
+			if (m_memoryLimit && memoryUsed > m_memoryLimit)
+			{
+				// The buffered rows and their hash table do not fit the memory limit.
+				// Move the already collected entries into the partitioned temporary
+				// storage and continue there.
+
+				const auto size = MAX(getHashedSize(), 2.0 * memoryUsed);
+				const auto partitionCount = estimatePartitions(size, m_memoryLimit);
+
+				impure->irsb_spill_file =
+					FB_NEW_POOL(pool) HashSpillFile(pool, argCount + 1, partitionCount);
+
+				impure->irsb_hash_table->spill(impure->irsb_spill_file);
+
+				delete impure->irsb_hash_table;
+				impure->irsb_hash_table = nullptr;
+
+				tdbb->bumpStats(TempStatType::HASH_SPILLS);
+				tdbb->bumpStats(TempStatType::HASH_PARTITIONS, partitionCount);
+			}
+		}
+
+		innerBytes += (FB_UINT64) counter * recordLength;
+	}
+
+	if (HashSpillFile* const spill = impure->irsb_spill_file)
+	{
+		// All the inner and leading rows are read back from their buffers partition by partition
+
+		const auto leaderBytes = partitionLeader(tdbb, request, impure);
+
+		tdbb->bumpStats(TempStatType::HASH_SPILL_BYTES, spill->getSize() + innerBytes + leaderBytes);
+
+		impure->irsb_partition = 0;
+		loadPartition(tdbb, impure);
+	}
+	else
+		impure->irsb_hash_table->sort(tdbb);
+}
+
+FB_UINT64 HashJoin::partitionLeader(thread_db* tdbb, Request* request, Impure* impure) const
+{
+	HashSpillFile* const spill = impure->irsb_spill_file;
+	const auto leaderStream = m_subs.getCount();
+
+	// The leading stream has been already started, but nothing was returned to the caller yet.
+	// Restart it through the buffer, so that its records could be read back partition by partition.
+
+	m_leader.source->close(tdbb);
+	m_leaderBuffer->open(tdbb);
+
+	ULONG counter = 0;
+
+	while (m_leaderBuffer->getRecord(tdbb))
+	{
+		const auto hash = computeHash(tdbb, request, m_leader, impure->irsb_leader_buffer);
+		spill->put(leaderStream, hash, counter++);
+	}
+
+	return (FB_UINT64) counter * m_leaderBuffer->getRecordLength();
+}
+
+void HashJoin::loadPartition(thread_db* tdbb, Impure* impure) const
+{
+	auto& pool = *tdbb->getDefaultPool();
+	const auto argCount = m_subs.getCount();
+
+	HashSpillFile* const spill = impure->irsb_spill_file;
+	const auto partition = impure->irsb_partition;
+
+	delete impure->irsb_hash_table;
+	impure->irsb_hash_table = nullptr;
+
+	impure->irsb_hash_table = FB_NEW_POOL(pool) HashTable(pool, argCount);
+
+	for (FB_SIZE_T i = 0; i < argCount; i++)
+	{
+		spill->open(i, partition);
+
+		ULONG hash, position;
+		while (spill->next(hash, position))
+			impure->irsb_hash_table->put(i, hash, position);
+	}
+
+	impure->irsb_hash_table->sort(tdbb);
+
+	// Position to the leading records of this partition
+	spill->open(argCount, partition);
+}
+
+double HashJoin::getHashedSize() const
+{
+	double size = 0;
+
+	for (const auto& sub : m_subs)
+		size += sub.buffer->getCardinality() * (HASH_ENTRY_SIZE + sub.buffer->getRecordLength());
+
+	return size;
+}
+
 bool HashJoin::fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const
 {
 	HashTable* const hashTable = impure->irsb_hash_table;
@@ -45,6 +45,7 @@ namespace Jrd
 	class Sort;
 	class CompilerScratch;
 	class BtrPageGCLock;
+	class HashSpillFile;
 	struct index_desc;
 	struct record_param;
 	struct temporary_key;
@@ -154,6 +155,12 @@ namespace Jrd
 			fb_assert(false);
 		}
 
+		// Count the records of the open stream without fetching them, if supported
+		virtual bool countRecords(thread_db* /*tdbb*/, SINT64& /*count*/) const
+		{
+			return false;
+		}
+
 		static bool rejectDuplicate(const UCHAR* /*data1*/, const UCHAR* /*data2*/, void* /*userArg*/)
 		{
 			return true;
@@ -244,6 +251,8 @@ namespace Jrd
 
 		void close(thread_db* tdbb) const override;
 
+		bool countRecords(thread_db* tdbb, SINT64& count) const override;
+
 		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
 
 	protected:
@@ -252,6 +261,8 @@ namespace Jrd
 		bool internalGetRecord(thread_db* tdbb) const override;
 
 	private:
+		bool countSerial(thread_db* tdbb, ULONG countPP, bool largeScan, SINT64& count) const;
+
 		const Firebird::string m_alias;
 		jrd_rel* const m_relation;
 		Firebird::Array<DbKeyRangeNode*> m_dbkeyRanges;
@@ -947,6 +958,11 @@ namespace Jrd
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		void assignCount(thread_db* tdbb, Request* request, SINT64 count) const;
+
+		bool m_countOnly = false;
 	};
 
 	class WindowedStream : public RecordSource
@@ -1140,6 +1156,11 @@ namespace Jrd
 			return impure->irsb_position;
 		}
 
+		ULONG getRecordLength() const
+		{
+			return m_format->fmt_length;
+		}
+
 	protected:
 		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
 		void internalOpen(thread_db* tdbb) const override;
@@ -1328,8 +1349,10 @@ namespace Jrd
 		struct Impure : public RecordSource::Impure
 		{
 			HashTable* irsb_hash_table;
+			HashSpillFile* irsb_spill_file;
 			UCHAR* irsb_leader_buffer;
 			ULONG irsb_leader_hash;
+			ULONG irsb_partition;
 		};
 
 	public:
@@ -1357,10 +1380,53 @@ namespace Jrd
 				  double selectivity);
 		ULONG computeHash(thread_db* tdbb, Request* request,
 						  const SubStream& sub, UCHAR* buffer) const;
+		bool fetchLeader(thread_db* tdbb, Request* request, Impure* impure) const;
 		bool fetchRecord(thread_db* tdbb, Impure* impure, FB_SIZE_T stream) const;
+		void buildHashTable(thread_db* tdbb, Request* request, Impure* impure) const;
+		FB_UINT64 partitionLeader(thread_db* tdbb, Request* request, Impure* impure) const;
+		void loadPartition(thread_db* tdbb, Impure* impure) const;
+		double getHashedSize() const;
 
 		SubStream m_leader;
 		Firebird::Array<SubStream> m_subs;
+		BufferedStream* m_leaderBuffer;
+		FB_UINT64 m_memoryLimit;
+	};
+
+	// Inner join of two streams that starts as a nested loop and switches to a hash join
+	// if the outer stream returns more rows than the given threshold. The switch happens
+	// between outer rows, the hash join then continues starting with the current outer row.
+
+	class AdaptiveJoin final : public Join<RecordSource>
+	{
+		class OuterStream;
+
+		struct Impure : public RecordSource::Impure
+		{
+			FB_UINT64 irsb_outer_rows;
+		};
+
+		static const ULONG irsb_hashed = 32;
+
+	public:
+		AdaptiveJoin(thread_db* tdbb, CompilerScratch* csb,
+					 RecordSource* outer, RecordSource* loopInner, RecordSource* hashInner,
+					 NestValueArray* const* keys, BoolExprNode* hashBoolean,
+					 double selectivity, double threshold);
+
+		void close(thread_db* tdbb) const override;
+		void getLegacyPlan(thread_db* tdbb, Firebird::string& plan, unsigned level) const override;
+
+	protected:
+		void internalGetPlan(thread_db* tdbb, PlanEntry& planEntry, unsigned level, bool recurse) const override;
+		void internalOpen(thread_db* tdbb) const override;
+		bool internalGetRecord(thread_db* tdbb) const override;
+
+	private:
+		RecordSource* const m_outer;
+		RecordSource* const m_loopInner;
+		RecordSource* m_hashJoin;
+		const double m_threshold;
 	};
 
 	class MergeJoin : public Join<SortedStream>
@@ -106,6 +106,7 @@ RELATION(nam_indices, rel_indices, ODS_8_0, rel_persistent)
 	FIELD(f_idx_cond_source, nam_cond_source, fld_source, 1, ODS_13_1)
 	FIELD(f_idx_schema, nam_sch_name, fld_sch_name, 1, ODS_14_0)
 	FIELD(f_idx_foreign_schema, nam_foreign_sch_name, fld_sch_name, 1, ODS_14_0)
+	FIELD(f_idx_histogram, nam_histogram, fld_histogram, 1, ODS_14_0)
 END_RELATION
 
 // Relation 5 (RDB$RELATION_FIELDS)
@@ -133,6 +134,7 @@ RELATION(nam_r_fields, rel_rfr, ODS_8_0, rel_persistent)
 	FIELD(f_rfr_identity_type, nam_identity_type, fld_identity_type, 1, ODS_12_0)
 	FIELD(f_rfr_schema, nam_sch_name, fld_sch_name, 1, ODS_14_0)
 	FIELD(f_rfr_field_source_schema, nam_field_source_sch_name, fld_sch_name, 1, ODS_14_0)
+	FIELD(f_rfr_histogram, nam_histogram, fld_histogram, 1, ODS_14_0)
 END_RELATION
 
 // Relation 6 (RDB$RELATIONS)
@@ -344,6 +346,7 @@ RELATION(nam_gens, rel_gens, ODS_8_0, rel_persistent)
 	FIELD(f_gen_init_val, nam_init_val, fld_gen_val, 1, ODS_12_0)
 	FIELD(f_gen_increment, nam_gen_increment, fld_gen_increment, 1, ODS_12_0)
 	FIELD(f_gen_schema, nam_sch_name, fld_sch_name, 1, ODS_14_0)
+	FIELD(f_gen_cache, nam_gen_cache, fld_gen_cache, 1, ODS_14_0)
 END_RELATION
 
 // Relation 21 (RDB$FIELD_DIMENSIONS)
@@ -535,6 +538,9 @@ RELATION(nam_mon_database, rel_mon_database, ODS_11_1, rel_virtual)
 	FIELD(f_mon_db_na, nam_mon_na, fld_att_id, 0, ODS_13_0)
 	FIELD(f_mon_db_ns, nam_mon_ns, fld_stmt_id, 0, ODS_13_0)
 	FIELD(f_mon_db_repl_mode, nam_mon_repl_mode, fld_repl_mode, 0, ODS_13_0)
+	FIELD(f_mon_db_page_repl, nam_mon_page_repl, fld_page_repl, 0, ODS_14_0)
+	FIELD(f_mon_db_cache_hits, nam_mon_cache_hits, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_db_cache_misses, nam_mon_cache_misses, fld_counter, 0, ODS_14_0)
 END_RELATION
 
 // Relation 34 (MON$ATTACHMENTS)
@@ -627,6 +633,11 @@ RELATION(nam_mon_io_stats, rel_mon_io_stats, ODS_11_1, rel_virtual)
 	FIELD(f_mon_io_page_writes, nam_mon_page_writes, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_fetches, nam_mon_page_fetches, fld_counter, 0, ODS_11_1)
 	FIELD(f_mon_io_page_marks, nam_mon_page_marks, fld_counter, 0, ODS_11_1)
+	FIELD(f_mon_io_page_prefetches, nam_mon_page_prefetches, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_io_page_prefetch_hits, nam_mon_page_prefetch_hits, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_io_hash_spills, nam_mon_hash_spills, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_io_hash_partitions, nam_mon_hash_partitions, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_io_hash_spill_bytes, nam_mon_hash_spill_bytes, fld_counter, 0, ODS_14_0)
 END_RELATION
 
 // Relation 39 (MON$RECORD_STATS)
@@ -839,3 +850,23 @@ RELATION(nam_mon_local_temp_table_columns, rel_mon_local_temp_table_columns, ODS
 	FIELD(f_mon_lttc_charset_id, nam_mon_charset_id, fld_charset_id, 0, ODS_14_0)
 	FIELD(f_mon_lttc_collate_id, nam_mon_collate_id, fld_collate_id, 0, ODS_14_0)
 END_RELATION
+
+// Relation 59 (MON$PAGE_CACHE_PARTITIONS)
+RELATION(nam_mon_cache_partitions, rel_mon_cache_partitions, ODS_14_0, rel_virtual)
+	FIELD(f_mon_cp_id, nam_mon_partition_id, fld_integer, 0, ODS_14_0)
+	FIELD(f_mon_cp_node, nam_mon_numa_node, fld_integer, 0, ODS_14_0)
+	FIELD(f_mon_cp_page_bufs, nam_mon_page_bufs, fld_page_bufs, 0, ODS_14_0)
+	FIELD(f_mon_cp_hits, nam_mon_cache_hits, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_cp_misses, nam_mon_cache_misses, fld_counter, 0, ODS_14_0)
+	FIELD(f_mon_cp_page_writes, nam_mon_page_writes, fld_counter, 0, ODS_14_0)
+END_RELATION
+
+// Relation 60 (MON$SEQUENCE_CACHES)
+RELATION(nam_mon_seq_caches, rel_mon_seq_caches, ODS_14_0, rel_virtual)
+	FIELD(f_mon_seq_att_id, nam_mon_att_id, fld_att_id, 0, ODS_14_0)
+	FIELD(f_mon_seq_schema, nam_mon_sch_name, fld_sch_name, 0, ODS_14_0)
+	FIELD(f_mon_seq_name, nam_mon_seq_name, fld_gen_name, 0, ODS_14_0)
+	FIELD(f_mon_seq_cache_size, nam_mon_cache_size, fld_gen_cache, 0, ODS_14_0)
+	FIELD(f_mon_seq_next_value, nam_mon_next_value, fld_gen_val, 0, ODS_14_0)
+	FIELD(f_mon_seq_last_value, nam_mon_last_value, fld_gen_val, 0, ODS_14_0)
+END_RELATION
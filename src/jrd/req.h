@@ -64,7 +64,8 @@ struct record_param
 		  rpb_b_page(0), rpb_b_line(0),
 		  rpb_address(NULL), rpb_length(0),
 		  rpb_flags(0), rpb_stream_flags(0), rpb_runtime_flags(0),
-		  rpb_org_scans(0), rpb_window(DB_PAGE_SPACE, -1)
+		  rpb_org_scans(0), rpb_ra_sequence(0), rpb_ra_window(0),
+		  rpb_window(DB_PAGE_SPACE, -1)
 	{
 	}
 
@@ -91,6 +92,8 @@ struct record_param
 	USHORT rpb_stream_flags;		// stream flags
 	USHORT rpb_runtime_flags;		// runtime flags
 	SSHORT rpb_org_scans;			// relation scan count at stream open
+	ULONG rpb_ra_sequence;			// data page sequence read-ahead has reached
+	USHORT rpb_ra_window;			// read-ahead window in pages, zero if disabled
 
 	inline WIN& getWindow(thread_db* tdbb)
 	{
@@ -119,6 +122,7 @@ inline constexpr USHORT rpb_gc_active	= 256;		// garbage collecting dead record
 inline constexpr USHORT rpb_uk_modified	= 512;		// record key field values are changed
 inline constexpr USHORT rpb_long_tranum	= 1024;		// transaction number is 64-bit
 inline constexpr USHORT rpb_not_packed	= 2048;		// record (or delta) is stored "as is"
+inline constexpr USHORT rpb_encoded		= 4096;		// record uses column-aware encoding
 
 // Stream flags
 
@@ -129,6 +133,9 @@ inline constexpr USHORT RPB_s_unstable	= 0x08;	// don't use undo log, used with
 inline constexpr USHORT RPB_s_bulk		= 0x10;	// bulk operation (currently insert only)
 inline constexpr USHORT RPB_s_skipLocked = 0x20;	// skip locked record
 
+// Initial read-ahead window of sequential scans (in data pages)
+inline constexpr USHORT RPB_read_ahead_window = 16;
+
 // Runtime flags
 
 inline constexpr USHORT RPB_refetch			= 0x01;	// re-fetch is required
@@ -39,8 +39,10 @@
 #include "../common/gdsassert.h"
 #include "../jrd/req.h"
 #include "../jrd/val.h"
+#include "../jrd/Attachment.h"
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
+#include "../common/Task.h"
 
 #ifdef HAVE_SYS_TYPES_H
 #include <sys/types.h>
@@ -79,6 +81,21 @@ using namespace Firebird;
 constexpr ULONG MAX_SORT_BUFFER_SIZE = 1024 * 128;	// 128KB
 constexpr ULONG MIN_RECORDS_TO_ALLOC = 8;
 
+// Minimal number of records in the sort buffer per parallel worker, smaller
+// buffers are sorted faster than the workers are woken up, and number of
+// buffer intervals per worker to balance the load
+
+constexpr ULONG MIN_PARALLEL_RECORDS = 8192;
+constexpr ULONG INTERVALS_PER_WORKER = 4;
+
+// Keys up to this length (in longwords) are sorted by radix sort when
+// the buffer contains enough records, shorter intervals are finished
+// by insertion sort
+
+constexpr ULONG MAX_RADIX_KEY_LONGS = 4;
+constexpr ULONG MIN_RADIX_RECORDS = 256;
+constexpr ULONG RADIX_INSERTION_RECORDS = 32;
+
 // the size of sr_bckptr (everything before sort_record) in bytes
 #define SIZEOF_SR_BCKPTR offsetof(sr, sr_sort_record)
 // the size of sr_bckptr in # of 32 bit longwords
@@ -147,9 +164,212 @@ namespace
 		*a = *b;
 		*b = temp;
 	}
+
+	// Record pointer accompanied by two key longwords it's currently
+	// sorted by, to avoid dereferencing the record in most comparisons
+
+	struct KeyPrefix
+	{
+		FB_UINT64 prefix;
+		SORTP* record;
+	};
+
+	inline FB_UINT64 getPrefix(const SORTP* record, ULONG word, ULONG length) noexcept
+	{
+		const FB_UINT64 high = record[word];
+		const FB_UINT64 low = (word + 1 < length) ? record[word + 1] : 0;
+
+		return (high << 32) | low;
+	}
+
+	inline bool isLess(const KeyPrefix& a, const KeyPrefix& b, ULONG word, ULONG length) noexcept
+	{
+		if (a.prefix != b.prefix)
+			return a.prefix < b.prefix;
+
+		for (ULONG i = word + 2; i < length; i++)
+		{
+			if (a.record[i] != b.record[i])
+				return a.record[i] < b.record[i];
+		}
+
+		return false;
+	}
+
+	void insertionSort(KeyPrefix* items, ULONG count, ULONG word, ULONG length) noexcept
+	{
+		for (ULONG i = 1; i < count; i++)
+		{
+			const KeyPrefix item = items[i];
+			ULONG j = i;
+
+			for (; j && isLess(item, items[j - 1], word, length); j--)
+				items[j] = items[j - 1];
+
+			items[j] = item;
+		}
+	}
+
+	// MSD radix sort of the items by the key bytes starting with the given
+	// byte of the prefix, that is made of the key longwords "word" and "word + 1".
+	// When the prefix is exhausted, the next two longwords are loaded into it.
+
+	void radixPass(KeyPrefix* items, KeyPrefix* temp, ULONG count,
+		ULONG word, unsigned byte, ULONG length) noexcept
+	{
+		if (count < RADIX_INSERTION_RECORDS)
+		{
+			insertionSort(items, count, word, length);
+			return;
+		}
+
+		if (byte == sizeof(FB_UINT64))
+		{
+			word += 2;
+			if (word >= length)
+				return;
+
+			for (ULONG i = 0; i < count; i++)
+				items[i].prefix = getPrefix(items[i].record, word, length);
+
+			byte = 0;
+		}
+
+		const unsigned shift = (sizeof(FB_UINT64) - 1 - byte) * 8;
+
+		ULONG offsets[256 + 1];
+		memset(offsets, 0, sizeof(offsets));
+
+		for (ULONG i = 0; i < count; i++)
+			offsets[((items[i].prefix >> shift) & 0xFF) + 1]++;
+
+		// If all the items share the same byte, just go to the next one
+
+		if (offsets[((items[0].prefix >> shift) & 0xFF) + 1] == count)
+		{
+			radixPass(items, temp, count, word, byte + 1, length);
+			return;
+		}
+
+		for (unsigned i = 1; i <= 256; i++)
+			offsets[i] += offsets[i - 1];
+
+		ULONG positions[256];
+		memcpy(positions, offsets, sizeof(positions));
+
+		for (ULONG i = 0; i < count; i++)
+			temp[positions[(items[i].prefix >> shift) & 0xFF]++] = items[i];
+
+		memcpy(items, temp, count * sizeof(KeyPrefix));
+
+		for (unsigned i = 0; i < 256; i++)
+		{
+			const ULONG start = offsets[i];
+			const ULONG bucket = offsets[i + 1] - start;
+
+			if (bucket > 1)
+				radixPass(items + start, temp + start, bucket, word, byte + 1, length);
+		}
+	}
 } // namespace
 
 
+// Sorts the intervals of the record pointers array using parallel workers.
+// Every interval is followed by a record not less than any record of the
+// interval, so it may be sorted by quick() independently of the others.
+
+class Sort::QuickSortTask final : public Task
+{
+public:
+	struct Interval
+	{
+		SORTP** pointers;
+		SLONG size;
+	};
+
+	QuickSortTask(MemoryPool& pool, const Interval* intervals, ULONG count, ULONG length, int workers)
+		: m_intervals(intervals), m_count(count), m_length(length), m_items(pool), m_next(0)
+	{
+		for (int i = 0; i < workers; i++)
+			m_items.add(FB_NEW_POOL(pool) Item(this));
+	}
+
+	~QuickSortTask()
+	{
+		for (auto item : m_items)
+			delete item;
+	}
+
+	bool handler(WorkItem& workItem) override
+	{
+		const auto item = reinterpret_cast<Item*>(&workItem);
+		const Interval& interval = m_intervals[item->m_interval];
+
+		quick(interval.size, interval.pointers, m_length);
+		return true;
+	}
+
+	bool getWorkItem(WorkItem** pItem) override
+	{
+		auto item = reinterpret_cast<Item*>(*pItem);
+
+		MutexLockGuard guard(m_mutex, FB_FUNCTION);
+
+		if (!item)
+		{
+			for (auto freeItem : m_items)
+			{
+				if (!freeItem->m_inuse)
+				{
+					freeItem->m_inuse = true;
+					*pItem = item = freeItem;
+					break;
+				}
+			}
+		}
+
+		if (!item)
+			return false;
+
+		item->m_inuse = (m_next < m_count);
+
+		if (item->m_inuse)
+			item->m_interval = m_next++;
+
+		return item->m_inuse;
+	}
+
+	bool getResult(IStatus* /*status*/) override
+	{
+		return true;
+	}
+
+	int getMaxWorkers() override
+	{
+		return (int) MIN(m_items.getCount(), m_count);
+	}
+
+private:
+	class Item : public Task::WorkItem
+	{
+	public:
+		explicit Item(QuickSortTask* task)
+			: Task::WorkItem(task)
+		{}
+
+		bool m_inuse = false;
+		ULONG m_interval = 0;
+	};
+
+	const Interval* const m_intervals;
+	const ULONG m_count;
+	const ULONG m_length;
+	HalfStaticArray<Item*, 8> m_items;
+	Mutex m_mutex;
+	ULONG m_next;
+};
+
+
 Sort::Sort(Database* dbb,
 		   SortOwner* owner,
 		   ULONG record_length,
@@ -162,7 +382,7 @@ Sort::Sort(Database* dbb,
 	: m_dbb(dbb), m_owner(owner),
 	  m_last_record(NULL), m_next_pointer(NULL), m_records(0),
 	  m_runs(NULL), m_merge(NULL), m_free_runs(NULL),
-	  m_flags(0), m_merge_pool(NULL),
+	  m_flags(0), m_merge_pool(NULL), m_workers(1),
 	  m_description(m_owner->getPool(), keys)
 {
 /**************************************
@@ -218,6 +438,17 @@ Sort::Sort(Database* dbb,
 
 		m_unique_length = ROUNDUP(p->getSkdOffset() + p->getSkdLength(), sizeof(SLONG)) >> SHIFTLONG;
 
+		// If the user attachment may use parallel workers, make the buffer big
+		// enough to share the in-memory sorting of every run between them
+
+		if (const auto tdbb = JRD_get_thread_data())
+		{
+			const auto attachment = tdbb->getAttachment();
+
+			if (attachment && !attachment->isWorker() && attachment->att_parallel_workers > 1)
+				m_workers = attachment->att_parallel_workers;
+		}
+
 		// Next, try to allocate a "big block". How big? Big enough!
 
 		allocateBuffer(pool);
@@ -604,7 +835,9 @@ void Sort::sort(thread_db* tdbb)
 
 void Sort::allocateBuffer(MemoryPool& pool)
 {
-	if (m_max_alloc_size <= MAX_SORT_BUFFER_SIZE)
+	const ULONG bufferSize = m_max_alloc_size * m_workers;
+
+	if (bufferSize <= MAX_SORT_BUFFER_SIZE)
 	{
 		m_memory = m_owner->allocateBuffer();
 		if (m_memory)
@@ -625,7 +858,7 @@ void Sort::allocateBuffer(MemoryPool& pool)
 
 	try
 	{
-		m_size_memory = m_max_alloc_size;
+		m_size_memory = bufferSize;
 		m_memory = FB_NEW_POOL(*m_dbb->dbb_permanent) UCHAR[m_size_memory];
 
 		// Mark the buffer as cacheable for future reuse
@@ -1762,84 +1995,18 @@ void Sort::quick(SLONG size, SORTP** pointers, ULONG length) noexcept
 		// Pick up the next interval off the respective stacks
 
 		SORTP** r = *--sl;
-		SORTP** j = *--su;
+		SORTP** i = *--su;
 
 		// Compute the interval. If two or less, defer the sort to a final pass.
 
-		const SLONG interval = j - r;
+		const SLONG interval = i - r;
 		if (interval < 2)
 			continue;
 
-		// Go guard against pre-ordered data, swap the first record with the
-		// middle record. This isn't perfect, but it is cheap.
-
-		SORTP** i = r + interval / 2;
-		swap(i, r);
-
-		// Prepare to do the partition. Pick up the first longword of the
-		// key to speed up comparisons.
-
-		i = r + 1;
-		const ULONG key = **r;
-
-		// From each end of the interval converge to the middle swapping out of
-		// parition records as we go. Stop when we converge.
-
-		while (true)
-		{
-			while (**i < key)
-				i++;
-			if (**i == key)
-				while (i <= *su)
-				{
-					const SORTP* p = *i;
-					const SORTP* q = *r;
-					ULONG tl = length - 1;
-					while (tl && *p == *q)
-					{
-						p++;
-						q++;
-						tl--;
-					}
-					if (tl && *p > *q)
-						break;
-					i++;
-				}
-
-			while (**j > key)
-				j--;
-			if (**j == key)
-				while (j != r)
-				{
-					const SORTP* p = *j;
-					const SORTP* q = *r;
-					ULONG tl = length - 1;
-					while (tl && *p == *q)
-					{
-						p++;
-						q++;
-						tl--;
-					}
-					if (tl && *p < *q)
-						break;
-					j--;
-				}
-			if (i >= j)
-				break;
-			swap(i, j);
-			i++;
-			j--;
-		}
-
-		// We have formed two partitions, separated by a slot for the
-		// initial record "r". Exchange the record currently in the
-		// slot with "r".
-
-		swap(r, j);
+		SORTP** j = partition(r, i, length);
 
 		// Finally, stack the two intervals, longest first
 
-		i = *su;
 		if ((j - r) > (i - j + 1))
 		{
 			*sl++ = r;
@@ -1858,6 +2025,178 @@ void Sort::quick(SLONG size, SORTP** pointers, ULONG length) noexcept
 }
 
 
+SORTP** Sort::partition(SORTP** r, SORTP** upper, ULONG length) noexcept
+{
+/**************************************
+ *
+ * Partition the interval [r, upper] of record pointers around the
+ * middle record.  Returns the final slot of that record, all records
+ * before it are not greater and all records after it are not less.
+ * The interval must contain at least three records and be followed
+ * by a record not less than any of them.
+ *
+ **************************************/
+	SORTP** j = upper;
+
+	// Go guard against pre-ordered data, swap the first record with the
+	// middle record. This isn't perfect, but it is cheap.
+
+	SORTP** i = r + (j - r) / 2;
+	swap(i, r);
+
+	// Prepare to do the partition. Pick up the first longword of the
+	// key to speed up comparisons.
+
+	i = r + 1;
+	const ULONG key = **r;
+
+	// From each end of the interval converge to the middle swapping out of
+	// parition records as we go. Stop when we converge.
+
+	while (true)
+	{
+		while (**i < key)
+			i++;
+		if (**i == key)
+			while (i <= upper)
+			{
+				const SORTP* p = *i;
+				const SORTP* q = *r;
+				ULONG tl = length - 1;
+				while (tl && *p == *q)
+				{
+					p++;
+					q++;
+					tl--;
+				}
+				if (tl && *p > *q)
+					break;
+				i++;
+			}
+
+		while (**j > key)
+			j--;
+		if (**j == key)
+			while (j != r)
+			{
+				const SORTP* p = *j;
+				const SORTP* q = *r;
+				ULONG tl = length - 1;
+				while (tl && *p == *q)
+				{
+					p++;
+					q++;
+					tl--;
+				}
+				if (tl && *p < *q)
+					break;
+				j--;
+			}
+		if (i >= j)
+			break;
+		swap(i, j);
+		i++;
+		j--;
+	}
+
+	// We have formed two partitions, separated by a slot for the
+	// initial record "r". Exchange the record currently in the
+	// slot with "r".
+
+	swap(r, j);
+
+	return j;
+}
+
+
+void Sort::radix(SLONG size, SORTP** pointers)
+{
+/**************************************
+ *
+ * Sort an array of record pointers by MSD radix sort over the
+ * diddled keys.  Every pointer is accompanied by the first key
+ * longwords, so the records are touched only to break the ties
+ * of the longer keys.  Unlike quick() the result is final and
+ * ordered by the key only, that is all the merge takes care of.
+ *
+ **************************************/
+	const ULONG length = m_key_length;
+
+	HalfStaticArray<KeyPrefix, 256> buffer(m_owner->getPool());
+	KeyPrefix* const items = buffer.getBuffer(size * 2);
+	KeyPrefix* const temp = items + size;
+
+	for (SLONG i = 0; i < size; i++)
+	{
+		items[i].record = pointers[i];
+		items[i].prefix = getPrefix(pointers[i], 0, length);
+	}
+
+	radixPass(items, temp, size, 0, 0, length);
+
+	for (SLONG i = 0; i < size; i++)
+	{
+		pointers[i] = items[i].record;
+		((SORTP***) pointers[i])[BACK_OFFSET] = pointers + i;
+	}
+}
+
+
+bool Sort::quickParallel(thread_db* tdbb, SLONG size, SORTP** pointers, ULONG length)
+{
+/**************************************
+ *
+ * Sort an array of record pointers using parallel workers.  Split
+ * the array into intervals the same way quick() does, so the slot
+ * of the partitioning record serves as a guard for the interval
+ * before it, then let the workers sort the intervals.  The threads
+ * of the attachment are reused, if they are busy with another sort
+ * return false and let the caller sort the (partitioned) array.
+ *
+ **************************************/
+	typedef QuickSortTask::Interval Interval;
+
+	const ULONG workers = MIN((ULONG) m_workers, (ULONG) size / MIN_PARALLEL_RECORDS);
+
+	if (workers < 2)
+		return false;
+
+	const ULONG maxCount = workers * INTERVALS_PER_WORKER;
+	HalfStaticArray<Interval, 64> intervals(m_owner->getPool(), maxCount);
+
+	intervals.add({pointers, size});
+
+	while (intervals.getCount() < maxCount)
+	{
+		FB_SIZE_T largest = 0;
+
+		for (FB_SIZE_T i = 1; i < intervals.getCount(); i++)
+		{
+			if (intervals[i].size > intervals[largest].size)
+				largest = i;
+		}
+
+		const Interval interval = intervals[largest];
+
+		if (interval.size < (SLONG) MAX(MIN_PARALLEL_RECORDS / INTERVALS_PER_WORKER, 3))
+			break;
+
+		SORTP** const upper = interval.pointers + interval.size - 1;
+		SORTP** const middle = partition(interval.pointers, upper, length);
+
+		intervals[largest].size = middle - interval.pointers;
+		intervals.add({middle + 1, (SLONG) (upper - middle)});
+	}
+
+	if (intervals.getCount() < 2)
+		return false;
+
+	QuickSortTask task(m_owner->getPool(), intervals.begin(), intervals.getCount(), length, workers);
+
+	return tdbb->getAttachment()->runSortTask(&task);
+}
+
+
 ULONG Sort::order()
 {
 /**************************************
@@ -2064,7 +2403,13 @@ void Sort::sortBuffer(thread_db* tdbb)
 	SORTP** j = (SORTP**) (m_first_pointer) + 1;
 	const ULONG n = (SORTP**) (m_next_pointer) - j;	// calculate # of records
 
-	quick(n, j, m_longs);
+	if (m_workers <= 1 || !quickParallel(tdbb, n, j, m_longs))
+	{
+		if (m_key_length <= MAX_RADIX_KEY_LONGS && n >= MIN_RADIX_RECORDS)
+			radix(n, j);
+		else
+			quick(n, j, m_longs);
+	}
 
 	// Scream through and correct any out of order pairs
 	// hvlad: don't compare user keys against high_key
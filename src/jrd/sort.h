@@ -276,6 +276,8 @@ inline constexpr int scb_reuse_buffer	= 2;	// reuse buffer if possible
 class Sort
 {
 	friend class PartitionedSort;
+	class QuickSortTask;
+
 public:
 	Sort(Database*, SortOwner*,
 		 ULONG, FB_SIZE_T, FB_SIZE_T, const sort_key_def*,
@@ -325,7 +327,11 @@ private:
 	void checkFile(const run_control*);
 #endif
 
+	bool quickParallel(thread_db*, SLONG, SORTP**, ULONG);
+	void radix(SLONG, SORTP**);
+
 	static void quick(SLONG, SORTP**, ULONG) noexcept;
+	static SORTP** partition(SORTP**, SORTP**, ULONG) noexcept;
 
 	Database* m_dbb;							// Database
 	SortOwner* m_owner;							// Sort owner
@@ -351,6 +357,7 @@ private:
 
 	ULONG m_min_alloc_size;						// MIN and MAX values
 	ULONG m_max_alloc_size;						// for the run buffer size
+	int m_workers;								// Number of threads sorting the buffer
 
 	Firebird::Array<sort_key_def> m_description;
 };
@@ -23,11 +23,21 @@
 
 #include "firebird.h"
 #include <string.h>
+#include <bit>
 #include "../jrd/sqz.h"
 #include "../jrd/req.h"
+#include "../jrd/val.h"
 #include "../jrd/err_proto.h"
 #include "../yvalve/gds_proto.h"
 
+#if defined(_M_X64) || defined(__x86_64__)
+#define SQZ_SIMD
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
 using namespace Jrd;
 
 // Compression (run-length encoding aka RLE) scheme:
@@ -63,6 +73,213 @@ namespace
 		return (length <= MAX_SHORT_RUN) ? 0 :
 			(length <= MAX_MEDIUM_RUN) ? sizeof(USHORT) : sizeof(ULONG);
 	}
+
+	// Run detection kernels. The scalar ones define the result,
+	// the vectorized ones must return exactly the same.
+
+	typedef ULONG (*scan_func_t)(const UCHAR* data, ULONG length);
+
+	// Offset of the first three equal bytes in a row, or length if there are none
+	ULONG findRepeatScalar(const UCHAR* data, ULONG length) noexcept
+	{
+		for (ULONG i = 0; i + 2 < length; i++)
+		{
+			if (data[i] == data[i + 1] && data[i] == data[i + 2])
+				return i;
+		}
+
+		return length;
+	}
+
+	// Number of leading bytes equal to the first one
+	ULONG getRunLengthScalar(const UCHAR* data, ULONG length) noexcept
+	{
+		const UCHAR c = *data;
+		ULONG i = 1;
+
+		while (i < length && data[i] == c)
+			i++;
+
+		return i;
+	}
+
+#ifdef SQZ_SIMD
+
+	// SSE2 is always available on x64
+
+	ULONG findRepeatSSE2(const UCHAR* data, ULONG length) noexcept
+	{
+		ULONG i = 0;
+
+		for (; i + sizeof(__m128i) + 2 <= length; i += sizeof(__m128i))
+		{
+			const __m128i a = _mm_loadu_si128((const __m128i*) (data + i));
+			const __m128i b = _mm_loadu_si128((const __m128i*) (data + i + 1));
+			const __m128i c = _mm_loadu_si128((const __m128i*) (data + i + 2));
+
+			const unsigned mask = (unsigned) _mm_movemask_epi8(
+				_mm_and_si128(_mm_cmpeq_epi8(a, b), _mm_cmpeq_epi8(a, c)));
+
+			if (mask)
+				return i + std::countr_zero(mask);
+		}
+
+		return i + findRepeatScalar(data + i, length - i);
+	}
+
+	ULONG getRunLengthSSE2(const UCHAR* data, ULONG length) noexcept
+	{
+		const __m128i c = _mm_set1_epi8((char) *data);
+		ULONG i = 0;
+
+		for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i))
+		{
+			const unsigned mask = (unsigned) _mm_movemask_epi8(
+				_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*) (data + i)), c));
+
+			if (mask != 0xFFFF)
+				return i + std::countr_one(mask);
+		}
+
+		while (i < length && data[i] == *data)
+			i++;
+
+		return i;
+	}
+
+	// AVX2 is used if the CPU supports it, GCC and Clang compile these functions
+	// for it without the whole module being built with -mavx2
+
+#ifdef _MSC_VER
+#define SQZ_AVX2
+#else
+#define SQZ_AVX2 __attribute__((target("avx2")))
+#endif
+
+	SQZ_AVX2 ULONG findRepeatAVX2(const UCHAR* data, ULONG length) noexcept
+	{
+		ULONG i = 0;
+
+		for (; i + sizeof(__m256i) + 2 <= length; i += sizeof(__m256i))
+		{
+			const __m256i a = _mm256_loadu_si256((const __m256i*) (data + i));
+			const __m256i b = _mm256_loadu_si256((const __m256i*) (data + i + 1));
+			const __m256i c = _mm256_loadu_si256((const __m256i*) (data + i + 2));
+
+			const unsigned mask = (unsigned) _mm256_movemask_epi8(
+				_mm256_and_si256(_mm256_cmpeq_epi8(a, b), _mm256_cmpeq_epi8(a, c)));
+
+			if (mask)
+				return i + std::countr_zero(mask);
+		}
+
+		// Avoid the penalty of switching from AVX to SSE code
+		_mm256_zeroupper();
+
+		return i + findRepeatSSE2(data + i, length - i);
+	}
+
+	SQZ_AVX2 ULONG getRunLengthAVX2(const UCHAR* data, ULONG length) noexcept
+	{
+		const __m256i c = _mm256_set1_epi8((char) *data);
+		ULONG i = 0;
+
+		for (; i + sizeof(__m256i) <= length; i += sizeof(__m256i))
+		{
+			const unsigned mask = (unsigned) _mm256_movemask_epi8(
+				_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (data + i)), c));
+
+			if (mask != ~0u)
+				return i + std::countr_one(mask);
+		}
+
+		if (i == length || data[i] != *data)
+			return i;
+
+		_mm256_zeroupper();
+
+		return i + getRunLengthSSE2(data + i, length - i);
+	}
+
+#undef SQZ_AVX2
+
+	bool AVX2Supported() noexcept
+	{
+#ifdef _MSC_VER
+		constexpr int bit_OSXSAVE = 1 << 27;
+		constexpr int bit_AVX2 = 1 << 5;
+
+		int flags[4];
+		__cpuid(flags, 1);
+
+		// The OS must save the YMM registers on context switch
+		if (!(flags[2] & bit_OSXSAVE) || (_xgetbv(0) & 6) != 6)
+			return false;
+
+		__cpuidex(flags, 7, 0);
+		return (flags[1] & bit_AVX2) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	const bool useAVX2 = AVX2Supported();
+
+	scan_func_t findRepeat = useAVX2 ? findRepeatAVX2 : findRepeatSSE2;
+	scan_func_t getRunLength = useAVX2 ? getRunLengthAVX2 : getRunLengthSSE2;
+
+	// Runs are expanded with 16-byte stores, the last store overlaps the prior one
+	// to never write outside the run
+
+	inline void expandRun(UCHAR* output, UCHAR c, ULONG length) noexcept
+	{
+		if (length < sizeof(__m128i))
+		{
+			memset(output, c, length);
+			return;
+		}
+
+		const __m128i value = _mm_set1_epi8((char) c);
+		UCHAR* const last = output + length - sizeof(__m128i);
+
+		for (; output < last; output += sizeof(__m128i))
+			_mm_storeu_si128((__m128i*) output, value);
+
+		_mm_storeu_si128((__m128i*) last, value);
+	}
+
+	inline void copyRun(UCHAR* output, const UCHAR* input, ULONG length) noexcept
+	{
+		if (length < sizeof(__m128i))
+		{
+			memcpy(output, input, length);
+			return;
+		}
+
+		const ULONG last = length - sizeof(__m128i);
+
+		for (ULONG i = 0; i < last; i += sizeof(__m128i))
+			_mm_storeu_si128((__m128i*) (output + i), _mm_loadu_si128((const __m128i*) (input + i)));
+
+		_mm_storeu_si128((__m128i*) (output + last), _mm_loadu_si128((const __m128i*) (input + last)));
+	}
+
+#else	// SQZ_SIMD
+
+	scan_func_t findRepeat = findRepeatScalar;
+	scan_func_t getRunLength = getRunLengthScalar;
+
+	inline void expandRun(UCHAR* output, UCHAR c, ULONG length) noexcept
+	{
+		memset(output, c, length);
+	}
+
+	inline void copyRun(UCHAR* output, const UCHAR* input, ULONG length) noexcept
+	{
+		memcpy(output, input, length);
+	}
+
+#endif	// SQZ_SIMD
 };
 
 unsigned Compressor::nonCompressableRun(unsigned length)
@@ -116,21 +333,7 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 		// Find length of non-compressable run
 
 		if (count >= MIN_COMPRESS_RUN)
-		{
-			auto max = count - 1;
-			fb_assert(max > 1);
-
-			do {
-				if (data[0] == data[1] && data[0] == data[2])
-				{
-					count = data - start;
-					break;
-				}
-
-				data++;
-
-			} while (--max > 1);
-		}
+			count = findRepeat(data, count);
 
 		data = start + count;
 
@@ -151,19 +354,8 @@ Compressor::Compressor(MemoryPool& pool, bool allowLongRuns, bool allowUnpacked,
 		if (max < MIN_COMPRESS_RUN)
 			continue;
 
-		start = data;
-		const auto c = *data;
-
-		do
-		{
-			if (*data != c)
-				break;
-
-			++data;
-
-		} while (--max);
-
-		count = data - start;
+		count = getRunLength(data, max);
+		data += count;
 
 		if (count < MIN_COMPRESS_RUN)
 		{
@@ -493,7 +685,7 @@ UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
 				BUGCHECK(179);	// msg 179 decompression overran buffer
 
 			const auto c = *input++;
-			memset(output, c, zipLength);
+			expandRun(output, c, zipLength);
 			output += zipLength;
 		}
 		else
@@ -501,7 +693,7 @@ UCHAR* Compressor::unpack(ULONG inLength, const UCHAR* input,
 			if (input + length > end || output + length > output_end)
 				BUGCHECK(179);	// msg 179 decompression overran buffer
 
-			memcpy(output, input, length);
+			copyRun(output, input, length);
 			output += length;
 			input += length;
 		}
@@ -670,3 +862,499 @@ ULONG Difference::make(ULONG length1, const UCHAR* rec1,
 
 	return (diffLength <= MAX_DIFFERENCES) ? diffLength : 0;
 }
+
+
+// Column-aware record encoding:
+//
+// It's applied to the record image before the RLE compression, if enabled for the relation.
+// Being aware of the record format, it stores every field in the form depending on its datatype.
+//
+// NULL flags - sequence of tokens:
+//   {0 .. 127} - up to 128 following bytes are copied "as is"
+//   {128 .. 191} - up to 64 zero bytes
+//   {192 .. 255} - up to 64 bytes with all bits set
+// SMALLINT, INTEGER, BIGINT, DATE, TIME - zigzag varint, so that small values (either positive
+//   or negative) take one or two bytes
+// CHAR - varint length of the string without the trailing pad bytes, the string itself
+//   and the pad byte
+// VARCHAR - varint (length << 1 | tail flag) and the string. If the tail flag is set, it's followed
+//   by varint length and bytes of the garbage left after the string by the prior (longer) value.
+// other datatypes - copied "as is"
+//
+// Fields are stored in the order of their ids. NULL fields are skipped.
+//
+// Decoding must restore the very same record image, as differences between record versions
+// are calculated on the record images. So if either alignment gaps or NULL fields contain
+// something but zeroes, the record is not encoded and stored "as is". The same is done
+// if the encoded record is not shorter than the original one.
+
+namespace
+{
+	constexpr ULONG MAX_FLAGS_LITERAL = 128;
+	constexpr ULONG MAX_FLAGS_RUN = 64;
+
+	constexpr UCHAR FLAGS_RUN = 0x80;
+	constexpr UCHAR FLAGS_RUN_SET = 0x40;
+	constexpr UCHAR FLAGS_RUN_LENGTH = 0x3F;
+
+	constexpr USHORT MIN_TRIMMED_TEXT = 4;	// shorter CHARs are copied "as is"
+
+	class EncodeBuffer
+	{
+	public:
+		EncodeBuffer(UCHAR* output, ULONG length)
+			: m_start(output), m_ptr(output), m_end(output + length)
+		{}
+
+		// The encoded record must be shorter than the original one
+		bool putBytes(const UCHAR* data, ULONG length)
+		{
+			if (length >= (ULONG) (m_end - m_ptr))
+				return false;
+
+			memcpy(m_ptr, data, length);
+			m_ptr += length;
+			return true;
+		}
+
+		bool putByte(UCHAR c)
+		{
+			return putBytes(&c, 1);
+		}
+
+		bool putVarint(FB_UINT64 value)
+		{
+			UCHAR buffer[10];
+			ULONG length = 0;
+
+			for (; value >= 0x80; value >>= 7)
+				buffer[length++] = (UCHAR) (value | 0x80);
+
+			buffer[length++] = (UCHAR) value;
+			return putBytes(buffer, length);
+		}
+
+		ULONG getLength() const
+		{
+			return m_ptr - m_start;
+		}
+
+	private:
+		UCHAR* const m_start;
+		UCHAR* m_ptr;
+		const UCHAR* const m_end;
+	};
+
+	inline bool isZero(const UCHAR* data, ULONG length)
+	{
+		for (const auto end = data + length; data < end; data++)
+		{
+			if (*data)
+				return false;
+		}
+
+		return true;
+	}
+
+	class DecodeBuffer
+	{
+	public:
+		DecodeBuffer(const UCHAR* input, ULONG length)
+			: m_ptr(input), m_end(input + length)
+		{}
+
+		// All getters return false if the input is exhausted or malformed
+
+		bool getBytes(void* output, FB_UINT64 length)
+		{
+			if (length > (FB_UINT64) (m_end - m_ptr))
+				return false;
+
+			memcpy(output, m_ptr, length);
+			m_ptr += length;
+			return true;
+		}
+
+		bool getByte(UCHAR& c)
+		{
+			return getBytes(&c, 1);
+		}
+
+		bool getVarint(FB_UINT64& value)
+		{
+			value = 0;
+
+			for (unsigned shift = 0; shift < 64; shift += 7)
+			{
+				UCHAR c;
+				if (!getByte(c))
+					return false;
+
+				value |= (FB_UINT64) (c & 0x7F) << shift;
+
+				if (!(c & 0x80))
+					return true;
+			}
+
+			return false;
+		}
+
+		bool isPadding() const
+		{
+			return isZero(m_ptr, m_end - m_ptr);
+		}
+
+	private:
+		const UCHAR* m_ptr;
+		const UCHAR* const m_end;
+	};
+
+	inline bool isNull(const UCHAR* record, USHORT id)
+	{
+		return (record[id >> 3] & (1 << (id & 7))) != 0;
+	}
+
+	inline bool isInteger(const dsc& desc)
+	{
+		switch (desc.dsc_dtype)
+		{
+			case dtype_short:
+			case dtype_long:
+			case dtype_int64:
+			case dtype_sql_date:
+			case dtype_sql_time:
+				return true;
+		}
+
+		return false;
+	}
+
+	SINT64 getInteger(const UCHAR* field, USHORT length)
+	{
+		switch (length)
+		{
+			case sizeof(SSHORT):
+			{
+				SSHORT value;
+				memcpy(&value, field, sizeof(value));
+				return value;
+			}
+
+			case sizeof(SLONG):
+			{
+				SLONG value;
+				memcpy(&value, field, sizeof(value));
+				return value;
+			}
+		}
+
+		fb_assert(length == sizeof(SINT64));
+
+		SINT64 value;
+		memcpy(&value, field, sizeof(value));
+		return value;
+	}
+
+	void putInteger(UCHAR* field, USHORT length, SINT64 value)
+	{
+		switch (length)
+		{
+			case sizeof(SSHORT):
+			{
+				const SSHORT shortValue = (SSHORT) value;
+				memcpy(field, &shortValue, sizeof(shortValue));
+				return;
+			}
+
+			case sizeof(SLONG):
+			{
+				const SLONG longValue = (SLONG) value;
+				memcpy(field, &longValue, sizeof(longValue));
+				return;
+			}
+		}
+
+		fb_assert(length == sizeof(SINT64));
+		memcpy(field, &value, sizeof(value));
+	}
+
+	bool encodeField(EncodeBuffer& buffer, const dsc& desc, const UCHAR* field)
+	{
+		if (isInteger(desc))
+		{
+			const auto value = getInteger(field, desc.dsc_length);
+			return buffer.putVarint(((FB_UINT64) value << 1) ^ (FB_UINT64) (value >> 63));
+		}
+
+		if (desc.dsc_dtype == dtype_text && desc.dsc_length >= MIN_TRIMMED_TEXT)
+		{
+			const UCHAR pad = field[desc.dsc_length - 1];
+
+			ULONG length = desc.dsc_length - 1;
+			while (length && field[length - 1] == pad)
+				length--;
+
+			return buffer.putVarint(length) && buffer.putBytes(field, length) && buffer.putByte(pad);
+		}
+
+		if (desc.dsc_dtype == dtype_varying)
+		{
+			const auto string = (const vary*) field;
+			const ULONG capacity = desc.dsc_length - sizeof(USHORT);
+
+			if (string->vary_length > capacity)
+				return false;
+
+			const auto tail = (const UCHAR*) string->vary_string + string->vary_length;
+
+			ULONG tailLength = capacity - string->vary_length;
+			while (tailLength && !tail[tailLength - 1])
+				tailLength--;
+
+			if (!buffer.putVarint(((FB_UINT64) string->vary_length << 1) | (tailLength ? 1 : 0)) ||
+				!buffer.putBytes((const UCHAR*) string->vary_string, string->vary_length))
+			{
+				return false;
+			}
+
+			return !tailLength || (buffer.putVarint(tailLength) && buffer.putBytes(tail, tailLength));
+		}
+
+		return buffer.putBytes(field, desc.dsc_length);
+	}
+
+	bool decodeField(DecodeBuffer& buffer, const dsc& desc, UCHAR* field)
+	{
+		if (isInteger(desc))
+		{
+			FB_UINT64 value;
+			if (!buffer.getVarint(value))
+				return false;
+
+			putInteger(field, desc.dsc_length, (SINT64) (value >> 1) ^ -(SINT64) (value & 1));
+			return true;
+		}
+
+		if (desc.dsc_dtype == dtype_text && desc.dsc_length >= MIN_TRIMMED_TEXT)
+		{
+			FB_UINT64 length;
+			UCHAR pad;
+
+			if (!buffer.getVarint(length) || length >= desc.dsc_length ||
+				!buffer.getBytes(field, length) || !buffer.getByte(pad))
+			{
+				return false;
+			}
+
+			memset(field + length, pad, desc.dsc_length - length);
+			return true;
+		}
+
+		if (desc.dsc_dtype == dtype_varying)
+		{
+			const auto string = (vary*) field;
+			const ULONG capacity = desc.dsc_length - sizeof(USHORT);
+
+			FB_UINT64 header;
+			if (!buffer.getVarint(header))
+				return false;
+
+			const auto length = header >> 1;
+
+			if (length > capacity || !buffer.getBytes(string->vary_string, length))
+				return false;
+
+			string->vary_length = (USHORT) length;
+
+			if (header & 1)
+			{
+				FB_UINT64 tailLength;
+
+				if (!buffer.getVarint(tailLength) || tailLength > capacity - length ||
+					!buffer.getBytes(string->vary_string + length, tailLength))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		return buffer.getBytes(field, desc.dsc_length);
+	}
+}
+
+ULONG RecordEncoder::encode(const Format* format, ULONG length, const UCHAR* record,
+							UCHAR* output)
+{
+/**************************************
+ *
+ *	Encode a record into a buffer of the same length.
+ *	Return the encoded length, or zero if the record
+ *	cannot be encoded or it's not worth it.
+ *
+ **************************************/
+	EncodeBuffer buffer(output, length);
+
+	const ULONG flagBytes = (format->fmt_count + 7) >> 3;
+
+	if (length != format->fmt_length || flagBytes > length)
+		return 0;
+
+	for (ULONG pos = 0; pos < flagBytes;)
+	{
+		const UCHAR c = record[pos];
+
+		ULONG run = 1;
+		if (c == 0 || c == MAX_UCHAR)
+		{
+			while (pos + run < flagBytes && run < MAX_FLAGS_RUN && record[pos + run] == c)
+				run++;
+		}
+
+		if (run > 1)
+		{
+			if (!buffer.putByte(FLAGS_RUN | (c ? FLAGS_RUN_SET : 0) | (run - 1)))
+				return 0;
+
+			pos += run;
+			continue;
+		}
+
+		// Collect bytes up to the next run
+
+		ULONG literal = 1;
+		while (pos + literal < flagBytes && literal < MAX_FLAGS_LITERAL)
+		{
+			const UCHAR next = record[pos + literal];
+
+			if ((next == 0 || next == MAX_UCHAR) &&
+				pos + literal + 1 < flagBytes && record[pos + literal + 1] == next)
+			{
+				break;
+			}
+
+			literal++;
+		}
+
+		if (!buffer.putByte(literal - 1) || !buffer.putBytes(record + pos, literal))
+			return 0;
+
+		pos += literal;
+	}
+
+	ULONG offset = flagBytes;
+
+	for (USHORT id = 0; id < format->fmt_count; id++)
+	{
+		const dsc& desc = format->fmt_desc[id];
+
+		if (!desc.dsc_dtype)
+			continue;
+
+		const ULONG fieldOffset = (ULONG) (IPTR) desc.dsc_address;
+
+		if (fieldOffset < offset || fieldOffset + desc.dsc_length > length ||
+			!isZero(record + offset, fieldOffset - offset))
+		{
+			return 0;
+		}
+
+		offset = fieldOffset + desc.dsc_length;
+
+		const UCHAR* const field = record + fieldOffset;
+
+		if (isNull(record, id))
+		{
+			if (!isZero(field, desc.dsc_length))
+				return 0;
+
+			continue;
+		}
+
+		if (!encodeField(buffer, desc, field))
+			return 0;
+	}
+
+	if (!isZero(record + offset, length - offset))
+		return 0;
+
+	return buffer.getLength();
+}
+
+bool RecordEncoder::canEncode(USHORT recordFlags)
+{
+/**************************************
+ *
+ *	Whether the primary record version with given flags
+ *	is a whole record image that may be encoded. Note that
+ *	rpb_delta describes the back version, not this one.
+ *
+ **************************************/
+	return !(recordFlags & (rpb_deleted | rpb_blob | rpb_fragment));
+}
+
+ULONG RecordEncoder::decode(const Format* format, ULONG inLength, const UCHAR* input,
+							ULONG outLength, UCHAR* output)
+{
+/**************************************
+ *
+ *	Decode a record encoded by RecordEncoder::encode().
+ *	Return the record length, or zero if the input
+ *	is corrupt or was encoded using another format.
+ *
+ **************************************/
+	const ULONG length = format->fmt_length;
+
+	if (length > outLength)
+		BUGCHECK(179);	// msg 179 decompression overran buffer
+
+	memset(output, 0, length);
+
+	DecodeBuffer buffer(input, inLength);
+
+	const ULONG flagBytes = (format->fmt_count + 7) >> 3;
+
+	for (ULONG pos = 0; pos < flagBytes;)
+	{
+		UCHAR token;
+		if (!buffer.getByte(token))
+			return 0;
+
+		const ULONG count = (token & FLAGS_RUN) ? (token & FLAGS_RUN_LENGTH) + 1 : token + 1;
+
+		if (pos + count > flagBytes)
+			return 0;
+
+		if (!(token & FLAGS_RUN))
+		{
+			if (!buffer.getBytes(output + pos, count))
+				return 0;
+		}
+		else if (token & FLAGS_RUN_SET)
+			memset(output + pos, MAX_UCHAR, count);
+
+		pos += count;
+	}
+
+	for (USHORT id = 0; id < format->fmt_count; id++)
+	{
+		const dsc& desc = format->fmt_desc[id];
+
+		if (!desc.dsc_dtype || isNull(output, id))
+			continue;
+
+		const ULONG fieldOffset = (ULONG) (IPTR) desc.dsc_address;
+
+		if (fieldOffset < flagBytes || fieldOffset + desc.dsc_length > length ||
+			!decodeField(buffer, desc, output + fieldOffset))
+		{
+			return 0;
+		}
+	}
+
+	// Short records may be zero-padded up to the fragmented header size.
+	// Something else left means the record was encoded using another format.
+
+	return buffer.isPadding() ? length : 0;
+}
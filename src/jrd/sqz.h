@@ -30,6 +30,7 @@
 namespace Jrd
 {
 	class thread_db;
+	class Format;
 
 	class Compressor
 	{
@@ -96,6 +97,17 @@ namespace Jrd
 		UCHAR m_differences[MAX_DIFFERENCES];
 	};
 
+	class RecordEncoder
+	{
+	public:
+		static ULONG encode(const Format* format, ULONG length, const UCHAR* record,
+							UCHAR* output);
+		static ULONG decode(const Format* format, ULONG inLength, const UCHAR* input,
+							ULONG outLength, UCHAR* output);
+
+		static bool canEncode(USHORT recordFlags);
+	};
+
 } //namespace Jrd
 
 #endif // JRD_SQZ_H
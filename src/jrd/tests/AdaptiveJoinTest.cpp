@@ -0,0 +1,202 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <vector>
+#include "../common/classes/Hash.h"
+#include "../jrd/HashSpillFile.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+// Record sources need a running request, so these tests replay the fetch protocol of
+// AdaptiveJoin over in-memory streams: outer rows are joined by the nested loop until
+// their count exceeds the threshold, the row that exceeds it is the first one passed
+// to the hash join (see AdaptiveJoin::OuterStream). Partitioned hash join restarts
+// the outer stream, that starts with the same row again (see HashJoin::partitionLeader).
+
+namespace
+{
+	// Positions of the joined outer and inner records
+	typedef std::vector<std::pair<ULONG, ULONG> > Rows;
+
+	// Join keys of a stream, record position is the index in the vector
+	std::vector<ULONG> makeKeys(ULONG count, ULONG distinct)
+	{
+		std::vector<ULONG> keys;
+
+		for (ULONG i = 0; i < count; i++)
+			keys.push_back(i * 7919 % distinct);
+
+		return keys;
+	}
+
+	// Hash the key the way HashJoin::computeHash() does
+	ULONG hashKey(ULONG key)
+	{
+		return InternalHash::hash(sizeof(key), reinterpret_cast<const UCHAR*>(&key));
+	}
+
+	// Nested loop looks up the inner stream for the outer row
+	void joinLoop(const std::vector<ULONG>& outer, ULONG outerPos, const std::vector<ULONG>& inner, Rows& rows)
+	{
+		for (ULONG innerPos = 0; innerPos < inner.size(); innerPos++)
+		{
+			if (inner[innerPos] == outer[outerPos])
+				rows.emplace_back(outerPos, innerPos);
+		}
+	}
+
+	// Hash join of the outer rows starting with the given one. Hashes are compared first,
+	// then the keys are re-checked, as AdaptiveJoin filters the hash join output.
+	void joinHash(const std::vector<ULONG>& outer, ULONG first, const std::vector<ULONG>& inner, Rows& rows)
+	{
+		std::multimap<ULONG, ULONG> table;
+
+		for (ULONG innerPos = 0; innerPos < inner.size(); innerPos++)
+			table.emplace(hashKey(inner[innerPos]), innerPos);
+
+		for (ULONG outerPos = first; outerPos < outer.size(); outerPos++)
+		{
+			const auto range = table.equal_range(hashKey(outer[outerPos]));
+
+			for (auto iter = range.first; iter != range.second; ++iter)
+			{
+				if (inner[iter->second] == outer[outerPos])
+					rows.emplace_back(outerPos, iter->second);
+			}
+		}
+	}
+
+	// The same, but both inputs are partitioned into the spill file and joined partition by partition
+	void joinSpilled(MemoryPool& pool, ULONG partitionCount,
+		const std::vector<ULONG>& outer, ULONG first, const std::vector<ULONG>& inner, Rows& rows)
+	{
+		HashSpillFile spill(pool, 2, partitionCount);
+
+		for (ULONG innerPos = 0; innerPos < inner.size(); innerPos++)
+			spill.put(0, hashKey(inner[innerPos]), innerPos);
+
+		for (ULONG outerPos = first; outerPos < outer.size(); outerPos++)
+			spill.put(1, hashKey(outer[outerPos]), outerPos);
+
+		ULONG hash, position;
+
+		for (ULONG partition = 0; partition < partitionCount; partition++)
+		{
+			std::multimap<ULONG, ULONG> table;
+
+			spill.open(0, partition);
+			while (spill.next(hash, position))
+				table.emplace(hash, position);
+
+			spill.open(1, partition);
+			while (spill.next(hash, position))
+			{
+				const auto range = table.equal_range(hash);
+
+				for (auto iter = range.first; iter != range.second; ++iter)
+				{
+					if (inner[iter->second] == outer[position])
+						rows.emplace_back(position, iter->second);
+				}
+			}
+		}
+	}
+
+	Rows joinNestedLoop(const std::vector<ULONG>& outer, const std::vector<ULONG>& inner)
+	{
+		Rows rows;
+
+		for (ULONG outerPos = 0; outerPos < outer.size(); outerPos++)
+			joinLoop(outer, outerPos, inner, rows);
+
+		std::sort(rows.begin(), rows.end());
+		return rows;
+	}
+
+	// Zero partition count means the hash join fits into memory
+	Rows joinAdaptive(MemoryPool& pool, ULONG threshold, ULONG partitionCount,
+		const std::vector<ULONG>& outer, const std::vector<ULONG>& inner)
+	{
+		Rows rows;
+		ULONG outerRows = 0;
+
+		for (ULONG outerPos = 0; outerPos < outer.size(); outerPos++)
+		{
+			if (++outerRows > threshold)
+			{
+				if (partitionCount)
+					joinSpilled(pool, partitionCount, outer, outerPos, inner, rows);
+				else
+					joinHash(outer, outerPos, inner, rows);
+
+				break;
+			}
+
+			joinLoop(outer, outerPos, inner, rows);
+		}
+
+		std::sort(rows.begin(), rows.end());
+		return rows;
+	}
+
+	// Number of the joined rows of the outer record
+	size_t countOuter(const Rows& rows, ULONG outerPos)
+	{
+		return std::count_if(rows.begin(), rows.end(),
+			[outerPos](const std::pair<ULONG, ULONG>& row) { return row.first == outerPos; });
+	}
+
+	void checkSwitch(MemoryPool& pool, ULONG partitionCount)
+	{
+		// Every key of the inner stream is met three times
+		const auto outer = makeKeys(3000, 2000);
+		const auto inner = makeKeys(6000, 2000);
+
+		const Rows expected = joinNestedLoop(outer, inner);
+		BOOST_TEST(expected.size() == outer.size() * 3);
+
+		const ULONG thresholds[] = {0, 1, 1000, 2999, 3000, 5000};
+
+		for (const auto threshold : thresholds)
+		{
+			const Rows rows = joinAdaptive(pool, threshold, partitionCount, outer, inner);
+
+			BOOST_TEST((rows == expected));
+			BOOST_TEST((std::adjacent_find(rows.begin(), rows.end()) == rows.end()));
+
+			// The row that triggers the switch is joined once, by the hash join
+			if (threshold < outer.size())
+				BOOST_TEST(countOuter(rows, threshold) == 3u);
+		}
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(AdaptiveJoinSuite)
+
+
+BOOST_AUTO_TEST_SUITE(AdaptiveJoinTests)
+
+// Join crossing the threshold returns the same rows as the nested loop
+BOOST_AUTO_TEST_CASE(SwitchTest)
+{
+	checkSwitch(*getDefaultMemoryPool(), 0);
+}
+
+// The same when the hash join after the switch is partitioned into the temporary space
+BOOST_AUTO_TEST_CASE(SpilledSwitchTest)
+{
+	for (ULONG partitionCount = 2; partitionCount <= HashSpillFile::MAX_PARTITIONS; partitionCount *= 8)
+		checkSwitch(*getDefaultMemoryPool(), partitionCount);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// AdaptiveJoinTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// AdaptiveJoinSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
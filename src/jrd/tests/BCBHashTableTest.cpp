@@ -0,0 +1,288 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include "../jrd/BCBHashTable.h"
+
+#ifndef CDS_UNAVAILABLE
+#include <cds/threading/model.h>
+#endif
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	// Lock-free lists use hazard pointers that need the thread to be attached to libcds.
+	class CdsThreadHolder
+	{
+	public:
+		CdsThreadHolder()
+		{
+#ifndef CDS_UNAVAILABLE
+			attached = !cds::threading::Manager::isThreadAttached();
+			if (attached)
+				cds::threading::Manager::attachThread();
+#endif
+		}
+
+		~CdsThreadHolder()
+		{
+#ifndef CDS_UNAVAILABLE
+			if (attached)
+				cds::threading::Manager::detachThread();
+#endif
+		}
+
+	private:
+		bool attached = false;
+	};
+
+	// Page buffers that hold pages 1..count, put into hash table the same way as get_buffer() does.
+	class BufferSet
+	{
+	public:
+		BufferSet(MemoryPool& pool, BCBHashTable& table, ULONG count)
+		{
+			for (ULONG i = 0; i < count; ++i)
+			{
+				BufferDesc* const bdb = FB_NEW_POOL(pool) BufferDesc(nullptr);
+				const PageNumber page(DB_PAGE_SPACE, i + 1);
+
+				if (!table.emplace(bdb, page, false))
+					bdb->bdb_page = page;
+
+				buffers.push_back(bdb);
+			}
+		}
+
+		~BufferSet()
+		{
+			for (auto bdb : buffers)
+				delete bdb;
+		}
+
+		BufferDesc* operator[](ULONG index) const
+		{
+			return buffers[index];
+		}
+
+	private:
+		std::vector<BufferDesc*> buffers;
+	};
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(BCBHashTableSuite)
+
+
+BOOST_AUTO_TEST_SUITE(BCBHashTableTests)
+
+BOOST_AUTO_TEST_CASE(EmplaceFindRemoveTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	CdsThreadHolder cdsThread;
+
+	constexpr ULONG COUNT = 1000;
+
+	BCBHashTable table(pool, COUNT / 4);
+	BufferSet buffers(pool, table, COUNT);
+
+	for (ULONG i = 0; i < COUNT; ++i)
+		BOOST_TEST(table.find(PageNumber(DB_PAGE_SPACE, i + 1)) == buffers[i]);
+
+	BOOST_TEST(!table.find(PageNumber(DB_PAGE_SPACE, COUNT + 1)));
+
+	// Occupied page is not replaced
+	BOOST_TEST(table.emplace(buffers[1], PageNumber(DB_PAGE_SPACE, 1), true) == buffers[0]);
+
+	// Reuse buffer for another page
+	const PageNumber newPage(DB_PAGE_SPACE, COUNT + 1);
+	BOOST_TEST(!table.emplace(buffers[0], newPage, true));
+	buffers[0]->bdb_page = newPage;
+
+	BOOST_TEST(!table.find(PageNumber(DB_PAGE_SPACE, 1)));
+	BOOST_TEST(table.find(newPage) == buffers[0]);
+
+	// Hint is matched against the page buffer was put into table with, not against
+	// bdb_page - it's changed without synchronization and re-checked by callers
+	buffers[1]->bdb_page = PageNumber(DB_PAGE_SPACE, COUNT + 2);
+	BOOST_TEST(table.find(PageNumber(DB_PAGE_SPACE, 2)) == buffers[1]);
+	buffers[1]->bdb_page = PageNumber(DB_PAGE_SPACE, 2);
+
+	table.remove(buffers[2]);
+	BOOST_TEST(!table.find(PageNumber(DB_PAGE_SPACE, 3)));
+
+	table.resize(COUNT * 2);
+
+	BOOST_TEST(table.find(newPage) == buffers[0]);
+	for (ULONG i = 3; i < COUNT; ++i)
+		BOOST_TEST(table.find(PageNumber(DB_PAGE_SPACE, i + 1)) == buffers[i]);
+}
+
+#ifndef CDS_UNAVAILABLE
+// Buffer removed while it's being looked up must not stay in the slot hint
+BOOST_AUTO_TEST_CASE(FindRemoveRaceTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	CdsThreadHolder cdsThread;
+
+	constexpr ULONG COUNT = 64;
+	constexpr unsigned ROUNDS = 200;
+
+	BCBHashTable table(pool, COUNT / 8);
+	BufferSet buffers(pool, table, COUNT);
+
+	const unsigned threadCount = std::max(std::thread::hardware_concurrency(), 2u);
+	unsigned errors = 0;
+
+	for (unsigned round = 0; round < ROUNDS; ++round)
+	{
+		std::atomic<bool> stop{false};
+		std::vector<std::thread> threads;
+
+		for (unsigned threadNum = 0; threadNum < threadCount; ++threadNum)
+		{
+			threads.emplace_back([&, threadNum]() {
+				CdsThreadHolder cdsThread;
+
+				for (ULONG n = threadNum; !stop.load(std::memory_order_relaxed); ++n)
+					table.find(PageNumber(DB_PAGE_SPACE, n % COUNT + 1));
+			});
+		}
+
+		// Buffers keep their pages, as cp_empty ones do
+		for (ULONG i = 1; i < COUNT; i += 2)
+			table.remove(buffers[i]);
+
+		stop = true;
+
+		for (auto& thread : threads)
+			thread.join();
+
+		for (ULONG i = 1; i < COUNT; i += 2)
+		{
+			if (table.find(PageNumber(DB_PAGE_SPACE, i + 1)))
+				++errors;
+
+			table.emplace(buffers[i], PageNumber(DB_PAGE_SPACE, i + 1), false);
+		}
+	}
+
+	BOOST_TEST(errors == 0u);
+}
+
+// Slots array replaced by resize() is freed while lookups keep running
+BOOST_AUTO_TEST_CASE(FindResizeRaceTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	CdsThreadHolder cdsThread;
+
+	constexpr ULONG COUNT = 1024;
+	constexpr unsigned RESIZES = 100;
+
+	BCBHashTable table(pool, 16);
+	BufferSet buffers(pool, table, COUNT);
+
+	const unsigned threadCount = std::max(std::thread::hardware_concurrency(), 2u);
+	std::atomic<bool> stop{false};
+	std::atomic<unsigned> found{0}, errors{0};
+	std::vector<std::thread> threads;
+
+	for (unsigned threadNum = 0; threadNum < threadCount; ++threadNum)
+	{
+		threads.emplace_back([&, threadNum]() {
+			CdsThreadHolder cdsThread;
+
+			for (ULONG n = threadNum; !stop.load(std::memory_order_relaxed); ++n)
+			{
+				// Page could be moved to another array at the moment and missed,
+				// but never found in a wrong buffer
+				const ULONG index = n % COUNT;
+				BufferDesc* const bdb = table.find(PageNumber(DB_PAGE_SPACE, index + 1));
+				if (bdb == buffers[index])
+					++found;
+				else if (bdb)
+					++errors;
+			}
+		});
+	}
+
+	for (unsigned i = 0; i < RESIZES || found.load() < COUNT; ++i)
+		table.resize(16 + i % RESIZES * 7);
+
+	stop = true;
+
+	for (auto& thread : threads)
+		thread.join();
+
+	BOOST_TEST(errors == 0u);
+
+	for (ULONG i = 0; i < COUNT; ++i)
+		BOOST_TEST(table.find(PageNumber(DB_PAGE_SPACE, i + 1)) == buffers[i]);
+}
+#endif // CDS_UNAVAILABLE
+
+// Cache-hit lookup throughput by number of threads, run with --log_level=message to see it.
+BOOST_AUTO_TEST_CASE(FindScalabilityTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	CdsThreadHolder cdsThread;
+
+	constexpr ULONG COUNT = 65536;
+	constexpr unsigned LOOKUPS = 1000000;
+
+	BCBHashTable table(pool, COUNT);
+	BufferSet buffers(pool, table, COUNT);
+
+	const unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	for (unsigned threadCount = 1; ; threadCount = std::min(threadCount * 2, maxThreads))
+	{
+		std::atomic<unsigned> errors{0};
+		std::vector<std::thread> threads;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (unsigned threadNum = 0; threadNum < threadCount; ++threadNum)
+		{
+			threads.emplace_back([&, threadNum]() {
+				CdsThreadHolder cdsThread;
+				ULONG seed = threadNum * 2654435761u + 1;
+
+				for (unsigned n = 0; n < LOOKUPS; ++n)
+				{
+					seed ^= seed << 13;
+					seed ^= seed >> 17;
+					seed ^= seed << 5;
+
+					const ULONG index = seed % COUNT;
+					if (table.find(PageNumber(DB_PAGE_SPACE, index + 1)) != buffers[index])
+						++errors;
+				}
+			});
+		}
+
+		for (auto& thread : threads)
+			thread.join();
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		BOOST_TEST(errors == 0u);
+		BOOST_TEST_MESSAGE("threads: " << threadCount << ", lookups/sec: " <<
+			static_cast<FB_UINT64>(threadCount * LOOKUPS / elapsed.count()));
+
+		if (threadCount == maxThreads)
+			break;
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// BCBHashTableTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// BCBHashTableSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
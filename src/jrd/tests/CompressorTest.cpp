@@ -1,10 +1,354 @@
 #include "firebird.h"
 #include "boost/test/unit_test.hpp"
+#include <chrono>
 #include "../jrd/sqz.h"
+#include "../jrd/req.h"
+#include "../jrd/val.h"
 
 using namespace Firebird;
 using namespace Jrd;
 
+
+namespace
+{
+	struct FieldType
+	{
+		UCHAR dtype;
+		USHORT length;
+	};
+
+	// Lays out fields the same way as the engine does
+	Format* makeFormat(MemoryPool& pool, const FieldType* fields, USHORT count)
+	{
+		Format* const format = Format::newFormat(pool, count);
+		ULONG offset = FLAG_BYTES(count);
+
+		for (USHORT i = 0; i < count; i++)
+		{
+			dsc& desc = format->fmt_desc[i];
+			desc.dsc_dtype = fields[i].dtype;
+			desc.dsc_length = fields[i].length;
+
+			if (const auto alignment = type_alignments[desc.dsc_dtype])
+				offset = FB_ALIGN(offset, alignment);
+
+			desc.dsc_address = (UCHAR*) (IPTR) offset;
+			offset += desc.dsc_length;
+		}
+
+		format->fmt_length = offset;
+		return format;
+	}
+
+	// ID BIGINT, STATUS SMALLINT, QUANTITY INTEGER, PRICE NUMERIC(18, 2), NAME VARCHAR(100),
+	// CODE CHAR(10), NOTE VARCHAR(500), CREATED DATE, WEIGHT DOUBLE PRECISION
+	const FieldType ORDER_FIELDS[] = {
+		{dtype_int64, sizeof(SINT64)},
+		{dtype_short, sizeof(SSHORT)},
+		{dtype_long, sizeof(SLONG)},
+		{dtype_int64, sizeof(SINT64)},
+		{dtype_varying, 100 + sizeof(USHORT)},
+		{dtype_text, 10},
+		{dtype_varying, 500 + sizeof(USHORT)},
+		{dtype_sql_date, sizeof(SLONG)},
+		{dtype_double, sizeof(double)}
+	};
+
+	const USHORT ORDER_FIELD_COUNT = FB_NELEM(ORDER_FIELDS);
+
+	class TestRecord
+	{
+	public:
+		explicit TestRecord(const Format* format)
+			: m_format(format)
+		{
+			m_data.getBuffer(format->fmt_length);
+			nullify();
+		}
+
+		void nullify()
+		{
+			memset(m_data.begin(), 0, m_data.getCount());
+
+			for (USHORT id = 0; id < m_format->fmt_count; id++)
+				setNull(id);
+		}
+
+		void setNull(USHORT id)
+		{
+			m_data[id >> 3] |= (1 << (id & 7));
+			memset(getField(id), 0, m_format->fmt_desc[id].dsc_length);
+		}
+
+		void setInteger(USHORT id, SINT64 value)
+		{
+			clearNull(id);
+
+			const auto length = m_format->fmt_desc[id].dsc_length;
+			if (length == sizeof(SSHORT))
+			{
+				const SSHORT shortValue = (SSHORT) value;
+				memcpy(getField(id), &shortValue, length);
+			}
+			else if (length == sizeof(SLONG))
+			{
+				const SLONG longValue = (SLONG) value;
+				memcpy(getField(id), &longValue, length);
+			}
+			else
+				memcpy(getField(id), &value, length);
+		}
+
+		void setDouble(USHORT id, double value)
+		{
+			clearNull(id);
+			memcpy(getField(id), &value, sizeof(value));
+		}
+
+		// Like the engine, doesn't clear the garbage left by the prior value of VARCHAR
+		void setString(USHORT id, const char* value)
+		{
+			clearNull(id);
+
+			const dsc& desc = m_format->fmt_desc[id];
+			const USHORT length = (USHORT) strlen(value);
+
+			if (desc.dsc_dtype == dtype_varying)
+			{
+				vary* const string = (vary*) getField(id);
+				string->vary_length = length;
+				memcpy(string->vary_string, value, length);
+			}
+			else
+			{
+				memset(getField(id), ' ', desc.dsc_length);
+				memcpy(getField(id), value, length);
+			}
+		}
+
+		UCHAR* getData()
+		{
+			return m_data.begin();
+		}
+
+		ULONG getLength() const
+		{
+			return m_data.getCount();
+		}
+
+	private:
+		void clearNull(USHORT id)
+		{
+			m_data[id >> 3] &= ~(1 << (id & 7));
+		}
+
+		UCHAR* getField(USHORT id)
+		{
+			return m_data.begin() + (IPTR) m_format->fmt_desc[id].dsc_address;
+		}
+
+		const Format* const m_format;
+		Array<UCHAR> m_data;
+	};
+
+	class Generator
+	{
+	public:
+		ULONG next()
+		{
+			m_seed ^= m_seed << 13;
+			m_seed ^= m_seed >> 17;
+			m_seed ^= m_seed << 5;
+			return m_seed;
+		}
+
+	private:
+		ULONG m_seed = 2463534242u;
+	};
+
+	void fillOrder(TestRecord& record, Generator& generator, SINT64 id, USHORT base = 0)
+	{
+		static const char* const NAMES[] = {"Smith", "Johnson & Sons Ltd.", "Garcia", "Nakamura Trading Co."};
+		static const char* const CODES[] = {"A1", "B22", "C333", "D4444"};
+
+		record.setInteger(base + 0, id);
+		record.setInteger(base + 1, generator.next() % 5);
+		record.setInteger(base + 2, generator.next() % 1000);
+		record.setInteger(base + 3, generator.next() % 1000000);
+		record.setString(base + 4, NAMES[generator.next() % FB_NELEM(NAMES)]);
+		record.setString(base + 5, CODES[generator.next() % FB_NELEM(CODES)]);
+
+		if (generator.next() % 10 == 0)
+			record.setString(base + 6, "Deliver to the back door, ring twice");
+		else
+			record.setNull(base + 6);
+
+		record.setInteger(base + 7, 59000 + generator.next() % 1000);
+
+		if (generator.next() % 2)
+			record.setDouble(base + 8, (generator.next() % 10000) / 100.0);
+		else
+			record.setNull(base + 8);
+	}
+
+	// Straightforward byte by byte RLE, vectorized compression must produce the same output
+	void referencePack(const UCHAR* data, ULONG length, bool allowLongRuns, Array<UCHAR>& output)
+	{
+		const UCHAR* const end = data + length;
+		output.clear();
+
+		// Position of the last non-compressable run length in the output, to be able to extend it
+		FB_SIZE_T literal = ~0u;
+
+		const auto putLiteral = [&](const UCHAR* p, ULONG count)
+		{
+			while (count)
+			{
+				if (literal == ~0u || output[literal] == 127)
+				{
+					literal = output.getCount();
+					output.add(0);
+				}
+
+				const ULONG max = MIN(count, 127u - output[literal]);
+				output[literal] += max;
+				output.add(p, max);
+				p += max;
+				count -= max;
+			}
+		};
+
+		while (data < end)
+		{
+			const UCHAR* start = data;
+			ULONG count = end - data;
+
+			if (count >= 8)
+			{
+				for (ULONG i = 0; i + 2 < count; i++)
+				{
+					if (data[i] == data[i + 1] && data[i] == data[i + 2])
+					{
+						count = i;
+						break;
+					}
+				}
+			}
+
+			putLiteral(start, count);
+			data += count;
+
+			if (end - data < 8)
+				continue;
+
+			start = data;
+			while (data < end && *data == *start)
+				data++;
+
+			count = data - start;
+
+			if (count < 8)
+			{
+				putLiteral(start, count);
+				continue;
+			}
+
+			literal = ~0u;
+
+			if (allowLongRuns)
+			{
+				if (count <= 128)
+					output.add((UCHAR) -(int) count);
+				else if (count <= MAX_USHORT)
+				{
+					output.add((UCHAR) -1);
+					const USHORT shortCount = (USHORT) count;
+					output.add((const UCHAR*) &shortCount, sizeof(shortCount));
+				}
+				else
+				{
+					output.add((UCHAR) -2);
+					output.add((const UCHAR*) &count, sizeof(count));
+				}
+
+				output.add(*start);
+			}
+			else
+			{
+				while (count)
+				{
+					const ULONG max = MIN(count, 128u);
+					if (max < 3)
+					{
+						data -= max;
+						break;
+					}
+
+					output.add((UCHAR) -(int) max);
+					output.add(*start);
+					count -= max;
+				}
+			}
+		}
+	}
+
+	void checkPack(MemoryPool& pool, const UCHAR* data, ULONG length)
+	{
+		Array<UCHAR> expected, packed, unpacked;
+
+		for (const bool allowLongRuns : {false, true})
+		{
+			referencePack(data, length, allowLongRuns, expected);
+
+			const Compressor dcc(pool, allowLongRuns, false, length, data);
+			BOOST_TEST(dcc.getPackedLength() == expected.getCount());
+
+			if (dcc.getPackedLength() != expected.getCount())
+				continue;
+
+			dcc.pack(data, packed.getBuffer(dcc.getPackedLength()));
+			BOOST_TEST(memcmp(packed.begin(), expected.begin(), expected.getCount()) == 0);
+
+			BOOST_TEST(Compressor::unpack(packed.getCount(), packed.begin(),
+				length, unpacked.getBuffer(length)) == unpacked.end());
+			BOOST_TEST(memcmp(unpacked.begin(), data, length) == 0);
+		}
+	}
+
+	// Encode, compress, decompress and decode the record, as it's done by the engine
+	void checkRoundTrip(const Format* format, TestRecord& record, bool expectEncoded = true)
+	{
+		auto& pool = *getDefaultMemoryPool();
+		const auto length = record.getLength();
+
+		Array<UCHAR> encoded;
+		const auto encodedLength = RecordEncoder::encode(format, length, record.getData(),
+			encoded.getBuffer(length));
+
+		BOOST_TEST((encodedLength != 0) == expectEncoded);
+		if (!encodedLength)
+			return;
+
+		BOOST_TEST(encodedLength < length);
+
+		const Compressor dcc(pool, true, false, encodedLength, encoded.begin());
+
+		Array<UCHAR> packed;
+		dcc.pack(encoded.begin(), packed.getBuffer(dcc.getPackedLength()));
+
+		Array<UCHAR> unpacked;
+		const auto end = Compressor::unpack(packed.getCount(), packed.begin(),
+			length, unpacked.getBuffer(length));
+
+		Array<UCHAR> decoded;
+		BOOST_TEST(RecordEncoder::decode(format, end - unpacked.begin(), unpacked.begin(),
+			length, decoded.getBuffer(length)) == length);
+
+		BOOST_TEST(memcmp(decoded.begin(), record.getData(), length) == 0);
+	}
+}
+
+
 BOOST_AUTO_TEST_SUITE(EngineSuite)
 BOOST_AUTO_TEST_SUITE(CompressorSuite)
 
@@ -33,8 +377,430 @@ BOOST_AUTO_TEST_CASE(PackAndUnpackTest)
 	BOOST_TEST(memcmp(data, unpackBuffer.begin(), dataLength) == 0);
 }
 
+// Runs and repeats must be found at every position relative to the vector width
+BOOST_AUTO_TEST_CASE(ReferencePackTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	Generator generator;
+	Array<UCHAR> data;
+
+	for (ULONG length = 1; length <= 300; length++)
+	{
+		UCHAR* const p = data.getBuffer(length);
+
+		// Few distinct values make repeats of any length likely
+		for (ULONG i = 0; i < length; i++)
+			p[i] = (UCHAR) (generator.next() % 3);
+
+		checkPack(pool, p, length);
+
+		// Single run at every offset and of every length
+		for (ULONG offset = 0; offset < length; offset++)
+		{
+			for (ULONG i = 0; i < length; i++)
+				p[i] = (UCHAR) i;
+
+			const ULONG runLength = 1 + generator.next() % (length - offset);
+			memset(p + offset, 0xFF, runLength);
+
+			checkPack(pool, p, length);
+		}
+	}
+
+	// Long runs
+	for (const ULONG length : {127u, 128u, 129u, 200u, 65535u, 65536u, 65537u, 100000u})
+	{
+		UCHAR* const p = data.getBuffer(length + 3);
+		memset(p, 0, length + 3);
+		p[0] = 1;
+		p[length + 2] = 2;
+
+		checkPack(pool, p, length + 3);
+	}
+}
+
+// Pack and unpack speed for the row shapes that are typical for OLTP tables.
+// It's a benchmark rather than a check, so it's disabled by default. Run it with
+// --run_test=EngineSuite/CompressorSuite/CompressorTests/ThroughputTest --log_level=message
+BOOST_AUTO_TEST_CASE(ThroughputTest, *boost::unit_test::disabled())
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	constexpr unsigned COUNT = 100000;
+	constexpr unsigned PASSES = 10;
+
+	// Narrow row of integers, most of them small
+	FieldType narrowFields[8];
+	for (auto& field : narrowFields)
+		field = {dtype_long, sizeof(SLONG)};
+
+	// Wide row with long VARCHARs that are mostly short or NULL
+	FieldType wideFields[ORDER_FIELD_COUNT * 4];
+	for (USHORT i = 0; i < FB_NELEM(wideFields); i++)
+		wideFields[i] = ORDER_FIELDS[i % ORDER_FIELD_COUNT];
+
+	const struct
+	{
+		const char* name;
+		const FieldType* fields;
+		USHORT count;
+	} shapes[] = {
+		{"narrow", narrowFields, FB_NELEM(narrowFields)},
+		{"order", ORDER_FIELDS, ORDER_FIELD_COUNT},
+		{"wide", wideFields, FB_NELEM(wideFields)}
+	};
+
+	for (const auto& shape : shapes)
+	{
+		AutoPtr<Format> format(makeFormat(pool, shape.fields, shape.count));
+		const auto length = format->fmt_length;
+
+		// Pre-generate the records to measure nothing but compression
+		Generator generator;
+		TestRecord record(format);
+		Array<UCHAR> records, packed, unpacked;
+		Array<ULONG> offsets;
+
+		for (unsigned i = 0; i < COUNT / PASSES; i++)
+		{
+			if (shape.fields == narrowFields)
+			{
+				for (USHORT id = 0; id < shape.count; id++)
+					record.setInteger(id, (id == 0) ? i : generator.next() % 100);
+			}
+			else
+			{
+				for (USHORT base = 0; base < shape.count; base += ORDER_FIELD_COUNT)
+					fillOrder(record, generator, i, base);
+			}
+
+			records.add(record.getData(), length);
+		}
+
+		unpacked.getBuffer(length);
+
+		FB_UINT64 packedLength = 0;
+		std::chrono::duration<double> packTime(0), unpackTime(0);
+		unsigned errors = 0;
+
+		for (unsigned pass = 0; pass < PASSES; pass++)
+		{
+			packed.clear();
+			offsets.clear();
+
+			auto start = std::chrono::steady_clock::now();
+
+			for (unsigned i = 0; i < COUNT / PASSES; i++)
+			{
+				const UCHAR* const data = records.begin() + i * length;
+				const Compressor dcc(pool, true, false, length, data);
+
+				offsets.add(packed.getCount());
+				dcc.pack(data, packed.getBuffer(packed.getCount() + dcc.getPackedLength()) + offsets.back());
+			}
+
+			packTime += std::chrono::steady_clock::now() - start;
+			packedLength += packed.getCount();
+			offsets.add(packed.getCount());
+
+			start = std::chrono::steady_clock::now();
+
+			for (unsigned i = 0; i < COUNT / PASSES; i++)
+			{
+				Compressor::unpack(offsets[i + 1] - offsets[i], packed.begin() + offsets[i],
+					length, unpacked.begin());
+			}
+
+			unpackTime += std::chrono::steady_clock::now() - start;
+
+			// Check the last record only, not to disturb the measurement
+			if (memcmp(unpacked.begin(), records.end() - length, length))
+				errors++;
+		}
+
+		BOOST_TEST(errors == 0u);
+
+		const double megabytes = (double) length * COUNT / (1024 * 1024);
+
+		BOOST_TEST_MESSAGE(shape.name << ": record length " << length <<
+			", compression ratio " << (double) length * COUNT / packedLength <<
+			", pack MB/sec " << static_cast<FB_UINT64>(megabytes / packTime.count()) <<
+			", unpack MB/sec " << static_cast<FB_UINT64>(megabytes / unpackTime.count()));
+	}
+}
+
 BOOST_AUTO_TEST_SUITE_END()	// CompressorTests
 
 
+BOOST_AUTO_TEST_SUITE(RecordEncoderTests)
+
+BOOST_AUTO_TEST_CASE(EncodeAndDecodeTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	AutoPtr<Format> format(makeFormat(pool, ORDER_FIELDS, ORDER_FIELD_COUNT));
+
+	TestRecord record(format);
+
+	// All fields are NULL
+	checkRoundTrip(format, record);
+
+	record.setInteger(0, 1);
+	record.setInteger(1, -1);
+	record.setInteger(2, MIN_SLONG);
+	record.setInteger(3, MAX_SINT64);
+	record.setString(4, "Long enough name to leave some garbage after a shorter one");
+	record.setString(5, "CODE");
+	record.setString(6, "");
+	record.setInteger(7, -678575);
+	record.setDouble(8, 3.14);
+	checkRoundTrip(format, record);
+
+	// VARCHAR tail is not zeroed
+	record.setString(4, "Short name");
+	checkRoundTrip(format, record);
+
+	// CHAR contains nothing but spaces, and then isn't padded at all
+	record.setString(5, "");
+	checkRoundTrip(format, record);
+
+	record.setString(5, "0123456789");
+	checkRoundTrip(format, record);
+}
+
+BOOST_AUTO_TEST_CASE(NotEncodedTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	AutoPtr<Format> format(makeFormat(pool, ORDER_FIELDS, ORDER_FIELD_COUNT));
+
+	TestRecord record(format);
+	Generator generator;
+	fillOrder(record, generator, 1);
+
+	// NULL field that isn't zeroed cannot be restored by decoding
+	record.setNull(4);
+	record.getData()[(IPTR) format->fmt_desc[4].dsc_address + sizeof(USHORT)] = 'x';
+	checkRoundTrip(format, record, false);
+
+	// Neither can the garbage inside alignment gaps
+	fillOrder(record, generator, 1);
+	const IPTR gap = (IPTR) format->fmt_desc[1].dsc_address + sizeof(SSHORT);
+	BOOST_TEST(gap < (IPTR) format->fmt_desc[2].dsc_address);
+	record.getData()[gap] = 1;
+	checkRoundTrip(format, record, false);
+
+	// Large integers take more space when encoded
+	FieldType intFields[24];
+	for (auto& field : intFields)
+		field = {dtype_long, sizeof(SLONG)};
+
+	AutoPtr<Format> intFormat(makeFormat(pool, intFields, FB_NELEM(intFields)));
+
+	TestRecord intRecord(intFormat);
+	for (USHORT id = 0; id < FB_NELEM(intFields); id++)
+		intRecord.setInteger(id, MAX_SLONG - id);
+
+	checkRoundTrip(intFormat, intRecord, false);
+}
+
+// Back versions are stored as differences between the record images,
+// they must be applicable to the decoded primary version
+BOOST_AUTO_TEST_CASE(DifferenceTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	AutoPtr<Format> format(makeFormat(pool, ORDER_FIELDS, ORDER_FIELD_COUNT));
+
+	Generator generator;
+
+	TestRecord oldRecord(format);
+	fillOrder(oldRecord, generator, 1);
+	oldRecord.setString(4, "Johnson & Sons Ltd.");
+	oldRecord.setString(6, "Deliver to the back door, ring twice");
+
+	TestRecord newRecord(format);
+	memcpy(newRecord.getData(), oldRecord.getData(), oldRecord.getLength());
+	newRecord.setInteger(1, 4);
+	newRecord.setString(4, "Garcia");
+	newRecord.setNull(6);
+
+	const auto length = newRecord.getLength();
+
+	Difference difference;
+	const auto diffLength = difference.make(length, newRecord.getData(), length, oldRecord.getData());
+	BOOST_TEST(diffLength != 0u);
+
+	Array<UCHAR> encoded;
+	const auto encodedLength = RecordEncoder::encode(format, length, newRecord.getData(),
+		encoded.getBuffer(length));
+	BOOST_TEST(encodedLength != 0u);
+
+	Array<UCHAR> decoded;
+	RecordEncoder::decode(format, encodedLength, encoded.begin(), length, decoded.getBuffer(length));
+	BOOST_TEST(memcmp(decoded.begin(), newRecord.getData(), length) == 0);
+
+	BOOST_TEST(difference.apply(diffLength, length, decoded.begin()) == length);
+	BOOST_TEST(memcmp(decoded.begin(), oldRecord.getData(), length) == 0);
+}
+
+// Update stores the new primary version as a whole image with rpb_delta set, as its back
+// version became a difference. Such a primary version is still encoded.
+BOOST_AUTO_TEST_CASE(UpdatedPrimaryTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	AutoPtr<Format> format(makeFormat(pool, ORDER_FIELDS, ORDER_FIELD_COUNT));
+
+	Generator generator;
+
+	TestRecord oldRecord(format);
+	fillOrder(oldRecord, generator, 1);
+
+	TestRecord newRecord(format);
+	memcpy(newRecord.getData(), oldRecord.getData(), oldRecord.getLength());
+	newRecord.setInteger(2, 42);
+
+	const auto length = newRecord.getLength();
+
+	// Same as store_version() in vio.cpp does
+
+	USHORT newFlags = 0;
+
+	Difference difference;
+	const auto diffLength = difference.make(length, newRecord.getData(), length, oldRecord.getData());
+
+	if (diffLength && diffLength < length)
+		newFlags |= rpb_delta;
+
+	BOOST_TEST((newFlags & rpb_delta) != 0);
+	BOOST_TEST(RecordEncoder::canEncode(newFlags));
+	BOOST_TEST(RecordEncoder::canEncode(newFlags | rpb_uk_modified | rpb_long_tranum));
+
+	Array<UCHAR> encoded;
+	const auto encodedLength = RecordEncoder::encode(format, length, newRecord.getData(),
+		encoded.getBuffer(length));
+	BOOST_TEST(encodedLength != 0u);
+	BOOST_TEST(encodedLength < length);
+
+	Array<UCHAR> decoded;
+	BOOST_TEST(RecordEncoder::decode(format, encodedLength, encoded.begin(), length,
+		decoded.getBuffer(length)) == length);
+	BOOST_TEST(memcmp(decoded.begin(), newRecord.getData(), length) == 0);
+
+	BOOST_TEST(difference.apply(diffLength, length, decoded.begin()) == length);
+	BOOST_TEST(memcmp(decoded.begin(), oldRecord.getData(), length) == 0);
+
+	// Record images that aren't whole are never encoded
+	BOOST_TEST(!RecordEncoder::canEncode(rpb_deleted | rpb_delta));
+	BOOST_TEST(!RecordEncoder::canEncode(rpb_fragment | rpb_delta));
+	BOOST_TEST(!RecordEncoder::canEncode(rpb_blob));
+}
+
+// Validation decodes records as they are on disk, corrupt input must be reported, not bugchecked
+BOOST_AUTO_TEST_CASE(CorruptInputTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+	AutoPtr<Format> format(makeFormat(pool, ORDER_FIELDS, ORDER_FIELD_COUNT));
+
+	TestRecord record(format);
+	Generator generator;
+	fillOrder(record, generator, 1);
+
+	const auto length = record.getLength();
+
+	Array<UCHAR> encoded;
+	const auto encodedLength = RecordEncoder::encode(format, length, record.getData(),
+		encoded.getBuffer(length));
+	BOOST_TEST(encodedLength != 0u);
+	encoded.shrink(encodedLength);
+
+	Array<UCHAR> decoded;
+	decoded.getBuffer(length);
+
+	for (ULONG truncated = 0; truncated < encodedLength; truncated++)
+	{
+		BOOST_TEST(RecordEncoder::decode(format, truncated, encoded.begin(), length,
+			decoded.begin()) == 0u);
+	}
+
+	// Short records may be zero-padded on disk
+	encoded.add(0);
+	encoded.add(0);
+	BOOST_TEST(RecordEncoder::decode(format, encoded.getCount(), encoded.begin(), length,
+		decoded.begin()) == length);
+	BOOST_TEST(memcmp(decoded.begin(), record.getData(), length) == 0);
+
+	encoded.add(1);
+	BOOST_TEST(RecordEncoder::decode(format, encoded.getCount(), encoded.begin(), length,
+		decoded.begin()) == 0u);
+}
+
+// Record size and CPU time of RLE alone and of RLE applied to the encoded records.
+// It's a benchmark, the round trip is checked by EncodeAndDecodeTest, so it's disabled by default.
+// Run it with --run_test=EngineSuite/CompressorSuite/RecordEncoderTests/CompressionRatioTest --log_level=message
+BOOST_AUTO_TEST_CASE(CompressionRatioTest, *boost::unit_test::disabled())
+{
+	auto& pool = *getDefaultMemoryPool();
+	AutoPtr<Format> format(makeFormat(pool, ORDER_FIELDS, ORDER_FIELD_COUNT));
+
+	constexpr unsigned COUNT = 100000;
+
+	TestRecord record(format);
+	const auto length = record.getLength();
+
+	Array<UCHAR> encoded, packed, unpacked, decoded;
+	encoded.getBuffer(length);
+	unpacked.getBuffer(length);
+	decoded.getBuffer(length);
+
+	for (const bool encode : {false, true})
+	{
+		Generator generator;
+		FB_UINT64 totalLength = 0;
+		unsigned errors = 0;
+
+		const auto start = std::chrono::steady_clock::now();
+
+		for (unsigned i = 0; i < COUNT; i++)
+		{
+			fillOrder(record, generator, i);
+
+			ULONG dataLength = encode ?
+				RecordEncoder::encode(format, length, record.getData(), encoded.begin()) : 0;
+			const UCHAR* const data = dataLength ? encoded.begin() : record.getData();
+
+			if (!dataLength)
+				dataLength = length;
+
+			const Compressor dcc(pool, true, false, dataLength, data);
+			dcc.pack(data, packed.getBuffer(dcc.getPackedLength()));
+			totalLength += packed.getCount();
+
+			const auto end = Compressor::unpack(packed.getCount(), packed.begin(), length, unpacked.begin());
+
+			if (data == encoded.begin())
+			{
+				RecordEncoder::decode(format, end - unpacked.begin(), unpacked.begin(),
+					length, decoded.begin());
+
+				if (memcmp(decoded.begin(), record.getData(), length))
+					errors++;
+			}
+			else if (memcmp(unpacked.begin(), record.getData(), length))
+				errors++;
+		}
+
+		const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		BOOST_TEST(errors == 0u);
+		BOOST_TEST_MESSAGE((encode ? "column encoding + RLE" : "RLE") <<
+			": record length " << length <<
+			", average stored length " << (double) totalLength / COUNT <<
+			", compression ratio " << (double) length * COUNT / totalLength <<
+			", records/sec " << static_cast<FB_UINT64>(COUNT / elapsed.count()));
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// RecordEncoderTests
+
+
 BOOST_AUTO_TEST_SUITE_END()	// CompressorSuite
 BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -0,0 +1,150 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include <algorithm>
+#include <map>
+#include <vector>
+#include "../common/classes/Hash.h"
+#include "../jrd/HashSpillFile.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	// Join keys of a stream, record position is the index in the vector
+	std::vector<ULONG> makeKeys(ULONG count, ULONG distinct)
+	{
+		std::vector<ULONG> keys;
+
+		for (ULONG i = 0; i < count; i++)
+			keys.push_back(i * 7919 % distinct);
+
+		return keys;
+	}
+
+	// Hash the key the way HashJoin::computeHash() does
+	ULONG hashKey(ULONG key)
+	{
+		return InternalHash::hash(sizeof(key), reinterpret_cast<const UCHAR*>(&key));
+	}
+
+	// Number of rows returned by the inner join of two streams built in memory
+	FB_UINT64 joinInMemory(const std::vector<ULONG>& inner, const std::vector<ULONG>& leader)
+	{
+		std::multimap<ULONG, ULONG> table;
+
+		for (ULONG position = 0; position < inner.size(); position++)
+			table.emplace(hashKey(inner[position]), position);
+
+		FB_UINT64 rows = 0;
+
+		for (const auto key : leader)
+		{
+			const auto range = table.equal_range(hashKey(key));
+
+			for (auto iter = range.first; iter != range.second; ++iter)
+				rows += (inner[iter->second] == key);
+		}
+
+		return rows;
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(HashSpillFileSuite)
+
+
+BOOST_AUTO_TEST_SUITE(HashSpillFileTests)
+
+// Partitioned join of the spilled entries returns the same rows as the one built in memory
+BOOST_AUTO_TEST_CASE(PartitionedJoinTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	const auto inner = makeKeys(20000, 3000);
+	const auto leader = makeKeys(15000, 5000);
+
+	const FB_UINT64 expected = joinInMemory(inner, leader);
+	BOOST_TEST(expected > 0u);
+
+	for (ULONG partitionCount = 2; partitionCount <= HashSpillFile::MAX_PARTITIONS; partitionCount *= 4)
+	{
+		HashSpillFile spill(pool, 2, partitionCount);
+		BOOST_TEST(spill.getPartitionCount() == partitionCount);
+
+		for (ULONG position = 0; position < inner.size(); position++)
+			spill.put(0, hashKey(inner[position]), position);
+
+		for (ULONG position = 0; position < leader.size(); position++)
+			spill.put(1, hashKey(leader[position]), position);
+
+		// Chunks of every partition were flushed into the temporary space
+		BOOST_TEST(spill.getSize() > 0u);
+
+		std::vector<bool> innerSeen(inner.size()), leaderSeen(leader.size());
+		FB_UINT64 rows = 0;
+		ULONG hash, position;
+
+		for (ULONG partition = 0; partition < partitionCount; partition++)
+		{
+			std::multimap<ULONG, ULONG> table;
+
+			spill.open(0, partition);
+			while (spill.next(hash, position))
+			{
+				BOOST_TEST(hash == hashKey(inner[position]));
+				BOOST_TEST(!innerSeen[position]);
+				innerSeen[position] = true;
+
+				table.emplace(hash, position);
+			}
+
+			spill.open(1, partition);
+			while (spill.next(hash, position))
+			{
+				BOOST_TEST(hash == hashKey(leader[position]));
+				BOOST_TEST(!leaderSeen[position]);
+				leaderSeen[position] = true;
+
+				const auto range = table.equal_range(hash);
+				for (auto iter = range.first; iter != range.second; ++iter)
+					rows += (inner[iter->second] == leader[position]);
+			}
+		}
+
+		BOOST_TEST(std::count(innerSeen.begin(), innerSeen.end(), false) == 0);
+		BOOST_TEST(std::count(leaderSeen.begin(), leaderSeen.end(), false) == 0);
+		BOOST_TEST(rows == expected);
+	}
+}
+
+// Entries are read back in the order they were put, also across the flushed chunks
+BOOST_AUTO_TEST_CASE(OrderTest)
+{
+	auto& pool = *getDefaultMemoryPool();
+
+	HashSpillFile spill(pool, 1, 2);
+
+	// All the entries go into the same partition
+	for (ULONG position = 0; position < 2000; position++)
+		spill.put(0, 0, position);
+
+	ULONG hash, position, expected = 0;
+
+	spill.open(0, 0);
+	while (spill.next(hash, position))
+		BOOST_TEST(position == expected++);
+
+	BOOST_TEST(expected == 2000u);
+
+	spill.open(0, 1);
+	BOOST_TEST(!spill.next(hash, position));
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// HashSpillFileTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// HashSpillFileSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
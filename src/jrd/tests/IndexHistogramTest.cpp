@@ -0,0 +1,180 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include "../jrd/IndexHistogram.h"
+#include "../jrd/ods.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	// Big-endian integers are binary comparable as index keys are
+	struct IntKey
+	{
+		explicit IntKey(ULONG value)
+		{
+			data[0] = (UCHAR) (value >> 24);
+			data[1] = (UCHAR) (value >> 16);
+			data[2] = (UCHAR) (value >> 8);
+			data[3] = (UCHAR) value;
+		}
+
+		UCHAR data[4];
+	};
+
+	// Half of 10000 keys is zero, the others are unique
+	void fillSkewed(IndexHistogram& histogram)
+	{
+		for (ULONG i = 0; i < 5000; i++)
+			histogram.add(IntKey(0).data, sizeof(IntKey::data));
+
+		for (ULONG i = 1; i <= 5000; i++)
+			histogram.add(IntKey(i).data, sizeof(IntKey::data));
+
+		histogram.finish();
+	}
+
+	void checkSkewed(const IndexHistogram& histogram)
+	{
+		BOOST_TEST(histogram.getEqualSelectivity(IntKey(0).data, 4) == 0.5,
+			boost::test_tools::tolerance(0.001));
+		BOOST_TEST(histogram.getEqualSelectivity(IntKey(100).data, 4) == 0.0001,
+			boost::test_tools::tolerance(0.001));
+
+		// Values 1..2000 are 20% of keys
+		BOOST_TEST(histogram.getRangeSelectivity(IntKey(1).data, 4, false, IntKey(2000).data, 4, false) == 0.2,
+			boost::test_tools::tolerance(0.1));
+
+		// Values greater than zero are half of keys
+		BOOST_TEST(histogram.getRangeSelectivity(IntKey(0).data, 4, true, nullptr, 0, false) == 0.5,
+			boost::test_tools::tolerance(0.05));
+
+		BOOST_TEST(histogram.getRangeSelectivity(nullptr, 0, false, nullptr, 0, false) == 1.0,
+			boost::test_tools::tolerance(0.001));
+	}
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(IndexHistogramSuite)
+
+
+BOOST_AUTO_TEST_SUITE(IndexHistogramTests)
+
+BOOST_AUTO_TEST_CASE(SkewedDistributionTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+	BOOST_TEST(histogram.isEmpty());
+
+	fillSkewed(histogram);
+	BOOST_TEST(!histogram.isEmpty());
+
+	checkSkewed(histogram);
+}
+
+BOOST_AUTO_TEST_CASE(StoreParseTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+	fillSkewed(histogram);
+
+	UCharBuffer buffer;
+	histogram.store(buffer);
+
+	IndexHistogram parsed(*getDefaultMemoryPool());
+	BOOST_TEST(parsed.parse(buffer.begin(), buffer.getCount()));
+
+	checkSkewed(parsed);
+
+	// Unknown version is ignored
+	buffer[0] = 0xFF;
+	BOOST_TEST(!parsed.parse(buffer.begin(), buffer.getCount()));
+	BOOST_TEST(parsed.isEmpty());
+}
+
+// Keys sampled in random order make the same histogram as the sorted ones
+BOOST_AUTO_TEST_CASE(SampleTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+	histogram.setKeyType(5);
+
+	ULONG position = 0;
+	for (ULONG i = 0; i < 10000; i++)
+	{
+		// Every 7th value, as 7 is coprime with 10000
+		const ULONG value = i * 7 % 10000;
+		histogram.addSample(position++, IntKey(value < 5000 ? 0 : value - 4999).data, 4);
+	}
+
+	BOOST_TEST(histogram.getSampleCount() == 10000u);
+
+	// Sample replaces the keys, their number remains the same
+	histogram.addSample(0, IntKey(0).data, 4);
+	BOOST_TEST(histogram.getSampleCount() == 10000u);
+
+	histogram.finishSample(10000);
+	BOOST_TEST(histogram.getSampleCount() == 0u);
+
+	checkSkewed(histogram);
+
+	UCharBuffer buffer;
+	histogram.store(buffer);
+
+	IndexHistogram parsed(*getDefaultMemoryPool());
+	BOOST_TEST(parsed.parse(buffer.begin(), buffer.getCount()));
+	BOOST_TEST(parsed.getKeyType() == 5u);
+
+	checkSkewed(parsed);
+}
+
+// Number of distinct keys is scaled up when the sample is a small part of all keys
+BOOST_AUTO_TEST_CASE(SampleDistinctTest)
+{
+	IndexHistogram histogram(*getDefaultMemoryPool());
+
+	// Unique keys, so the others are likely to be unique as well
+	for (ULONG i = 0; i < 1000; i++)
+		histogram.addSample(i, IntKey(i * 100).data, 4);
+
+	histogram.finishSample(100000);
+
+	BOOST_TEST(histogram.getKeyType() == IndexHistogram::UNKNOWN_KEY_TYPE);
+	BOOST_TEST(histogram.getEqualSelectivity(IntKey(50).data, 4) == 0.00001,
+		boost::test_tools::tolerance(0.01));
+
+	// Every key is met 10 times, so there are no unseen ones
+	IndexHistogram repeated(*getDefaultMemoryPool());
+
+	for (ULONG i = 0; i < 1000; i++)
+		repeated.addSample(i, IntKey(i % 100).data, 4);
+
+	repeated.finishSample(100000);
+
+	BOOST_TEST(repeated.getEqualSelectivity(IntKey(50).data, 4) == 0.01,
+		boost::test_tools::tolerance(0.01));
+}
+
+BOOST_AUTO_TEST_CASE(LeadingLengthTest)
+{
+	// Two segments: 6 bytes of the first one and 2 bytes of the second one
+	const UCHAR key[] = {2, 'a', 'b', 'c', 'd', 2, 'e', 'f', 0, 0, 1, 'g', 'h'};
+	const USHORT length = sizeof(key);
+
+	BOOST_TEST(IndexHistogram::getLeadingLength(key, length, 1, false) == length);
+	BOOST_TEST(IndexHistogram::getLeadingLength(key, length, 2, false) == 2 * (Ods::STUFF_COUNT + 1));
+
+	UCHAR descKey[length];
+	for (USHORT i = 0; i < length; i++)
+		descKey[i] = 255 - key[i];
+
+	BOOST_TEST(IndexHistogram::getLeadingLength(descKey, length, 2, true) == 2 * (Ods::STUFF_COUNT + 1));
+
+	// Empty first segment
+	BOOST_TEST(IndexHistogram::getLeadingLength(key + 10, 3, 2, false) == 0);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// IndexHistogramTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// IndexHistogramSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
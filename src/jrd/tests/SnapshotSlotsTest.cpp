@@ -0,0 +1,194 @@
+#include "firebird.h"
+#include "boost/test/unit_test.hpp"
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../jrd/SnapshotSlots.h"
+
+using namespace Firebird;
+using namespace Jrd;
+
+
+namespace
+{
+	// Snapshots list of given size, laid out the same way as in shared memory.
+	class SlotsBuffer
+	{
+	public:
+		explicit SlotsBuffer(ULONG count)
+			: buffer(new SnapshotSlots::Slot[count + sizeof(SnapshotSlots) / sizeof(SnapshotSlots::Slot) + 1])
+		{
+			memset(buffer.get(), 0, (count + sizeof(SnapshotSlots) / sizeof(SnapshotSlots::Slot) + 1) *
+				sizeof(SnapshotSlots::Slot));
+
+			slots = reinterpret_cast<SnapshotSlots*>(buffer.get());
+			slots->initSlots(count);
+		}
+
+		SnapshotSlots* operator->() const
+		{
+			return slots;
+		}
+
+	private:
+		std::unique_ptr<SnapshotSlots::Slot[]> buffer;
+		SnapshotSlots* slots;
+	};
+}
+
+
+BOOST_AUTO_TEST_SUITE(EngineSuite)
+BOOST_AUTO_TEST_SUITE(SnapshotSlotsSuite)
+
+
+BOOST_AUTO_TEST_SUITE(SnapshotSlotsTests)
+
+BOOST_AUTO_TEST_CASE(AllocateReleaseTest)
+{
+	constexpr ULONG COUNT = 8;
+	constexpr AttNumber RELEASER = 100;
+
+	SlotsBuffer slots(COUNT);
+	SnapshotHandle handles[COUNT];
+
+	for (ULONG i = 0; i < COUNT; ++i)
+	{
+		BOOST_TEST(slots->allocate(i + 1, handles[i]));
+		BOOST_TEST(handles[i] == i);
+	}
+
+	SnapshotHandle handle;
+	BOOST_TEST(!slots->allocate(COUNT + 1, handle));
+	BOOST_TEST(slots->slots_used.load() == COUNT);
+
+	// Released slot in the middle is reused
+	slots->release(handles[3], RELEASER);
+	BOOST_TEST(slots->slots_used.load() == COUNT);
+	BOOST_TEST(slots->allocate(COUNT + 1, handle));
+	BOOST_TEST(handle == 3u);
+	BOOST_TEST(slots->slots[3].attachment_id.load() == COUNT + 1);
+	handles[3] = handle;
+
+	// Free slots at the end are cut off from the used ones
+	slots->release(handles[5], RELEASER);
+	slots->release(handles[6], RELEASER);
+	BOOST_TEST(slots->slots_used.load() == COUNT);
+	slots->release(handles[7], RELEASER);
+	BOOST_TEST(slots->slots_used.load() == 5u);
+
+	for (ULONG i = 5; i < COUNT; ++i)
+		BOOST_TEST(slots->slots[i].attachment_id.load() == 0u);
+
+	for (ULONG i = 0; i < 5; ++i)
+		slots->release(handles[i], RELEASER);
+
+	BOOST_TEST(slots->slots_used.load() == 0u);
+}
+
+// Process was killed while cutting off free slots at the end
+BOOST_AUTO_TEST_CASE(ResetReservedTest)
+{
+	constexpr ULONG COUNT = 4;
+	constexpr AttNumber DEAD = 100;
+	constexpr AttNumber RELEASER = 200;
+
+	SlotsBuffer slots(COUNT);
+	SnapshotHandle handles[COUNT];
+
+	for (ULONG i = 0; i < COUNT; ++i)
+		BOOST_TEST(slots->allocate(i + 1, handles[i]));
+
+	const AttNumber reserved = SnapshotSlots::RESERVED | DEAD;
+	BOOST_TEST(SnapshotSlots::isReserved(reserved));
+	BOOST_TEST(SnapshotSlots::reservedBy(reserved) == DEAD);
+
+	for (ULONG i = 2; i < COUNT; ++i)
+	{
+		slots->slots[i].snapshot.store(0);
+		slots->slots[i].attachment_id.store(reserved);
+	}
+
+	// Reserved slots are never allocated
+	SnapshotHandle handle;
+	BOOST_TEST(!slots->allocate(COUNT + 1, handle));
+	BOOST_TEST(slots->slots_used.load() == COUNT);
+
+	BOOST_TEST(!slots->resetReserved(2, SnapshotSlots::RESERVED | RELEASER, RELEASER));
+	BOOST_TEST(slots->resetReserved(2, reserved, RELEASER));
+	BOOST_TEST(slots->slots_used.load() == COUNT);
+
+	// Once the last one is reset, the count goes down
+	BOOST_TEST(slots->resetReserved(3, reserved, RELEASER));
+	BOOST_TEST(slots->slots_used.load() == 2u);
+
+	for (ULONG i = 2; i < COUNT; ++i)
+		BOOST_TEST(slots->slots[i].attachment_id.load() == 0u);
+
+	BOOST_TEST(slots->allocate(COUNT + 1, handle));
+	BOOST_TEST(handle == 2u);
+}
+
+// Threads allocate and release slots at once, nobody gets a slot that is taken
+BOOST_AUTO_TEST_CASE(ConcurrentAllocateTest)
+{
+	constexpr unsigned THREADS = 4;
+	constexpr unsigned PAIRS = 10000;
+
+	// Every thread holds at most two slots at a time
+	SlotsBuffer slots(THREADS * 2);
+
+	std::atomic<unsigned> errors{0};
+	std::vector<std::thread> threads;
+
+	for (unsigned threadNum = 0; threadNum < THREADS; ++threadNum)
+	{
+		threads.emplace_back([&, threadNum]() {
+			const AttNumber attachmentId = threadNum + 1;
+
+			for (unsigned n = 0; n < PAIRS; ++n)
+			{
+				SnapshotHandle handles[2];
+
+				for (auto& handle : handles)
+				{
+					if (!slots->allocate(attachmentId, handle))
+					{
+						++errors;
+						return;
+					}
+
+					slots->slots[handle].snapshot.store(n + 1, std::memory_order_release);
+				}
+
+				for (auto handle : handles)
+				{
+					if (handle >= slots->slots_used.load() ||
+						slots->slots[handle].attachment_id.load() != attachmentId ||
+						slots->slots[handle].snapshot.load() != n + 1)
+					{
+						++errors;
+					}
+
+					slots->release(handle, attachmentId);
+				}
+			}
+		});
+	}
+
+	for (auto& thread : threads)
+		thread.join();
+
+	BOOST_TEST(errors == 0u);
+	BOOST_TEST(slots->slots_used.load() == 0u);
+
+	for (unsigned n = 0; n < THREADS * 2; ++n)
+		BOOST_TEST(slots->slots[n].attachment_id.load() == 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()	// SnapshotSlotsTests
+
+
+BOOST_AUTO_TEST_SUITE_END()	// SnapshotSlotsSuite
+BOOST_AUTO_TEST_SUITE_END()	// EngineSuite
@@ -83,15 +83,13 @@ bool TipCache::SnapshotsInitializer::initialize(SharedMemoryBase* sm, bool initF
 	if (!initFlag)
 		return true;
 
-	SnapshotList* header = static_cast<SnapshotList*>(sm->sh_mem_header);
+	SnapshotSlots* header = static_cast<SnapshotSlots*>(sm->sh_mem_header);
 
 	// Initialize the shared data header
 	initHeader(header);
 
-	header->slots_used.store(0, std::memory_order_relaxed);
-	header->min_free_slot = 0;
-	const ULONG dataSize = sm->sh_mem_length_mapped - offsetof(SnapshotList, slots[0]);
-	header->slots_allocated.store(dataSize / sizeof(SnapshotData), std::memory_order_relaxed);
+	const ULONG dataSize = sm->sh_mem_length_mapped - offsetof(SnapshotSlots, slots[0]);
+	header->initSlots(dataSize / sizeof(SnapshotSlots::Slot));
 
 	return true;
 }
@@ -116,8 +114,10 @@ bool TipCache::MemBlockInitializer::initialize(SharedMemoryBase* sm, bool initFl
 TipCache::TipCache(Database* dbb)
 	: m_tpcHeader(NULL), m_snapshots(NULL), m_transactionsPerBlock(0), m_lock(nullptr),
 	  globalTpcInitializer(this), snapshotsInitializer(this), memBlockInitializer(this),
-	  m_blocks_memory(*dbb->dbb_permanent)
+	  m_blocks_memory(*dbb->dbb_permanent), m_retiredBlocks(*dbb->dbb_permanent)
 {
+	for (auto& blockData : m_blockCache)
+		blockData.store(NULL, std::memory_order_relaxed);
 }
 
 TipCache::~TipCache()
@@ -147,6 +147,9 @@ void TipCache::finalizeTpc(thread_db* tdbb)
 	if (!LCK_convert(tdbb, m_lock, LCK_SW, LCK_WAIT))
 		ERR_bugcheck_msg("Unable to convert TPC lock (SW)");
 
+	for (auto& blockData : m_blockCache)
+		blockData.store(NULL, std::memory_order_relaxed);
+
 	// Release locks and deallocate all shared memory structures
 	if (m_blocks_memory.getFirst())
 	{
@@ -157,6 +160,11 @@ void TipCache::finalizeTpc(thread_db* tdbb)
 		} while (m_blocks_memory.getNext());
 	}
 
+	for (auto block : m_retiredBlocks)
+		delete block;
+
+	m_retiredBlocks.clear();
+
 	PathName nmSnap, nmHdr;
 	if (m_snapshots)
 	{
@@ -208,6 +216,25 @@ CommitNumber TipCache::cacheState(TraNumber number)
 	const TpcBlockNumber blockNumber = number / m_transactionsPerBlock;
 	const ULONG offset = number % m_transactionsPerBlock;
 
+	// Recently used block is read without locks. Registering as a reader must
+	// precede reading the mapping, unpublish() does the same in reverse order.
+
+	StatusBlockData* const blockData =
+		m_blockCache[blockNumber % BLOCK_CACHE_SIZE].load(std::memory_order_acquire);
+
+	if (blockData && blockData->blockNumber == blockNumber)
+	{
+		blockData->readers.fetch_add(1);
+
+		const TransactionStatusBlock* const block = blockData->published.load();
+		const CommitNumber state = block ? block->data[offset].load(std::memory_order_relaxed) : 0;
+
+		blockData->readers.fetch_sub(1, std::memory_order_release);
+
+		if (block)
+			return state;
+	}
+
 	Sync sync(&m_sync_status, FB_FUNCTION);
 	const TransactionStatusBlock* block = getTransactionStatusBlock(header, blockNumber, sync);
 
@@ -220,9 +247,7 @@ CommitNumber TipCache::cacheState(TraNumber number)
 	// Barrier is not needed here when we are reading state from cache
 	// because all callers of this function are prepared to handle
 	// slightly out-dated information and will take slow path if necessary
-	CommitNumber state = block->data[offset];
-
-	return state;
+	return block->data[offset].load(std::memory_order_relaxed);
 }
 
 void TipCache::initializeTpc(thread_db *tdbb)
@@ -261,7 +286,7 @@ void TipCache::initializeTpc(thread_db *tdbb)
 	try
 	{
 		fileName.printf(SNAPSHOTS_FILE, dbb->getUniqueFileId().c_str());
-		m_snapshots = FB_NEW_POOL(*dbb->dbb_permanent) SharedMemory<SnapshotList>(
+		m_snapshots = FB_NEW_POOL(*dbb->dbb_permanent) SharedMemory<SnapshotSlots>(
 			fileName.c_str(), dbb->dbb_config->getSnapshotsMemSize(), &snapshotsInitializer);
 
 		const auto* header = m_snapshots->getHeader();
@@ -368,7 +393,9 @@ TipCache::StatusBlockData::StatusBlockData(thread_db* tdbb, TipCache* tipCache,
 	  memory(NULL),
 	  existenceLock(tdbb, sizeof(TpcBlockNumber), LCK_tpc_block, this, tpc_block_blocking_ast),
 	  cache(tipCache),
-	  acceptAst(false)
+	  acceptAst(false),
+	  published(NULL),
+	  readers(0)
 {
 	Database* dbb = tdbb->getDatabase();
 
@@ -403,6 +430,8 @@ TipCache::StatusBlockData::StatusBlockData(thread_db* tdbb, TipCache* tipCache,
 	}
 
 	fb_assert(memory->getHeader()->mhb_version == TPC_VERSION);
+
+	published.store(memory->getHeader(), std::memory_order_release);
 }
 
 PathName TipCache::StatusBlockData::makeSharedMemoryFileName(Database* dbb, TpcBlockNumber n, bool fullPath)
@@ -455,6 +484,8 @@ void TipCache::StatusBlockData::clear(thread_db* tdbb)
 			ERR_bugcheck_msg("Unable to convert TPC lock (SW)");
 		}
 
+		unpublish();
+
 		fName = memory->getMapFileName();
 		delete memory;
 		memory = NULL;
@@ -479,6 +510,15 @@ void TipCache::StatusBlockData::clear(thread_db* tdbb)
 	LCK_release(tdbb, &existenceLock);
 }
 
+void TipCache::StatusBlockData::unpublish()
+{
+	published.store(NULL);
+
+	// Readers hold the mapping only while reading a single state
+	while (readers.load())
+		Thread::yield();
+}
+
 TipCache::TransactionStatusBlock* TipCache::createTransactionStatusBlock(ULONG blockSize, TpcBlockNumber blockNumber)
 {
 	fb_assert(m_sync_status.ourExclusiveLock());
@@ -490,6 +530,7 @@ TipCache::TransactionStatusBlock* TipCache::createTransactionStatusBlock(ULONG b
 		StatusBlockData(tdbb, this, blockSize, blockNumber);
 
 	m_blocks_memory.add(blockData);
+	m_blockCache[blockNumber % BLOCK_CACHE_SIZE].store(blockData, std::memory_order_release);
 
 	return blockData->memory->getHeader();
 }
@@ -502,9 +543,18 @@ TipCache::TransactionStatusBlock* TipCache::getTransactionStatusBlock(const Glob
 	TransactionStatusBlock* block = NULL;
 	{
 		sync.lock(SYNC_SHARED);
+
+		// Recently used block is found without searching the tree
+		block = getCachedStatusBlock(blockNumber);
+		if (block)
+			return block;
+
 		BlocksMemoryMap::ConstAccessor acc(&m_blocks_memory);
 		if (acc.locate(blockNumber))
+		{
 			block = acc.current()->memory->getHeader();
+			m_blockCache[blockNumber % BLOCK_CACHE_SIZE].store(acc.current(), std::memory_order_release);
+		}
 		else
 			sync.unlock();
 	}
@@ -514,7 +564,10 @@ TipCache::TransactionStatusBlock* TipCache::getTransactionStatusBlock(const Glob
 		sync.lock(SYNC_EXCLUSIVE);
 		BlocksMemoryMap::ConstAccessor acc(&m_blocks_memory);
 		if (acc.locate(blockNumber))
+		{
 			block = acc.current()->memory->getHeader();
+			m_blockCache[blockNumber % BLOCK_CACHE_SIZE].store(acc.current(), std::memory_order_release);
+		}
 		else
 		{
 			// Check if block might be too old to be created.
@@ -749,9 +802,19 @@ int TipCache::tpc_block_blocking_ast(void* arg)
 		if (data->blockNumber >= oldest / cache->m_transactionsPerBlock)
 			return 0;
 
+		// Readers use the block under shared lock. Don't wait for them here,
+		// blockage is posted again if we can't release the block now.
+		Sync sync(&cache->m_sync_status, FB_FUNCTION);
+		if (!sync.lockConditional(SYNC_EXCLUSIVE))
+			return 0;
+
 		// Release shared memory
 		if (data->memory)
 		{
+			StatusBlockData* cached = data;
+			cache->m_blockCache[data->blockNumber % BLOCK_CACHE_SIZE].compare_exchange_strong(cached, NULL);
+
+			data->unpublish();
 			delete data->memory;
 			data->memory = NULL;
 		}
@@ -810,7 +873,16 @@ void TipCache::releaseSharedMemory(thread_db* tdbb, TraNumber oldest_old, TraNum
 		{
 			StatusBlockData* block = m_blocks_memory.current();
 			m_blocks_memory.fastRemove();
-			delete block;
+
+			StatusBlockData* cached = block;
+			m_blockCache[blockNumber % BLOCK_CACHE_SIZE].compare_exchange_strong(cached, NULL);
+
+			// Release the block now but keep the object, see m_retiredBlocks
+			block->clear(tdbb);
+			if (block->existenceLock.lck_logical != LCK_none)
+				LCK_release(tdbb, &block->existenceLock);
+
+			m_retiredBlocks.add(block);
 		}
 
 		// Signal other processes to release resources
@@ -831,26 +903,59 @@ void TipCache::releaseSharedMemory(thread_db* tdbb, TraNumber oldest_old, TraNum
 	}
 }
 
-SnapshotHandle TipCache::allocateSnapshotSlot()
+bool TipCache::snapshotsMapped() const
 {
-	// Try finding available slot
-	SnapshotList* snapshots = m_snapshots->getHeader();
+	const SnapshotSlots* snapshots = m_snapshots->getHeader();
 
-	// Scan previously used slots first
-	SnapshotHandle slotNumber;
+	return snapshots->slots_allocated.load(std::memory_order_acquire) ==
+		(m_snapshots->sh_mem_length_mapped - offsetof(SnapshotSlots, slots[0])) / sizeof(SnapshotSlots::Slot);
+}
 
-	const ULONG slots_used = snapshots->slots_used.load(std::memory_order_relaxed);
-	for (slotNumber = snapshots->min_free_slot; slotNumber < slots_used; slotNumber++)
+void TipCache::remapSnapshots(bool sync)
+{
+	// Can only be called on initialized TipCache
+	fb_assert(m_tpcHeader);
+	fb_assert(m_sync_snapshots.ourExclusiveLock());
+
+	const SnapshotSlots* snapshots = m_snapshots->getHeader();
+
+	if (!snapshotsMapped())
+	{
+		SharedMutexGuard guard(m_snapshots, false);
+		if (sync)
+			guard.lock();
+
+		LocalStatus ls;
+		CheckStatusWrapper localStatus(&ls);
+		if (!m_snapshots->remapFile(&localStatus,
+			static_cast<ULONG>(
+				snapshots->slots_allocated.load(std::memory_order_relaxed) * sizeof(SnapshotSlots::Slot) +
+					offsetof(SnapshotSlots, slots[0])), false))
+		{
+			status_exception::raise(&localStatus);
+		}
+	}
+}
+
+void TipCache::growSnapshots()
+{
+	SyncLockGuard sync(&m_sync_snapshots, SYNC_EXCLUSIVE, FB_FUNCTION);
+	SharedMutexGuard guard(m_snapshots);
+
+	// Someone else could grow the list already
+	if (!snapshotsMapped())
 	{
-		if (!snapshots->slots[slotNumber].attachment_id.load(std::memory_order_relaxed))
-			return slotNumber;
+		remapSnapshots(false);
+		return;
 	}
 
-	// See if we have some space left in the snapshots block
-	if (slotNumber < snapshots->slots_allocated.load(std::memory_order_relaxed))
+	SnapshotSlots* snapshots = m_snapshots->getHeader();
+
+	// Or release some slot
+	if (snapshots->slots_used.load(std::memory_order_relaxed) <
+		snapshots->slots_allocated.load(std::memory_order_relaxed))
 	{
-		snapshots->slots_used.store(slotNumber + 1, std::memory_order_release);
-		return slotNumber;
+		return;
 	}
 
 #ifdef HAVE_OBJECT_MAP
@@ -863,7 +968,7 @@ SnapshotHandle TipCache::allocateSnapshotSlot()
 
 	snapshots = m_snapshots->getHeader();
 	snapshots->slots_allocated.store(
-		static_cast<ULONG>((m_snapshots->sh_mem_length_mapped - offsetof(SnapshotList, slots[0])) / sizeof(SnapshotData)),
+		static_cast<ULONG>((m_snapshots->sh_mem_length_mapped - offsetof(SnapshotSlots, slots[0])) / sizeof(SnapshotSlots::Slot)),
 		std::memory_order_release);
 #else
 	// NS: I do not intend to assign a code to this condition, because I think that we do not
@@ -873,36 +978,6 @@ SnapshotHandle TipCache::allocateSnapshotSlot()
 	(Arg::Gds(isc_random) <<
 		"Snapshots shared memory block is full on a platform that does not support shared memory remapping").raise();
 #endif
-
-	fb_assert(slotNumber < snapshots->slots_allocated.load(std::memory_order_relaxed));
-	snapshots->slots_used.store(slotNumber + 1, std::memory_order_release);
-	return slotNumber;
-}
-
-void TipCache::remapSnapshots(bool sync)
-{
-	// Can only be called on initialized TipCache
-	fb_assert(m_tpcHeader);
-
-	const SnapshotList* snapshots = m_snapshots->getHeader();
-
-	if (snapshots->slots_allocated.load(std::memory_order_acquire) !=
-		(m_snapshots->sh_mem_length_mapped - offsetof(SnapshotList, slots[0])) / sizeof(SnapshotData))
-	{
-		SharedMutexGuard guard(m_snapshots, false);
-		if (sync)
-			guard.lock();
-
-		LocalStatus ls;
-		CheckStatusWrapper localStatus(&ls);
-		if (!m_snapshots->remapFile(&localStatus,
-			static_cast<ULONG>(
-				snapshots->slots_allocated.load(std::memory_order_relaxed) * sizeof(SnapshotData) +
-					offsetof(SnapshotList, slots[0])), false))
-		{
-			status_exception::raise(&localStatus);
-		}
-	}
 }
 
 
@@ -914,79 +989,52 @@ SnapshotHandle TipCache::beginSnapshot(thread_db* tdbb, AttNumber attachmentId,
 
 	fb_assert(attachmentId);
 
-	// Lock mutex
-	SharedMutexGuard guard(m_snapshots);
-
-	// Remap snapshot list if it has been grown by someone else
-	remapSnapshots(false);
-
-	SnapshotList* snapshots = m_snapshots->getHeader();
-
-	if (commitNumber != 0)
+	while (true)
 	{
-		const ULONG slotsUsed = snapshots->slots_used.load(std::memory_order_relaxed);
-		bool found = false;
+		{	// scope
+			SyncLockGuard sync(&m_sync_snapshots, SYNC_SHARED, FB_FUNCTION);
 
-		for (SnapshotHandle slotNumber = 0; slotNumber < slotsUsed; ++slotNumber)
-		{
-			if (snapshots->slots[slotNumber].attachment_id.load(std::memory_order_relaxed) != 0 &&
-				snapshots->slots[slotNumber].snapshot.load(std::memory_order_relaxed) == commitNumber)
+			// Snapshot list could be grown by someone else
+			if (snapshotsMapped())
 			{
-				found = true;
-				break;
-			}
-		}
-
-		if (!found)
-			ERR_post(Arg::Gds(isc_tra_snapshot_does_not_exist));
-	}
-
-	SnapshotHandle slotNumber = allocateSnapshotSlot();
-
-	// Note, that allocateSnapshotSlot might remap memory and thus invalidate pointers
-	snapshots = m_snapshots->getHeader();
-
-	// Store snapshot commit number and return handle
-	SnapshotData* slot = snapshots->slots + slotNumber;
-
-	if (commitNumber == 0)
-		commitNumber = header->latest_commit_number.load(std::memory_order_acquire);
-
-	slot->snapshot.store(commitNumber, std::memory_order_release);
+				SnapshotSlots* snapshots = m_snapshots->getHeader();
 
-	// Only assign attachment_id after we completed all other work
-	slot->attachment_id.store(attachmentId, std::memory_order_release);
-
-	// And now move allocator watermark position after we used slot for sure
-	snapshots->min_free_slot = slotNumber + 1;
-
-	return slotNumber;
-}
+				if (commitNumber != 0)
+				{
+					const ULONG slotsUsed = snapshots->slots_used.load(std::memory_order_relaxed);
+					bool found = false;
 
-void TipCache::deallocateSnapshotSlot(SnapshotHandle slotNumber)
-{
-	// Note: callers of this function assume that it cannot remap
-	// shared memory (as they keep shared memory pointers).
+					for (SnapshotHandle slotNumber = 0; slotNumber < slotsUsed; ++slotNumber)
+					{
+						if (snapshots->slots[slotNumber].attachment_id.load(std::memory_order_relaxed) != 0 &&
+							snapshots->slots[slotNumber].snapshot.load(std::memory_order_relaxed) == commitNumber)
+						{
+							found = true;
+							break;
+						}
+					}
 
-	SnapshotList* snapshots = m_snapshots->getHeader();
+					if (!found)
+						ERR_post(Arg::Gds(isc_tra_snapshot_does_not_exist));
+				}
 
-	// At first, make slot available for allocator (this is always safe)
-	if (snapshots->min_free_slot > slotNumber)
-		snapshots->min_free_slot = slotNumber;
+				SnapshotHandle slotNumber;
 
-	SnapshotData* slot = snapshots->slots + slotNumber;
+				if (snapshots->allocate(attachmentId, slotNumber))
+				{
+					if (commitNumber == 0)
+						commitNumber = header->latest_commit_number.load(std::memory_order_acquire);
 
-	slot->snapshot.store(0, std::memory_order_release);
-	slot->attachment_id.store(0, std::memory_order_release);
+					// Store snapshot commit number, this makes the slot visible to readers
+					snapshots->slots[slotNumber].snapshot.store(commitNumber, std::memory_order_release);
 
-	// After we completed deallocation, update used slots count, if necessary
-	if (slotNumber == snapshots->slots_used.load(std::memory_order_relaxed) - 1)
-	{
-		do {
-			slot--;
-		} while (slot >= snapshots->slots && slot->attachment_id.load(std::memory_order_relaxed) == 0);
+					return slotNumber;
+				}
+			}
+		}
 
-		snapshots->slots_used.store(static_cast<ULONG>(slot - snapshots->slots + 1), std::memory_order_release);
+		// All slots are used, or the list should be remapped
+		growSnapshots();
 	}
 }
 
@@ -996,16 +1044,15 @@ void TipCache::endSnapshot(thread_db* tdbb, SnapshotHandle handle, AttNumber att
 	fb_assert(m_tpcHeader);
 	GlobalTpcHeader* header = m_tpcHeader->getHeader();
 
-	// Lock mutex
-	SharedMutexGuard guard(m_snapshots);
-
+	// Slot is released without locks, just don't let other threads remap the list.
 	// We don't care to perform remap here, because we release a slot that was
 	// allocated by this process and we do not access any data past it during
 	// deallocation.
+	SyncLockGuard sync(&m_sync_snapshots, SYNC_SHARED, FB_FUNCTION);
 
 	// Perform some sanity checks on a handle
-	const SnapshotList* snapshots = m_snapshots->getHeader();
-	const SnapshotData* slot = snapshots->slots + handle;
+	SnapshotSlots* snapshots = m_snapshots->getHeader();
+	const SnapshotSlots::Slot* slot = snapshots->slots + handle;
 
 	if (handle >= snapshots->slots_used.load(std::memory_order_relaxed))
 		ERR_bugcheck_msg("Incorrect snapshot deallocation - too few slots");
@@ -1014,7 +1061,7 @@ void TipCache::endSnapshot(thread_db* tdbb, SnapshotHandle handle, AttNumber att
 		ERR_bugcheck_msg("Incorrect snapshot deallocation - attachment mismatch");
 
 	// Deallocate slot
-	deallocateSnapshotSlot(handle);
+	snapshots->release(handle, attachmentId);
 
 	// Increment release event count
 	header->snapshot_release_count++;
@@ -1028,9 +1075,13 @@ void TipCache::updateActiveSnapshots(thread_db* tdbb, ActiveSnapshots* activeSna
 
 	fb_assert(activeSnapshots);
 
-	// This function is quite tricky as it reads snapshots list without locks (using atomics)
+	// This function is quite tricky as it reads snapshots list without locks (using atomics).
+	// Shared lock of m_sync_snapshots just prevents other threads from remapping the list.
 
-	SnapshotList* snapshots = m_snapshots->getHeader();
+	Sync sync(&m_sync_snapshots, FB_FUNCTION);
+	sync.lock(SYNC_SHARED);
+
+	SnapshotSlots* snapshots = m_snapshots->getHeader();
 
 	if (activeSnapshots->m_lastCommit == CN_ACTIVE)
 	{
@@ -1045,31 +1096,45 @@ void TipCache::updateActiveSnapshots(thread_db* tdbb, ActiveSnapshots* activeSna
 		const ULONG slots_used_org = snapshots->slots_used.load(std::memory_order_acquire);
 
 		// Remap snapshot list if it has been grown by someone else
-		remapSnapshots(true);
+		if (!snapshotsMapped())
+		{
+			sync.unlock();
+			sync.lock(SYNC_EXCLUSIVE);
+			remapSnapshots(true);
+			sync.downgrade(SYNC_SHARED);
+		}
 
 		snapshots = m_snapshots->getHeader();
 
 		GenericMap<Pair<NonPooled<AttNumber, bool> > > att_states;
 
-		// We modify snapshots list only while holding a mutex
+		fb_assert(tdbb->getAttachment());
+		const AttNumber releaser = tdbb->getAttachment()->att_attachment_id;
+
+		// Slots of dead attachments are released while holding a mutex
 		SharedMutexGuard guard(m_snapshots, false);
 
 		activeSnapshots->m_snapshots.clear();
 		for (ULONG slotNumber = 0; slotNumber < slots_used_org; slotNumber++)
 		{
-			const SnapshotData* slot = snapshots->slots + slotNumber;
+			const SnapshotSlots::Slot* slot = snapshots->slots + slotNumber;
 			const AttNumber slot_attachment_id = slot->attachment_id.load(std::memory_order_acquire);
 			if (slot_attachment_id)
 			{
+				// Reserved slot belongs to the attachment that releases slots at the end
+				const bool reserved = SnapshotSlots::isReserved(slot_attachment_id);
+				const AttNumber owner = reserved ?
+					SnapshotSlots::reservedBy(slot_attachment_id) : slot_attachment_id;
+
 				bool isAttachmentDead;
-				if (!att_states.get(slot_attachment_id, isAttachmentDead))
+				if (!att_states.get(owner, isAttachmentDead))
 				{
 					ThreadStatusGuard temp_status(tdbb);
 					Lock temp_lock(tdbb, sizeof(AttNumber), LCK_attachment);
-					temp_lock.setKey(slot_attachment_id);
+					temp_lock.setKey(owner);
 					if ((isAttachmentDead = LCK_lock(tdbb, &temp_lock, LCK_EX, LCK_NO_WAIT)))
 						LCK_release(tdbb, &temp_lock);
-					att_states.put(slot_attachment_id, isAttachmentDead);
+					att_states.put(owner, isAttachmentDead);
 				}
 
 				if (isAttachmentDead)
@@ -1087,9 +1152,13 @@ void TipCache::updateActiveSnapshots(thread_db* tdbb, ActiveSnapshots* activeSna
 						}
 					}
 
-					deallocateSnapshotSlot(slotNumber);
+					// Slots reserved by the dead attachment would be never used again
+					if (reserved)
+						snapshots->resetReserved(slotNumber, slot_attachment_id, releaser);
+					else
+						snapshots->release(slotNumber, releaser);
 				}
-				else
+				else if (!reserved)
 				{
 					const CommitNumber slot_snapshot = slot->snapshot.load(std::memory_order_acquire);
 					if (slot_snapshot)
@@ -1126,12 +1195,18 @@ void TipCache::updateActiveSnapshots(thread_db* tdbb, ActiveSnapshots* activeSna
 		activeSnapshots->m_releaseCount = release_count;
 
 		// Remap snapshot list if it has been grown by someone else
-		remapSnapshots(true);
+		if (!snapshotsMapped())
+		{
+			sync.unlock();
+			sync.lock(SYNC_EXCLUSIVE);
+			remapSnapshots(true);
+			sync.downgrade(SYNC_SHARED);
+		}
 
 		snapshots = m_snapshots->getHeader();
 
 		activeSnapshots->m_snapshots.clear();
-		for (SnapshotData* slot = snapshots->slots,
+		for (SnapshotSlots::Slot* slot = snapshots->slots,
 				*end = snapshots->slots + slots_used_org;
 			 slot < end;
 			 slot++)
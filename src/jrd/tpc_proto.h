@@ -28,6 +28,7 @@
 #include "../common/classes/array.h"
 #include "../common/classes/fb_string.h"
 #include "../common/classes/SyncObject.h"
+#include "../jrd/SnapshotSlots.h"
 
 namespace Ods {
 
@@ -188,24 +189,6 @@ private:
 		ULONG tpc_block_size; // final
 	};
 
-	struct SnapshotData
-	{
-		std::atomic<AttNumber> attachment_id; // Unused slots have attachment_id == 0
-		std::atomic<CommitNumber> snapshot;
-	};
-
-	// Note: when maintaining this structure, we are extra careful
-	// to keep it consistent at all times, so that the process using it
-	// can be killed at any time without adverse consequences.
-	class SnapshotList : public Firebird::MemoryHeader
-	{
-	public:
-		std::atomic<ULONG> slots_allocated;
-		std::atomic<ULONG> slots_used;
-		ULONG min_free_slot; // Position where to start looking for free space
-		SnapshotData slots[1];
-	};
-
 	class TransactionStatusBlock : public Firebird::MemoryHeader
 	{
 	public:
@@ -229,6 +212,11 @@ private:
 		TipCache* cache;
 		bool acceptAst;
 
+		// Mapped block as seen by lock-free readers of the block cache, and the
+		// number of such readers using it right now
+		std::atomic<TransactionStatusBlock*> published;
+		std::atomic<unsigned> readers;
+
 		inline static TpcBlockNumber& generate(const void* /*sender*/, StatusBlockData* item) noexcept
 		{
 			return item->blockNumber;
@@ -236,6 +224,9 @@ private:
 
 		void clear(thread_db* tdbb);
 
+		// Hide the mapping from lock-free readers and wait until they are done with it
+		void unpublish();
+
 		static Firebird::PathName makeSharedMemoryFileName(Database* dbb, TpcBlockNumber n, bool fullPath);
 	};
 
@@ -281,11 +272,12 @@ private:
 
 	typedef Firebird::BePlusTree<StatusBlockData*, TpcBlockNumber, StatusBlockData> BlocksMemoryMap;
 
-	static constexpr ULONG TPC_VERSION = 2;
+	static constexpr ULONG TPC_VERSION = 3;
 	static constexpr int SAFETY_GAP_BLOCKS = 1;
+	static constexpr unsigned BLOCK_CACHE_SIZE = 16;
 
 	Firebird::SharedMemory<GlobalTpcHeader>* m_tpcHeader; // final
-	Firebird::SharedMemory<SnapshotList>* m_snapshots; // final
+	Firebird::SharedMemory<SnapshotSlots>* m_snapshots; // final
 	ULONG m_transactionsPerBlock; // final. When set, we assume TPC has been initialized.
 
 	Firebird::AutoPtr<Lock> m_lock;
@@ -300,6 +292,20 @@ private:
 
 	Firebird::SyncObject m_sync_status;
 
+	// Recently used blocks, indexed by block number modulo BLOCK_CACHE_SIZE.
+	// cacheState() reads them without locks: it registers itself in the readers
+	// counter of the block and then uses its published mapping, which is
+	// unpublished before the block is unmapped. Blocks removed from the tree are
+	// kept in m_retiredBlocks until finalizeTpc(), as a lock-free reader may
+	// still hold a pointer taken from the cache.
+	std::atomic<StatusBlockData*> m_blockCache[BLOCK_CACHE_SIZE];
+	Firebird::Array<StatusBlockData*> m_retiredBlocks;
+
+	// Snapshot slots are allocated and released without locks, shared lock of
+	// m_sync_snapshots just prevents other threads from remapping the list.
+	// Growing and remapping the list needs exclusive lock.
+	Firebird::SyncObject m_sync_snapshots;
+
 	// Attach to shared memory objects and populate process-local structures.
 	// If shared memory area did not exist - populate initial TIP by reading cache
 	// from disk.
@@ -315,6 +321,17 @@ private:
 	// If returns not NULL then sync remains locked.
 	TransactionStatusBlock* getTransactionStatusBlock(const GlobalTpcHeader* header, TpcBlockNumber blockNumber, Firebird::Sync& sync);
 
+	// Returns block holding transaction state if it was used recently, or NULL.
+	// Assume lock of m_sync_status, cacheState() reads the cache without it.
+	TransactionStatusBlock* getCachedStatusBlock(TpcBlockNumber blockNumber) const noexcept
+	{
+		const StatusBlockData* const blockData =
+			m_blockCache[blockNumber % BLOCK_CACHE_SIZE].load(std::memory_order_acquire);
+
+		return (blockData && blockData->blockNumber == blockNumber && blockData->memory) ?
+			blockData->memory->getHeader() : NULL;
+	}
+
 	// Map shared memory for a block.
 	// Assume exclusive lock of m_sync_status.
 	TransactionStatusBlock* createTransactionStatusBlock(ULONG blockSize, TpcBlockNumber blockNumber);
@@ -331,9 +348,11 @@ private:
 
 	static int tpc_block_blocking_ast(void* arg);
 
-	SnapshotHandle allocateSnapshotSlot();
-	void deallocateSnapshotSlot(SnapshotHandle slotNumber);
+	// Remap snapshot list if it has been grown by someone else.
+	// Assume exclusive lock of m_sync_snapshots.
 	void remapSnapshots(bool sync);
+	bool snapshotsMapped() const;
+	void growSnapshots();
 };
 
 
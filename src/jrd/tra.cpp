@@ -75,6 +75,7 @@
 #include "../jrd/Collation.h"
 #include "../jrd/Mapping.h"
 #include "../jrd/DbCreators.h"
+#include "../jrd/IndexBulkInsert.h"
 #include "../common/os/fbsyslog.h"
 #include "firebird/impl/msg_helper.h"
 
@@ -476,6 +477,11 @@ void TRA_commit(thread_db* tdbb, jrd_tra* transaction, const bool retaining_flag
 	while (transaction->tra_save_point && !transaction->tra_save_point->isRoot())
 		transaction->releaseSavepoint(tdbb);
 
+	// Insert index keys collected by large loads
+
+	if (transaction->tra_bulk_insert)
+		transaction->tra_bulk_insert->flush(tdbb);
+
 	// Let replicator perform heavy and error-prone part of work
 
 	REPL_trans_prepare(tdbb, transaction);
@@ -1100,6 +1106,11 @@ void TRA_prepare(thread_db* tdbb, jrd_tra* transaction, USHORT length, const UCH
 			status_exception::raise(&st);
 	}
 
+	// Insert index keys collected by large loads
+
+	if (transaction->tra_bulk_insert)
+		transaction->tra_bulk_insert->flush(tdbb);
+
 	// Perform any meta data work deferred
 
 	DFW_perform_work(tdbb, transaction);
@@ -1386,6 +1397,11 @@ void TRA_rollback(thread_db* tdbb, jrd_tra* transaction, const bool retaining_fl
 	if (transaction->tra_flags & (TRA_prepare2 | TRA_reconnected))
 		MET_update_transaction(tdbb, transaction, false);
 
+	// Index keys collected by large loads are not needed as all changes are going away
+
+	if (transaction->tra_bulk_insert)
+		transaction->tra_bulk_insert->clear();
+
 	// If force flag is true, get rid of all savepoints to mark the transaction as dead
 	if (force_flag || (transaction->tra_flags & TRA_invalidated))
 	{
@@ -3896,6 +3912,7 @@ jrd_tra::~jrd_tra()
 	delete tra_mapping_list;
 	delete tra_dbcreators_list;
 	delete tra_gen_ids;
+	delete tra_bulk_insert;
 
 	if (!tra_outer)
 		delete tra_blob_space;
@@ -66,6 +66,7 @@ class TimeZoneSnapshot;
 class UserManagement;
 class MappingList;
 class DbCreatorsList;
+class IndexBulkInsert;
 class thread_db;
 
 class SecDbContext
@@ -188,6 +189,7 @@ public:
 		tra_snapshot_number(0),
 		tra_sorts(*p, attachment->att_database),
 		tra_gen_ids(NULL),
+		tra_bulk_insert(NULL),
 		tra_replicator(NULL),
 		tra_interface(NULL),
 		tra_blob_space(NULL),
@@ -306,6 +308,7 @@ public:
 	EDS::Transaction *tra_ext_common;
 	//Transaction *tra_ext_two_phase;
 	GenIdCache* tra_gen_ids;
+	IndexBulkInsert* tra_bulk_insert;	// index keys collected by large loads
 	Firebird::IReplicatedTransaction* tra_replicator;
 
 private:
@@ -524,6 +527,7 @@ enum dfw_t {
 	dfw_store_view_context_type,
 	dfw_set_generator,
 	dfw_change_repl_state,
+	dfw_reset_histogram,
 
 	// deferred works argument types
 	dfw_arg_index_name,		// index name for dfw_delete_index, mandatory
@@ -650,6 +650,13 @@ static void explain_pp_bits(const UCHAR bits, Firebird::string& names)
 			names.append(", ");
 		names.append("empty");
 	}
+
+	if (bits & ppg_dp_all_visible)
+	{
+		if (!names.empty())
+			names.append(", ");
+		names.append("all visible");
+	}
 }
 
 
@@ -1443,6 +1450,7 @@ static void print_rhd(USHORT length, const rhd* header)
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_large) ? "LRG" : "   ");
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_damaged) ? "DAM" : "   ");
 		fprintf(stdout, "%s ", (header->rhd_flags & rhd_not_packed) ? "NPK" : "   ");
+		fprintf(stdout, "%s ", (header->rhd_flags & rhd_encoded) ? "ENC" : "   ");
 		fprintf(stdout, "\n");
 	}
 }
@@ -1760,6 +1768,9 @@ Validation::RTN Validation::walk_data_page(jrd_rel* relation, ULONG page_number,
 	if (dp_flags & dpg_secondary)
 		pp_bits |= ppg_dp_secondary;
 
+	if (dp_flags & dpg_all_visible)
+		pp_bits |= ppg_dp_all_visible;
+
 	if (page->dpg_count == 0)
 		pp_bits |= ppg_dp_empty;
 
@@ -2816,8 +2827,40 @@ Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, US
 		return Compressor::getUnpackedLength(length, data);
 	};
 
+	// Encoded record is shorter than its format says, collect it to decode later
+
+	const bool encoded = (header->rhd_flags & rhd_encoded) != 0;
+	HalfStaticArray<UCHAR, 1024> encodedData;
+	bool encodedError = false;
+
+	auto collectEncoded = [&encodedData, &encodedError](ULONG length, const UCHAR* data, bool notPacked)
+	{
+		if (notPacked)
+		{
+			encodedData.add(data, length);
+			return;
+		}
+
+		const auto unpackedLength = Compressor::getUnpackedLength(length, data);
+
+		if (length && !unpackedLength)
+		{
+			encodedError = true;
+			return;
+		}
+
+		const auto count = encodedData.getCount();
+		const auto end = Compressor::unpack(length, data, unpackedLength,
+			encodedData.getBuffer(count + unpackedLength) + count);
+		encodedData.shrink(end - encodedData.begin());
+	};
+
 	bool notPacked = (fragment->rhdf_flags & rhd_not_packed) != 0;
-	remainingLength -= calculateLength(length, p, notPacked);
+
+	if (encoded)
+		collectEncoded(length, p, notPacked);
+	else
+		remainingLength -= calculateLength(length, p, notPacked);
 
 	// Next, chase down fragments, if any
 
@@ -2870,7 +2913,11 @@ Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, US
 		}
 
 		notPacked = (fragment->rhdf_flags & rhd_not_packed) != 0;
-		remainingLength -= calculateLength(length, p, notPacked);
+
+		if (encoded)
+			collectEncoded(length, p, notPacked);
+		else
+			remainingLength -= calculateLength(length, p, notPacked);
 
 		page_number = fragment->rhdf_f_page;
 		line_number = fragment->rhdf_f_line;
@@ -2880,7 +2927,17 @@ Validation::RTN Validation::walk_record(jrd_rel* relation, const rhd* header, US
 
 	// Validate unpacked record length
 
-	if (!delta_flag && remainingLength != 0)
+	if (encoded)
+	{
+		HalfStaticArray<UCHAR, 1024> decoded;
+
+		if (encodedError || RecordEncoder::decode(format, encodedData.getCount(), encodedData.begin(),
+				format->fmt_length, decoded.getBuffer(format->fmt_length)) != format->fmt_length)
+		{
+			return corrupt(VAL_REC_WRONG_LENGTH, relation, number.getValue());
+		}
+	}
+	else if (!delta_flag && remainingLength != 0)
 		return corrupt(VAL_REC_WRONG_LENGTH, relation, number.getValue());
 
 	return rtn_ok;
@@ -2915,6 +2972,12 @@ void restoreFlags(UCHAR* byte, UCHAR flags, bool empty)
 	else
 		*byte &= ~bit;
 
+	bit = PPG_DP_BIT_MASK(slot, ppg_dp_all_visible);
+	if (flags & dpg_all_visible)
+		*byte |= bit;
+	else
+		*byte &= ~bit;
+
 	bit = PPG_DP_BIT_MASK(slot, ppg_dp_empty);
 	if (empty)
 		*byte |= bit;
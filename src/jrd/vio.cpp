@@ -1816,6 +1816,10 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 	// Primary record version not uses prior version
 	Record* prior = (rpb->rpb_flags & rpb_chained) ? rpb->rpb_prior : nullptr;
 
+	// Encoded record is unpacked into a temporary buffer and decoded afterwards
+	HalfStaticArray<UCHAR, 1024> encoded;
+	fb_assert(!prior || !(rpb->rpb_flags & rpb_encoded));
+
 	if (prior)
 	{
 		tail = difference.getData();
@@ -1824,6 +1828,11 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 		if (prior != record)
 			record->copyDataFrom(prior);
 	}
+	else if (rpb->rpb_flags & rpb_encoded)
+	{
+		tail = encoded.getBuffer(record->getLength());
+		tail_end = tail + record->getLength();
+	}
 	else
 	{
 		tail = record->getData();
@@ -1871,6 +1880,11 @@ void VIO_data(thread_db* tdbb, record_param* rpb, MemoryPool* pool)
 		const auto diffLength = tail - difference.getData();
 		length = difference.apply(diffLength, record->getLength(), record->getData());
 	}
+	else if (rpb->rpb_flags & rpb_encoded)
+	{
+		length = RecordEncoder::decode(format, tail - encoded.begin(), encoded.begin(),
+			record->getLength(), record->getData());
+	}
 	else
 	{
 		length = tail - record->getData();
@@ -5304,10 +5318,14 @@ static void delete_record(thread_db* tdbb, record_param* rpb, ULONG prior_page,
 	Record* record = nullptr;
 	const Record* prior = nullptr;
 
+	HalfStaticArray<UCHAR, 1024> encoded;
+	const bool decode = (rpb->rpb_flags & rpb_encoded) != 0;
+
 	if (pool && !(rpb->rpb_flags & rpb_deleted))
 	{
 		record = VIO_record(tdbb, rpb, NULL, pool);
 		prior = rpb->rpb_prior;
+		fb_assert(!prior || !decode);
 
 		if (prior)
 		{
@@ -5317,6 +5335,11 @@ static void delete_record(thread_db* tdbb, record_param* rpb, ULONG prior_page,
 			if (prior != record)
 				record->copyDataFrom(prior);
 		}
+		else if (decode)
+		{
+			tail = encoded.getBuffer(record->getLength());
+			tail_end = tail + record->getLength();
+		}
 		else
 		{
 			tail = record->getData();
@@ -5336,6 +5359,11 @@ static void delete_record(thread_db* tdbb, record_param* rpb, ULONG prior_page,
 		const auto diffLength = tail - difference.getData();
 		difference.apply(diffLength, record->getLength(), record->getData());
 	}
+	else if (record && decode)
+	{
+		RecordEncoder::decode(record->getFormat(), tail - encoded.begin(), encoded.begin(),
+			record->getLength(), record->getData());
+	}
 }
 
 
@@ -157,6 +157,13 @@ void PPG_print_header(const header_page* header, bool nocreation, Firebird::Util
 			uSvc->printf(false, "read only");
 		}
 
+		if (flags & hdr_compressed_pages)
+		{
+			if (count++)
+				uSvc->printf(false, ", ");
+			uSvc->printf(false, "compressed pages");
+		}
+
 		if (shutMode)
 		{
 			if (count++)